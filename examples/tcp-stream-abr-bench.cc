@@ -0,0 +1,262 @@
+/*
+  Micro-benchmark of AdaptationAlgorithm::GetNextRep: every algorithm streams a synthetic video over a synthetic
+  link, without simulating the network, and the wall-clock time and the heap allocations of its decisions are
+  measured. Growing costs (scans over the whole history, growing tables) show up as a difference between the
+  first and the last tenth of the decisions.
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/tcp-stream-client.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-segment-sizes.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamAbrBench");
+
+// Every heap allocation of the program is counted, the benchmark only looks at the difference over a decision.
+static uint64_t g_allocations = 0;
+
+void *
+operator new (std::size_t size)
+{
+  g_allocations++;
+  void *p = std::malloc (size > 0 ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+/**
+ * Synthetic streaming session of one algorithm, mimicking the history updates of TcpStreamClient.
+ */
+struct benchSession
+{
+  AdaptationAlgorithm *algo;
+  int64_t segments; //!< number of segments (chunks) to stream
+  int64_t chunk; //!< chunks per segment, 0 if none
+  int64_t rtt; //!< round trip time in microseconds
+  std::mt19937 random; //!< drives the link rate
+  std::lognormal_distribution<double> rate; //!< link rate per download in bit/s
+  int64_t segmentCounter;
+  int64_t playbackStart; //!< playback start of the last segment in microseconds
+
+  videoData video;
+  throughputData throughput;
+  bufferData buffer;
+  playbackData playback;
+
+  std::vector<int64_t> decisionTimes; //!< wall-clock time of every decision in nanoseconds
+  uint64_t allocations;
+};
+
+static void
+Decide (benchSession *s)
+{
+  int64_t now = Simulator::Now ().GetMicroSeconds ();
+  algorithmReply answer;
+  if (s->chunk == 0 || s->segmentCounter % s->chunk == 0)
+    {
+      uint64_t allocationsBefore = g_allocations;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      answer = s->algo->GetNextRep (s->segmentCounter, 0);
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+      s->allocations += g_allocations - allocationsBefore;
+      s->decisionTimes.push_back (std::chrono::duration_cast<std::chrono::nanoseconds> (end - start).count ());
+    }
+  else
+    {
+      // no quality change inside a segment, as in TcpStreamClient::RequestRepIndex
+      answer.nextRepIndex = s->playback.playbackIndex.back ();
+      answer.nextDownloadDelay = 0;
+    }
+  s->playback.playbackIndex.push_back (answer.nextRepIndex);
+
+  // download the segment over the synthetic link
+  int64_t bytes = s->video.segmentSize.at (answer.nextRepIndex).at (s->segmentCounter);
+  int64_t transferStart = now + s->rtt;
+  int64_t transferEnd = transferStart + (int64_t) (bytes * 8 / s->rate (s->random) * 1000000);
+  s->throughput.transmissionRequested.push_back (now);
+  s->throughput.transmissionStart.push_back (transferStart);
+  s->throughput.transmissionEnd.push_back (transferEnd);
+  s->throughput.bytesReceived.push_back (bytes);
+
+  // buffer level after the download, as in TcpStreamClient::SegmentReceivedHandle
+  if (s->segmentCounter > 0)
+    {
+      int64_t level = std::max (s->buffer.bufferLevelNew.back () - (transferEnd - s->buffer.timeNow.back ()), (int64_t) 0);
+      s->buffer.bufferLevelNew.push_back (level + s->video.segmentDuration);
+    }
+  else
+    {
+      s->buffer.bufferLevelNew.push_back (s->video.segmentDuration);
+    }
+  s->buffer.timeNow.push_back (transferEnd);
+  s->playbackStart = std::max (transferEnd, s->playbackStart + s->video.segmentDuration);
+  s->playback.playbackStart.push_back (s->playbackStart);
+
+  s->segmentCounter++;
+  if (s->segmentCounter < s->segments)
+    {
+      int64_t next = transferEnd + std::max (answer.nextDownloadDelay, (int64_t) 0);
+      Simulator::Schedule (MicroSeconds (next - now), &Decide, s);
+    }
+}
+
+static double
+MeanOf (std::vector<int64_t>::const_iterator begin, std::vector<int64_t>::const_iterator end)
+{
+  if (begin == end)
+    {
+      return 0;
+    }
+  double sum = 0;
+  for (std::vector<int64_t>::const_iterator it = begin; it != end; ++it)
+    {
+      sum += *it;
+    }
+  return sum / (end - begin);
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string algorithms = "tobasco,festive,panda,simple,mpc,bola,mpcvbr,bolavbr";
+  std::string segmentSizeFilePath;
+  int64_t segments = 1000;
+  uint32_t representations = 6;
+  double minBitrate = 300;
+  double maxBitrate = 6000;
+  uint64_t segmentDuration = 2000000;
+  int64_t chunk = 0;
+  int cmaf = 0;
+  double bandwidth = 3000;
+  double variation = 0.3;
+  int64_t rtt = 20000;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Micro-benchmark of the GetNextRep calls of the adaptation algorithms on synthetic histories.\n");
+  cmd.AddValue ("algorithms", "Comma separated list of the algorithms to benchmark", algorithms);
+  cmd.AddValue ("segments", "Length of the streamed video in segments (chunks if chunks are active)", segments);
+  cmd.AddValue ("representations", "Number of representations of the synthetic video", representations);
+  cmd.AddValue ("minBitrate", "Bitrate of the lowest representation in kbps", minBitrate);
+  cmd.AddValue ("maxBitrate", "Bitrate of the highest representation in kbps", maxBitrate);
+  cmd.AddValue ("segmentDuration", "The duration of a segment in microseconds OR the duration of a chunk if chunks are active", segmentDuration);
+  cmd.AddValue ("segmentSizeFile", "Use the segment sizes of this file instead of a synthetic video", segmentSizeFilePath);
+  cmd.AddValue ("chunk", "Number of chunks in a segment, 0 if no chunks", chunk);
+  cmd.AddValue ("cmaf", "CMAF version: 0: ABRs are dealing with chunks, 1: ABRs are dealing with segments, 2: ABRs optimized, 3: worst case scenario", cmaf);
+  cmd.AddValue ("bandwidth", "Mean link rate in kbps", bandwidth);
+  cmd.AddValue ("variation", "Coefficient of variation of the link rate between downloads", variation);
+  cmd.AddValue ("rtt", "Round trip time in microseconds", rtt);
+  cmd.AddValue ("seed", "Seed of the link rate", seed);
+  cmd.Parse (argc, argv);
+
+  videoData video;
+  video.segmentDuration = segmentDuration;
+  if (!segmentSizeFilePath.empty ())
+    {
+      if (TcpStreamClient::ReadInBitrateValues (segmentSizeFilePath, video) == -1)
+        {
+          NS_LOG_ERROR ("Opening segment size file " << segmentSizeFilePath << " failed.");
+          return 1;
+        }
+      segments = std::min (segments, (int64_t) video.segmentSize.at (0).size ());
+    }
+  else
+    {
+      // geometric bitrate ladder, segment sizes vary by +-10% around the bitrate
+      std::shared_ptr<SegmentSizeMemory> ladder = std::make_shared<SegmentSizeMemory> ();
+      std::mt19937 sizes (seed);
+      std::uniform_real_distribution<double> sizeVariation (0.9, 1.1);
+      for (uint32_t r = 0; r < representations; r++)
+        {
+          double kbps = representations > 1 ? minBitrate * std::pow (maxBitrate / minBitrate, r / (double) (representations - 1)) : minBitrate;
+          video.averageBitrate.push_back (kbps * 1000);
+          std::vector<int64_t> sizesOfRepresentation;
+          for (int64_t i = 0; i < segments; i++)
+            {
+              sizesOfRepresentation.push_back ((int64_t) (kbps * 1000 / 8 * (segmentDuration / 1e6) * sizeVariation (sizes)));
+            }
+          ladder->AddRepresentation (sizesOfRepresentation);
+        }
+      video.segmentSize = segmentSizeTable (ladder);
+    }
+
+  // lognormal link rate with the given mean and coefficient of variation
+  double sigma = std::sqrt (std::log (1 + variation * variation));
+  double mu = std::log (bandwidth * 1000) - sigma * sigma / 2;
+
+  std::cout << std::left << std::setw (14) << "Algorithm" << std::right
+            << std::setw (11) << "Decisions" << std::setw (14) << "ns/decision" << std::setw (14) << "p99_ns"
+            << std::setw (14) << "first10%_ns" << std::setw (14) << "last10%_ns" << std::setw (10) << "growth"
+            << std::setw (14) << "allocs/dec" << "\n";
+
+  std::stringstream names (algorithms);
+  std::string algorithm;
+  while (std::getline (names, algorithm, ','))
+    {
+      benchSession *s = new benchSession ();
+      s->video = video;
+      s->segments = segments;
+      s->chunk = chunk;
+      s->rtt = rtt;
+      s->random.seed (seed);
+      s->rate = std::lognormal_distribution<double> (mu, sigma);
+      s->segmentCounter = 0;
+      s->playbackStart = 0;
+      s->allocations = 0;
+      s->buffer.bufferLevelNew.push_back (0);
+      s->decisionTimes.reserve (segments);
+      s->algo = TcpStreamClient::CreateAdaptationAlgorithm (algorithm, s->video, s->playback, s->buffer, s->throughput, chunk, cmaf);
+      if (s->algo == NULL)
+        {
+          NS_LOG_ERROR ("Invalid algorithm name " << algorithm << ", skipping.");
+          delete s;
+          continue;
+        }
+
+      Simulator::Schedule (Seconds (0), &Decide, s);
+      Simulator::Run ();
+      Simulator::Destroy ();
+
+      const std::vector<int64_t> & times = s->decisionTimes;
+      size_t decile = std::max (times.size () / 10, (size_t) 1);
+      double first = MeanOf (times.begin (), times.begin () + std::min (decile, times.size ()));
+      double last = MeanOf (times.end () - std::min (decile, times.size ()), times.end ());
+      std::vector<int64_t> sorted (times);
+      std::sort (sorted.begin (), sorted.end ());
+      int64_t p99 = sorted.empty () ? 0 : sorted.at ((size_t) std::ceil (0.99 * sorted.size ()) - 1);
+
+      std::cout << std::left << std::setw (14) << algorithm << std::right << std::fixed << std::setprecision (1)
+                << std::setw (11) << times.size ()
+                << std::setw (14) << MeanOf (times.begin (), times.end ())
+                << std::setw (14) << p99
+                << std::setw (14) << first
+                << std::setw (14) << last
+                << std::setw (10) << std::setprecision (2) << (first > 0 ? last / first : 0)
+                << std::setw (14) << (times.empty () ? 0 : s->allocations / (double) times.size ()) << "\n";
+      std::cout.unsetf (std::ios_base::floatfield);
+
+      delete s->algo;
+      delete s;
+    }
+  return 0;
+}
@@ -0,0 +1,86 @@
+/*
+  Replays ABR input traces recorded by TcpStreamClient (attribute RecordAbrInputs) through another
+  adaptation algorithm, without simulating the network.
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/tcp-stream-client.h"
+#include "ns3/tcp-stream-abr-trace.h"
+#include "ns3/tcp-stream-interface.h"
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamAbrReplay");
+
+int
+main (int argc, char *argv[])
+{
+  std::string abrTraces;
+  std::string adaptationAlgo;
+  std::string segmentSizeFilePath;
+  std::string outputPath = "abrReplay.txt";
+
+  CommandLine cmd;
+  cmd.Usage ("Counterfactual replay of recorded ABR inputs through another adaptation algorithm.\n");
+  cmd.AddValue ("abrTraces", "Comma separated list of ABR input traces (clientX_abrInputs.bin)", abrTraces);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithm to replay the traces through (default: the recorded one)", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "Segment size file to use instead of the one stored in the trace", segmentSizeFilePath);
+  cmd.AddValue ("output", "File the replayed decisions are written to", outputPath);
+  cmd.Parse (argc, argv);
+
+  std::ofstream output (outputPath.c_str ());
+  output << "Client_Id Segment_Index Decision_Point_Of_Time Recorded_Rep_Level Replayed_Rep_Level\n";
+
+  uint64_t decisions = 0;
+  uint64_t agreements = 0;
+  std::stringstream traces (abrTraces);
+  std::string traceFile;
+  while (std::getline (traces, traceFile, ','))
+    {
+      AbrTraceReplayer replayer;
+      if (!replayer.Open (traceFile))
+        {
+          NS_LOG_ERROR ("Skipping unreadable ABR input trace " << traceFile);
+          continue;
+        }
+      const abrTraceHeader & header = replayer.GetHeader ();
+      std::string sizes = segmentSizeFilePath.empty () ? header.segmentSizeFile : segmentSizeFilePath;
+      if (TcpStreamClient::ReadInBitrateValues (sizes, replayer.GetVideoData ()) == -1)
+        {
+          NS_LOG_ERROR ("Opening segment size file " << sizes << " failed, skipping " << traceFile);
+          continue;
+        }
+      std::string algorithm = adaptationAlgo.empty () ? header.algorithm : adaptationAlgo;
+      AdaptationAlgorithm *algo = TcpStreamClient::CreateAdaptationAlgorithm (algorithm,
+                                                                             replayer.GetVideoData (),
+                                                                             replayer.GetPlaybackData (),
+                                                                             replayer.GetBufferData (),
+                                                                             replayer.GetThroughputData (),
+                                                                             header.chunk, header.cmaf);
+      if (algo == NULL)
+        {
+          NS_LOG_ERROR ("Invalid algorithm name entered. Terminating.");
+          return 1;
+        }
+
+      replayer.Replay (algo, output);
+      Simulator::Destroy ();
+      delete algo;
+
+      decisions += replayer.GetDecisions ();
+      agreements += replayer.GetAgreements ();
+      NS_LOG_INFO (traceFile << ": " << replayer.GetDecisions () << " decisions, "
+                             << replayer.GetAgreements () << " identical to " << header.algorithm);
+    }
+  output.close ();
+
+  std::cout << "Decisions: " << decisions << " Identical: " << agreements;
+  if (decisions > 0)
+    {
+      std::cout << " (" << 100.0 * agreements / decisions << "%)";
+    }
+  std::cout << std::endl;
+  return 0;
+}
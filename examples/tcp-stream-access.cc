@@ -0,0 +1,258 @@
+/*
+  Example script where every client (or group of clients) reaches the server over its own access link,
+  each shaped by its own network trace.
+*/
+
+#include <fstream>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/network-module.h"
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include "ns3/tcp-stream-helper.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-access-helper.h"
+#include "ns3/tcp-stream-qoe-aggregator.h"
+#include "ns3/tcp-stream-server.h"
+#include "ns3/tcp-stream-egress-scheduler.h"
+
+template <typename T>
+std::string ToString(T val)
+{
+    std::stringstream stream;
+    stream << val;
+    return stream.str();
+}
+
+using namespace std;
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamExampleAccess");
+
+int
+main (int argc, char *argv[])
+{
+  uint64_t segmentDuration;
+  // The simulation id is used to distinguish log file results from potentially multiple consequent simulation runs.
+  uint32_t simulationId;
+  uint32_t numberOfClients;
+  std::string adaptationAlgo;
+  std::string segmentSizeFilePath;
+  std::string additionalSegmentSizeFiles;
+  std::string linkRate = "5000Kbps";
+  std::string delay = "10ms";
+  std::string backboneRate = "10Gbps";
+  std::string backboneDelay = "5ms";
+  uint32_t clientsPerLink = 1;
+  string tracePath;
+  string traceDir;
+  string traceAssignment = "roundrobin";
+  int64_t traceSeed = 0;
+  bool traceLoop = false;
+  double traceTimeScale = 1.0;
+  string traceFormat = "plain";
+  double traceSampleInterval = 0;
+  int playbackStart = -1;
+  int chunk = 0;
+  int cmaf = 0;
+  int segmentsBehindLive = 1;
+  double streamJoinOffset = 0;
+  double startJitter = 0;
+  string egressRate;
+  string flowRate;
+  string clientWeights;
+  string requestTiming = "Random";
+  double requestWindow = 0;
+  double assistanceInterval = 0;
+  string assistanceCapacity;
+  int logLevel = 0;
+  bool histograms = false;
+  double stopTime = 400;
+
+  CommandLine cmd;
+  cmd.Usage ("Simulation of streaming with DASH over per-client access links.\n");
+  cmd.AddValue ("simulationId", "The simulation's index (for logging purposes)", simulationId);
+  cmd.AddValue ("numberOfClients", "The number of clients", numberOfClients);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds OR the duration of a chunk if chunks are active", segmentDuration);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithms of the clients, comma separated with optional weights (e.g. bola:3,festive:1)", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes OR chunk sizes if chunks are active", segmentSizeFilePath);
+  cmd.AddValue ("additionalSegmentSizeFiles", "Comma separated segment size files of further adaptation sets (e.g. audio) downloaded alongside the video, segments without chunks only", additionalSegmentSizeFiles);
+  cmd.AddValue ("linkRate", "The initial bitrate of every access link (e.g. 5000Kbps)", linkRate);
+  cmd.AddValue ("delay", "The delay of every access link (e.g. 10ms)", delay);
+  cmd.AddValue ("backboneRate", "The bitrate of the link between server and router", backboneRate);
+  cmd.AddValue ("backboneDelay", "The delay of the link between server and router", backboneDelay);
+  cmd.AddValue ("clientsPerLink", "The number of clients sharing one access link", clientsPerLink);
+  cmd.AddValue ("trace", "The relative path (from ns-3.x directory) to a network trace file used for all access links", tracePath);
+  cmd.AddValue ("traceDir", "The relative path (from ns-3.x directory) to a directory of network trace files assigned to access links", traceDir);
+  cmd.AddValue ("traceAssignment", "How traces are assigned to access links: roundrobin or random", traceAssignment);
+  cmd.AddValue ("traceSeed", "Random stream used for random trace assignment", traceSeed);
+  cmd.AddValue ("traceLoop", "Restart the network traces when their end is reached", traceLoop);
+  cmd.AddValue ("traceTimeScale", "Factor applied to the timestamps of the network traces", traceTimeScale);
+  cmd.AddValue ("traceFormat", "Format of the network traces: plain (s kbps), mahimahi, fcc (s Mbps) or hsdpa", traceFormat);
+  cmd.AddValue ("traceSampleInterval", "Resample the network traces to this interval in seconds (mahimahi: bin size, default 1), 0 for none", traceSampleInterval);
+  cmd.AddValue ("playbackStart", "The number of segments/chunks to be fetched before playback starts (default -1: 1 complete DASH/CMAF segment).", playbackStart);
+  cmd.AddValue ("chunk", "Number of chunks in a segment, 0 if no chunks, set chunk duration in segmentDuration and chunk sizes in segmentSizeFile", chunk);
+  cmd.AddValue ("cmaf", "CMAF version: 0: ABRs are dealing with chunks, 1: ABRs are dealing with segments, 2: ABRs optimized, 3: worst case scenario", cmaf);
+  cmd.AddValue ("liveDelay", "Number of full DASH/CMAF segments behind live.", segmentsBehindLive);
+  cmd.AddValue ("joinOffset", "Offset time to DASH/CMAF segment generation (s). eg 0.5s: the client will join the stream at 0.5s after a segment was generated", streamJoinOffset);
+  cmd.AddValue ("startJitter", "Clients start uniformly distributed within this many seconds after the live delay", startJitter);
+  cmd.AddValue ("egressRate", "Aggregate egress rate cap of the server (e.g. 50Mbps), enables the egress scheduler", egressRate);
+  cmd.AddValue ("flowRate", "Rate every client connection is paced to by the server (e.g. 8Mbps), enables the egress scheduler", flowRate);
+  cmd.AddValue ("clientWeights", "Comma separated egress scheduler weights, assigned to the clients in turn (e.g. 2,1,1), enables the egress scheduler", clientWeights);
+  cmd.AddValue ("requestTiming", "How requests waiting for a segment are spread over the request window: Random, Offset (per client id) or Paced", requestTiming);
+  cmd.AddValue ("requestWindow", "Window in seconds after the availability of a segment over which waiting requests are spread, 0 for none", requestWindow);
+  cmd.AddValue ("assistanceInterval", "Interval in seconds at which the server pushes its fair share to the clients as bitrate hint, 0 for no hints", assistanceInterval);
+  cmd.AddValue ("assistanceCapacity", "Egress capacity the server divides among its clients for the hints (default: backboneRate)", assistanceCapacity);
+  cmd.AddValue ("logLevel", "Logging level: 0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency, 3: No log files", logLevel);
+  cmd.AddValue ("histograms", "Record latency and stall histograms per client and write their merge to histograms.txt", histograms);
+  cmd.AddValue ("stopTime", "Simulation stop time in seconds", stopTime);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (524288));
+  Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue (524288));
+
+  // create folders for logs
+  const char * mylogsDir = dashLogDirectory.c_str();
+  mkdir (mylogsDir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+  std::string temp = dashLogDirectory + "/SimID_" + ToString (simulationId);
+  const char * dir = temp.c_str();
+  mkdir(dir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+  NS_LOG_INFO("Create topology.");
+
+  TcpStreamAccessHelper access;
+  access.SetBackboneDeviceAttribute ("DataRate", StringValue (backboneRate));
+  access.SetBackboneChannelAttribute ("Delay", StringValue (backboneDelay));
+  access.SetAccessDeviceAttribute ("DataRate", StringValue (linkRate));
+  access.SetAccessChannelAttribute ("Delay", StringValue (delay));
+  access.SetClientsPerLink (clientsPerLink);
+  access.SetReplayerAttribute ("Loop", BooleanValue (traceLoop));
+  access.SetReplayerAttribute ("TimeScale", DoubleValue (traceTimeScale));
+  access.SetReplayerAttribute ("Format", StringValue (traceFormat));
+  access.SetReplayerAttribute ("SampleInterval", TimeValue (Seconds (traceSampleInterval)));
+  access.SetTraceAssignment (traceAssignment == "random" ? TcpStreamAccessHelper::random : TcpStreamAccessHelper::roundRobin, traceSeed);
+  if (!tracePath.empty ())
+  {
+    access.AddTraceFile (tracePath);
+  }
+  if (!traceDir.empty ())
+  {
+    access.AddTraceDirectory (traceDir);
+  }
+  access.Install (numberOfClients);
+
+  // log which trace drives which client
+  if(logLevel == 0) {
+    std::ofstream traceLog;
+    std::string traces = temp + "/" + "clientTraces.txt";
+    traceLog.open (traces.c_str());
+    for (uint32_t i = 0; i < numberOfClients; i++)
+    {
+      traceLog << i << " " << access.GetClientTrace (i) << "\n";
+    }
+    traceLog.flush ();
+  }
+
+  /* Install TCP Receiver on the server */
+  TcpStreamServerHelper serverHelper (80);
+  if (!egressRate.empty () || !flowRate.empty () || !clientWeights.empty ())
+  {
+    // deficit round robin over the client connections, with optional rate cap, pacing and weights
+    Ptr<TcpStreamEgressScheduler> scheduler = CreateObject<TcpStreamEgressScheduler> ();
+    if (!egressRate.empty ())
+    {
+      scheduler->SetAttribute ("Rate", DataRateValue (DataRate (egressRate)));
+    }
+    if (!flowRate.empty ())
+    {
+      scheduler->SetAttribute ("FlowRate", DataRateValue (DataRate (flowRate)));
+    }
+    std::vector<double> weights;
+    std::stringstream weightStream (clientWeights);
+    std::string weight;
+    while (std::getline (weightStream, weight, ','))
+    {
+      weights.push_back (atof (weight.c_str ()));
+    }
+    for (uint32_t i = 0; i < numberOfClients && !weights.empty (); i++)
+    {
+      Ptr<Ipv4> ipv4 = access.GetClients ().Get (i)->GetObject<Ipv4> ();
+      scheduler->SetWeight (ipv4->GetAddress (1, 0).GetLocal (), weights.at (i % weights.size ()));
+    }
+    serverHelper.SetAttribute ("EgressScheduler", PointerValue (scheduler));
+  }
+  if (assistanceInterval > 0)
+  {
+    serverHelper.SetAttribute ("AssistanceInterval", TimeValue (Seconds (assistanceInterval)));
+    serverHelper.SetAttribute ("AssistanceCapacity", DataRateValue (DataRate (assistanceCapacity.empty () ? backboneRate : assistanceCapacity)));
+  }
+  ApplicationContainer serverApp = serverHelper.Install (access.GetServer ());
+  serverApp.Start (Seconds (0));
+
+  /* Install TCP/UDP Transmitter on the clients */
+  TcpStreamClientHelper clientHelper (access.GetServerAddress (), 80);
+  clientHelper.SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+  clientHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  clientHelper.SetAttribute ("AdditionalSegmentSizeFiles", StringValue (additionalSegmentSizeFiles));
+  clientHelper.SetAttribute ("NumberOfClients", UintegerValue(numberOfClients));
+  clientHelper.SetAttribute ("SimulationId", UintegerValue (simulationId));
+  if(playbackStart > 0) {
+    clientHelper.SetAttribute ("PlaybackStart", UintegerValue (playbackStart));
+  }
+  clientHelper.SetAttribute ("Chunk", UintegerValue (chunk));
+  clientHelper.SetAttribute ("Cmaf", UintegerValue (cmaf));
+  clientHelper.SetAttribute ("LogLevel", UintegerValue (logLevel));
+  clientHelper.SetAttribute ("RecordHistograms", BooleanValue (histograms));
+  clientHelper.SetAttribute ("RequestTiming", StringValue (requestTiming));
+  clientHelper.SetAttribute ("RequestJitter", TimeValue (Seconds (requestWindow)));
+  if (assistanceInterval > 0)
+  {
+    clientHelper.SetAttribute ("AssistancePort", UintegerValue (9001));
+  }
+  double segDuration = (segmentDuration/1000000);
+  if(chunk > 0) segDuration = ((segmentDuration*chunk)/1000000);
+  double startTime = (segmentsBehindLive*segDuration)+(streamJoinOffset);
+  TcpStreamClientPopulation population;
+  population.AddAlgorithms (adaptationAlgo);
+  Ptr<UniformRandomVariable> jitter = 0;
+  if (startJitter > 0)
+  {
+    jitter = CreateObject<UniformRandomVariable> ();
+    jitter->SetAttribute ("Max", DoubleValue (startJitter));
+  }
+  population.SetStartTime (Seconds (startTime), jitter);
+  ApplicationContainer clientApps = clientHelper.Install (access.GetClients (), population);
+
+  /* Aggregate the QoE of all clients into one summary */
+  Ptr<TcpStreamQoeAggregator> qoe = CreateObject<TcpStreamQoeAggregator> ();
+  qoe->Install (clientApps);
+
+  access.StartTraces (Seconds (0));
+
+  NS_LOG_INFO ("Run Simulation.");
+  NS_LOG_INFO ("Sim ID: " << simulationId << " Clients: " << numberOfClients);
+  Simulator::Stop (Seconds(stopTime));
+  Simulator::Run ();
+  qoe->Write (temp + "/" + "qoeSummary.txt");
+
+  // load of the server, to compare request timing policies
+  serverLoadMetrics load = DynamicCast<TcpStreamServer> (serverApp.Get (0))->GetLoadMetrics ();
+  std::ofstream serverLoad;
+  std::string serverLoadFile = temp + "/" + "serverLoad.txt";
+  serverLoad.open (serverLoadFile.c_str ());
+  serverLoad << "Requests Peak_Requests_In_Window Peak_Active_Requests Mean_Active_Requests Peak_Outstanding_Bytes Mean_Outstanding_Bytes\n"
+             << load.requests << " " << load.peakRequestsInWindow << " " << load.peakActiveRequests << " " << load.meanActiveRequests << " "
+             << load.peakOutstandingBytes << " " << load.meanOutstandingBytes << "\n";
+  serverLoad.close ();
+  if (histograms)
+  {
+    qoe->WriteHistograms (temp + "/" + "histograms.txt");
+  }
+  Simulator::Destroy ();
+  NS_LOG_INFO ("Done.");
+
+}
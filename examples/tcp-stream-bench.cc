@@ -0,0 +1,397 @@
+/*
+  End-to-end scaling benchmark: sweeps the number of clients, chunking and the log level over the access
+  topology and reports, per point, the simulator events processed, the wall-clock time, events per second,
+  the peak resident memory and the bytes of log files written, as CSV or JSON. Every point runs in its own
+  process, so peak memory and static state of one point do not leak into the next.
+*/
+
+#include <fstream>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/network-module.h"
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <errno.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "ns3/tcp-stream-helper.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-access-helper.h"
+
+template <typename T>
+std::string ToString(T val)
+{
+    std::stringstream stream;
+    stream << val;
+    return stream.str();
+}
+
+using namespace std;
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamBench");
+
+/**
+ * One point of the sweep and its measurements.
+ */
+struct benchPoint
+{
+  uint32_t clients;
+  uint32_t chunk;
+  uint32_t logLevel;
+  uint32_t simulationId;
+
+  int status; //!< exit status of the process that ran the point, -1 if it did not exit normally
+  uint64_t events; //!< simulator events processed
+  double setupSeconds; //!< wall-clock time of building the scenario
+  double runSeconds; //!< wall-clock time of Simulator::Run
+  int64_t peakRssKb; //!< peak resident memory of the process
+  uint64_t bytesWritten; //!< size of the log files of the point
+};
+
+/**
+ * Scenario parameters shared by all points.
+ */
+struct benchScenario
+{
+  uint64_t segmentDuration;
+  std::string segmentSizeFilePath;
+  std::string chunkSizeFilePath;
+  std::string adaptationAlgo;
+  std::string linkRate;
+  std::string delay;
+  std::string backboneRate;
+  int cmaf;
+  double stopTime;
+};
+
+static std::vector<uint32_t>
+ParseList (const std::string & list)
+{
+  std::vector<uint32_t> values;
+  std::stringstream stream (list);
+  std::string value;
+  while (std::getline (stream, value, ','))
+    {
+      if (!value.empty ())
+        {
+          values.push_back (atoi (value.c_str ()));
+        }
+    }
+  return values;
+}
+
+/**
+ * \return the summed size of the regular files of a log directory
+ */
+static uint64_t
+DirectorySize (const std::string & directory)
+{
+  uint64_t size = 0;
+  DIR *dir = opendir (directory.c_str ());
+  if (dir == 0)
+    {
+      return 0;
+    }
+  struct dirent *entry;
+  while ((entry = readdir (dir)) != 0)
+    {
+      struct stat info;
+      std::string path = directory + "/" + entry->d_name;
+      if (stat (path.c_str (), &info) == 0 && S_ISREG (info.st_mode))
+        {
+          size += info.st_size;
+        }
+    }
+  closedir (dir);
+  return size;
+}
+
+/**
+ * \brief Remove the files of earlier runs from a log directory, so that its size only counts this run.
+ */
+static void
+ClearDirectory (const std::string & directory)
+{
+  DIR *dir = opendir (directory.c_str ());
+  if (dir == 0)
+    {
+      return;
+    }
+  struct dirent *entry;
+  while ((entry = readdir (dir)) != 0)
+    {
+      struct stat info;
+      std::string path = directory + "/" + entry->d_name;
+      if (stat (path.c_str (), &info) == 0 && S_ISREG (info.st_mode))
+        {
+          unlink (path.c_str ());
+        }
+    }
+  closedir (dir);
+}
+
+/**
+ * \brief Build and run the scenario of one point, in the forked child process.
+ *
+ * The measurements are written as one line "events setupSeconds runSeconds" to the given file descriptor.
+ */
+static void
+RunPoint (const benchScenario & scenario, const benchPoint & point, int resultFd)
+{
+  std::chrono::steady_clock::time_point setupStart = std::chrono::steady_clock::now ();
+
+  TcpStreamAccessHelper access;
+  access.SetBackboneDeviceAttribute ("DataRate", StringValue (scenario.backboneRate));
+  access.SetAccessDeviceAttribute ("DataRate", StringValue (scenario.linkRate));
+  access.SetAccessChannelAttribute ("Delay", StringValue (scenario.delay));
+  access.Install (point.clients);
+
+  TcpStreamServerHelper serverHelper (80);
+  ApplicationContainer serverApp = serverHelper.Install (access.GetServer ());
+  serverApp.Start (Seconds (0));
+
+  // with chunks the same media is cut into chunk sized pieces, described by the chunk size file
+  uint64_t segmentDuration = scenario.segmentDuration;
+  std::string segmentSizeFilePath = scenario.segmentSizeFilePath;
+  if (point.chunk > 0)
+    {
+      segmentDuration = scenario.segmentDuration / point.chunk;
+      if (!scenario.chunkSizeFilePath.empty ())
+        {
+          segmentSizeFilePath = scenario.chunkSizeFilePath;
+        }
+    }
+
+  TcpStreamClientHelper clientHelper (access.GetServerAddress (), 80);
+  clientHelper.SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+  clientHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  clientHelper.SetAttribute ("NumberOfClients", UintegerValue (point.clients));
+  clientHelper.SetAttribute ("SimulationId", UintegerValue (point.simulationId));
+  clientHelper.SetAttribute ("Chunk", UintegerValue (point.chunk));
+  clientHelper.SetAttribute ("Cmaf", UintegerValue (scenario.cmaf));
+  clientHelper.SetAttribute ("LogLevel", UintegerValue (point.logLevel));
+  TcpStreamClientPopulation population;
+  population.AddAlgorithms (scenario.adaptationAlgo);
+  population.SetStartTime (Seconds (scenario.segmentDuration / (double)1000000));
+  clientHelper.Install (access.GetClients (), population);
+
+  std::chrono::steady_clock::time_point runStart = std::chrono::steady_clock::now ();
+  Simulator::Stop (Seconds (scenario.stopTime));
+  Simulator::Run ();
+  std::chrono::steady_clock::time_point runEnd = std::chrono::steady_clock::now ();
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+
+  std::string result = ToString (events) + " "
+    + ToString (std::chrono::duration<double> (runStart - setupStart).count ()) + " "
+    + ToString (std::chrono::duration<double> (runEnd - runStart).count ()) + "\n";
+  if (write (resultFd, result.c_str (), result.size ()) < 0)
+    {
+      NS_LOG_ERROR ("Writing the result of point " << point.simulationId << " failed.");
+    }
+}
+
+/**
+ * \brief Run one point in a child process and collect its measurements.
+ */
+static void
+MeasurePoint (const benchScenario & scenario, benchPoint & point)
+{
+  std::string temp = dashLogDirectory + "/SimID_" + ToString (point.simulationId);
+  mkdir (temp.c_str (), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+  ClearDirectory (temp);
+
+  point.status = -1;
+  point.events = 0;
+  point.setupSeconds = 0;
+  point.runSeconds = 0;
+  point.peakRssKb = 0;
+  point.bytesWritten = 0;
+
+  int fds[2];
+  if (pipe (fds) != 0)
+    {
+      NS_LOG_ERROR ("Creating a pipe failed: " << strerror (errno));
+      return;
+    }
+  // the child inherits unflushed output otherwise
+  std::cout.flush ();
+  std::cerr.flush ();
+  pid_t pid = fork ();
+  if (pid < 0)
+    {
+      NS_LOG_ERROR ("Forking failed: " << strerror (errno));
+      close (fds[0]);
+      close (fds[1]);
+      return;
+    }
+  if (pid == 0)
+    {
+      close (fds[0]);
+      RunPoint (scenario, point, fds[1]);
+      close (fds[1]);
+      // exit (not _exit): the log streams of the clients are flushed by the static destructors
+      exit (0);
+    }
+
+  close (fds[1]);
+  std::string result;
+  char buffer[256];
+  ssize_t n;
+  while ((n = read (fds[0], buffer, sizeof (buffer))) > 0)
+    {
+      result.append (buffer, n);
+    }
+  close (fds[0]);
+
+  int status;
+  struct rusage usage;
+  if (wait4 (pid, &status, 0, &usage) == pid)
+    {
+      point.status = WIFEXITED (status) ? WEXITSTATUS (status) : -1;
+      // kilobytes on Linux
+      point.peakRssKb = usage.ru_maxrss;
+    }
+  std::stringstream values (result);
+  values >> point.events >> point.setupSeconds >> point.runSeconds;
+  point.bytesWritten = DirectorySize (temp);
+}
+
+static void
+WriteCsvHeader (std::ostream & os)
+{
+  os << "clients,chunk,logLevel,simulationId,status,events,setup_s,wall_s,events_per_s,peak_rss_kb,bytes_written\n";
+}
+
+static void
+WriteCsv (std::ostream & os, const benchPoint & p)
+{
+  os << p.clients << "," << p.chunk << "," << p.logLevel << "," << p.simulationId << "," << p.status << ","
+     << p.events << "," << p.setupSeconds << "," << p.runSeconds << ","
+     << (p.runSeconds > 0 ? p.events / p.runSeconds : 0) << "," << p.peakRssKb << "," << p.bytesWritten << "\n";
+}
+
+static void
+WriteJson (std::ostream & os, const benchPoint & p, bool first)
+{
+  os << (first ? "[\n" : ",\n")
+     << "  {\"clients\": " << p.clients << ", \"chunk\": " << p.chunk << ", \"logLevel\": " << p.logLevel
+     << ", \"simulationId\": " << p.simulationId << ", \"status\": " << p.status
+     << ", \"events\": " << p.events << ", \"setup_s\": " << p.setupSeconds << ", \"wall_s\": " << p.runSeconds
+     << ", \"events_per_s\": " << (p.runSeconds > 0 ? p.events / p.runSeconds : 0)
+     << ", \"peak_rss_kb\": " << p.peakRssKb << ", \"bytes_written\": " << p.bytesWritten << "}";
+}
+
+int
+main (int argc, char *argv[])
+{
+  benchScenario scenario;
+  scenario.segmentDuration = 2000000;
+  scenario.adaptationAlgo = "festive";
+  scenario.linkRate = "5000Kbps";
+  scenario.delay = "10ms";
+  scenario.backboneRate = "100Gbps";
+  scenario.cmaf = 0;
+  scenario.stopTime = 60;
+  std::string clientList = "1,10,100,1000,10000";
+  std::string chunkList = "0,5";
+  std::string logLevelList = "0,2,3";
+  std::string format = "csv";
+  std::string outputPath;
+  uint32_t simulationId = 1000;
+
+  CommandLine cmd;
+  cmd.Usage ("Scaling benchmark of the DASH module: sweeps clients, chunking and log level, one process per point.\n");
+  cmd.AddValue ("clients", "Comma separated list of client counts", clientList);
+  cmd.AddValue ("chunks", "Comma separated list of chunks per segment, 0 for no chunks", chunkList);
+  cmd.AddValue ("logLevels", "Comma separated list of log levels (0: All, 1: Playback and stalls, 2: QoE metrics, 3: No log files)", logLevelList);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds, chunk durations are derived from it", scenario.segmentDuration);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes", scenario.segmentSizeFilePath);
+  cmd.AddValue ("chunkSizeFile", "The file containing the chunk sizes used by points with chunks, the segment size file if empty", scenario.chunkSizeFilePath);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithms of the clients, comma separated with optional weights (e.g. bola:3,festive:1)", scenario.adaptationAlgo);
+  cmd.AddValue ("linkRate", "The bitrate of every access link (e.g. 5000Kbps)", scenario.linkRate);
+  cmd.AddValue ("delay", "The delay of every access link (e.g. 10ms)", scenario.delay);
+  cmd.AddValue ("backboneRate", "The bitrate of the link between server and router", scenario.backboneRate);
+  cmd.AddValue ("cmaf", "CMAF version: 0: ABRs are dealing with chunks, 1: ABRs are dealing with segments, 2: ABRs optimized, 3: worst case scenario", scenario.cmaf);
+  cmd.AddValue ("stopTime", "Simulation stop time of every point in seconds", scenario.stopTime);
+  cmd.AddValue ("simulationId", "Simulation id of the first point, the points use consecutive ids for their log files", simulationId);
+  cmd.AddValue ("format", "Output format: csv or json", format);
+  cmd.AddValue ("output", "File the results are written to, standard output if empty", outputPath);
+  cmd.Parse (argc, argv);
+
+  if (format != "csv" && format != "json")
+    {
+      NS_LOG_ERROR ("Unknown output format " << format << ", use csv or json.");
+      return 1;
+    }
+
+  Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (524288));
+  Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue (524288));
+
+  const char * mylogsDir = dashLogDirectory.c_str();
+  mkdir (mylogsDir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+  std::ofstream outputFile;
+  if (!outputPath.empty ())
+    {
+      outputFile.open (outputPath.c_str ());
+      if (!outputFile)
+        {
+          NS_LOG_ERROR ("Opening output file " << outputPath << " failed.");
+          return 1;
+        }
+    }
+  std::ostream & output = outputPath.empty () ? std::cout : outputFile;
+
+  std::vector<uint32_t> clients = ParseList (clientList);
+  std::vector<uint32_t> chunks = ParseList (chunkList);
+  std::vector<uint32_t> logLevels = ParseList (logLevelList);
+
+  if (format == "csv")
+    {
+      WriteCsvHeader (output);
+    }
+  // the forked points must not inherit buffered output
+  output.flush ();
+  bool first = true;
+  for (uint32_t c = 0; c < clients.size (); c++)
+    {
+      for (uint32_t k = 0; k < chunks.size (); k++)
+        {
+          for (uint32_t l = 0; l < logLevels.size (); l++)
+            {
+              benchPoint point;
+              point.clients = clients.at (c);
+              point.chunk = chunks.at (k);
+              point.logLevel = logLevels.at (l);
+              point.simulationId = simulationId++;
+              MeasurePoint (scenario, point);
+              if (format == "csv")
+                {
+                  WriteCsv (output, point);
+                }
+              else
+                {
+                  WriteJson (output, point, first);
+                }
+              first = false;
+              output.flush ();
+            }
+        }
+    }
+  if (format == "json")
+    {
+      output << (first ? "[]\n" : "\n]\n");
+    }
+  return 0;
+}
@@ -0,0 +1,209 @@
+/*
+  Example script for a live audience with churn: clients join according to a Poisson process (with an optional
+  flash crowd of increased arrival rate) and leave after an exponentially distributed session length.
+*/
+
+#include <fstream>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/network-module.h"
+#include "ns3/csma-module.h"
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include "ns3/tcp-stream-helper.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-trace-replayer.h"
+#include "ns3/tcp-stream-churn-generator.h"
+
+template <typename T>
+std::string ToString(T val)
+{
+    std::stringstream stream;
+    stream << val;
+    return stream.str();
+}
+
+using namespace std;
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamExampleChurn");
+
+static std::ofstream sessionLog;
+
+static void
+LogSession (Ptr<TcpStreamChurnGenerator> churn, std::string event, uint32_t clientId)
+{
+  sessionLog << Simulator::Now ().GetSeconds () << " " << event << " " << clientId << " " << churn->GetActiveSessions () << "\n";
+}
+
+static void
+SetArrivalRate (Ptr<TcpStreamChurnGenerator> churn, double rate)
+{
+  churn->SetAttribute ("InterArrivalTime", StringValue ("ns3::ExponentialRandomVariable[Mean=" + ToString (1.0 / rate) + "]"));
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint64_t segmentDuration;
+  // The simulation id is used to distinguish log file results from potentially multiple consequent simulation runs.
+  uint32_t simulationId;
+  uint32_t numberOfClients;
+  std::string adaptationAlgo;
+  std::string segmentSizeFilePath;
+  std::string linkRate = "500Kbps";
+  std::string delay = "5ms";
+  double arrivalRate = 1.0;
+  double sessionLength = 120;
+  double flashCrowdStart = 0;
+  double flashCrowdDuration = 0;
+  double flashCrowdRate = 10.0;
+  int playbackStart = -1;
+  int chunk = 0;
+  int cmaf = 0;
+  string tracePath;
+  bool traceLoop = false;
+  int segmentsBehindLive = 1;
+  int logLevel = 0;
+  double stopTime = 400;
+
+  CommandLine cmd;
+  cmd.Usage ("Simulation of a live DASH audience with clients joining and leaving.\n");
+  cmd.AddValue ("simulationId", "The simulation's index (for logging purposes)", simulationId);
+  cmd.AddValue ("numberOfClients", "The maximum number of concurrent clients (client nodes)", numberOfClients);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds OR the duration of a chunk if chunks are active", segmentDuration);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithms of the clients, comma separated with optional weights (e.g. bola:3,festive:1)", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes OR chunk sizes if chunks are active", segmentSizeFilePath);
+  cmd.AddValue ("linkRate", "The bitrate of the link connecting the clients to the server (e.g. 500kbps)", linkRate);
+  cmd.AddValue ("delay", "The delay of the link connecting the clients to the server (e.g. 5ms)", delay);
+  cmd.AddValue ("arrivalRate", "Mean number of clients joining per second", arrivalRate);
+  cmd.AddValue ("sessionLength", "Mean session length in seconds", sessionLength);
+  cmd.AddValue ("flashCrowdStart", "Start of a flash crowd in seconds", flashCrowdStart);
+  cmd.AddValue ("flashCrowdDuration", "Duration of the flash crowd in seconds, 0 for none", flashCrowdDuration);
+  cmd.AddValue ("flashCrowdRate", "Mean number of clients joining per second during the flash crowd", flashCrowdRate);
+  cmd.AddValue ("playbackStart", "The number of segments/chunks to be fetched before playback starts (default -1: 1 complete DASH/CMAF segment).", playbackStart);
+  cmd.AddValue ("trace", "The relative path (from ns-3.x directory) to the network trace file", tracePath);
+  cmd.AddValue ("traceLoop", "Restart the network trace when its end is reached", traceLoop);
+  cmd.AddValue ("chunk", "Number of chunks in a segment, 0 if no chunks, set chunk duration in segmentDuration and chunk sizes in segmentSizeFile", chunk);
+  cmd.AddValue ("cmaf", "CMAF version: 0: ABRs are dealing with chunks, 1: ABRs are dealing with segments, 2: ABRs optimized, 3: worst case scenario", cmaf);
+  cmd.AddValue ("liveDelay", "Number of full DASH/CMAF segments behind live a client joins at.", segmentsBehindLive);
+  cmd.AddValue ("logLevel", "Logging level: 0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency, 3: No log files", logLevel);
+  cmd.AddValue ("stopTime", "Simulation stop time in seconds", stopTime);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (524288));
+  Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue (524288));
+
+  // create folders for logs
+  const char * mylogsDir = dashLogDirectory.c_str();
+  mkdir (mylogsDir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+  std::string temp = dashLogDirectory + "/SimID_" + ToString (simulationId);
+  const char * dir = temp.c_str();
+  mkdir(dir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+  NS_LOG_INFO("Create nodes.");
+
+  NodeContainer p2pNodes;
+  p2pNodes.Create (2);
+
+  NodeContainer csmaNodes;
+  csmaNodes.Add (p2pNodes.Get (1));
+  NodeContainer clientNodes;
+  clientNodes.Create (numberOfClients);
+  csmaNodes.Add (clientNodes);
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue (linkRate));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue (delay));
+  NetDeviceContainer p2pDevices = pointToPoint.Install (p2pNodes);
+
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("100Mbps"));
+  csma.SetChannelAttribute ("Delay", TimeValue (NanoSeconds (6560)));
+  NetDeviceContainer csmaDevices = csma.Install (csmaNodes);
+
+  InternetStackHelper stack;
+  stack.Install (p2pNodes.Get (0));
+  stack.Install (csmaNodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer p2pInterfaces = address.Assign (p2pDevices);
+  address.SetBase ("10.128.0.0", "255.255.0.0");
+  address.Assign (csmaDevices);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  /* Install TCP Receiver on the server, it has to survive periods without any client */
+  TcpStreamServerHelper serverHelper (80);
+  serverHelper.SetAttribute ("StopWhenIdle", BooleanValue (false));
+  ApplicationContainer serverApp = serverHelper.Install (p2pNodes.Get (0));
+  serverApp.Start (Seconds (0));
+
+  /* Clients join and leave dynamically, every client node hosts at most one session at a time */
+  Ptr<TcpStreamChurnGenerator> churn = CreateObject<TcpStreamChurnGenerator> ();
+  churn->SetClientAttribute ("RemoteAddress", AddressValue (Address (p2pInterfaces.GetAddress (0))));
+  churn->SetClientAttribute ("RemotePort", UintegerValue (80));
+  churn->SetClientAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+  churn->SetClientAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  churn->SetClientAttribute ("NumberOfClients", UintegerValue (numberOfClients));
+  churn->SetClientAttribute ("SimulationId", UintegerValue (simulationId));
+  if(playbackStart > 0) {
+    churn->SetClientAttribute ("PlaybackStart", UintegerValue (playbackStart));
+  }
+  churn->SetClientAttribute ("Chunk", UintegerValue (chunk));
+  churn->SetClientAttribute ("Cmaf", UintegerValue (cmaf));
+  churn->SetClientAttribute ("LogLevel", UintegerValue (logLevel));
+  churn->SetAttribute ("SessionLength", StringValue ("ns3::ExponentialRandomVariable[Mean=" + ToString (sessionLength) + "]"));
+  churn->SetAttribute ("LiveDelay", UintegerValue (segmentsBehindLive));
+  SetArrivalRate (churn, arrivalRate);
+  TcpStreamClientPopulation population;
+  population.AddAlgorithms (adaptationAlgo);
+  churn->SetPopulation (population);
+  churn->Install (clientNodes);
+  churn->Start (Seconds (0));
+
+  if (flashCrowdDuration > 0)
+  {
+    Simulator::Schedule (Seconds (flashCrowdStart), &SetArrivalRate, churn, flashCrowdRate);
+    Simulator::Schedule (Seconds (flashCrowdStart + flashCrowdDuration), &SetArrivalRate, churn, arrivalRate);
+  }
+
+  // log session starts and ends with the number of active sessions
+  if(logLevel == 0) {
+    std::string sessions = temp + "/" + "sessions.txt";
+    sessionLog.open (sessions.c_str());
+    sessionLog << "Time Event Client_Id Active_Sessions\n";
+    churn->TraceConnectWithoutContext ("SessionStart", MakeBoundCallback (&LogSession, churn, std::string ("start")));
+    churn->TraceConnectWithoutContext ("SessionEnd", MakeBoundCallback (&LogSession, churn, std::string ("end")));
+  }
+
+  /* Shape the server side of the bottleneck according to the network trace */
+  Ptr<TraceReplayer> traceReplayer = CreateObject<TraceReplayer> ();
+  if (!tracePath.empty ())
+  {
+    traceReplayer->SetAttribute ("Loop", BooleanValue (traceLoop));
+    if (traceReplayer->SetTraceFile (tracePath))
+    {
+      traceReplayer->AddDevice (DynamicCast<PointToPointNetDevice> (p2pDevices.Get (0)));
+      traceReplayer->Start (Seconds (0));
+    }
+    else
+    {
+      NS_LOG_ERROR ("Opening trace file " << tracePath << " failed.");
+    }
+  }
+
+  NS_LOG_INFO ("Run Simulation.");
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+  NS_LOG_INFO ("Sim ID: " << simulationId << " Sessions: " << churn->GetStartedSessions () << " Blocked: " << churn->GetBlockedArrivals ());
+  Simulator::Destroy ();
+  sessionLog.close ();
+  NS_LOG_INFO ("Done.");
+
+}
@@ -0,0 +1,197 @@
+/*
+  Example script where the clients stream from an edge cache, which fetches missed segments from an
+  origin server over a link of its own.
+*/
+
+#include <fstream>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/network-module.h"
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include "ns3/tcp-stream-helper.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-access-helper.h"
+#include "ns3/tcp-stream-qoe-aggregator.h"
+#include "ns3/tcp-stream-edge-server.h"
+
+template <typename T>
+std::string ToString(T val)
+{
+    std::stringstream stream;
+    stream << val;
+    return stream.str();
+}
+
+using namespace std;
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamExampleEdge");
+
+int
+main (int argc, char *argv[])
+{
+  uint64_t segmentDuration;
+  // The simulation id is used to distinguish log file results from potentially multiple consequent simulation runs.
+  uint32_t simulationId;
+  uint32_t numberOfClients;
+  std::string adaptationAlgo;
+  std::string segmentSizeFilePath;
+  std::string linkRate = "5000Kbps";
+  std::string delay = "10ms";
+  std::string backboneRate = "10Gbps";
+  std::string backboneDelay = "5ms";
+  std::string originRate = "100Mbps";
+  std::string originDelay = "20ms";
+  uint64_t cacheCapacity = 100000000;
+  std::string cachePolicy = "LRU";
+  uint32_t clientsPerLink = 1;
+  string tracePath;
+  int playbackStart = -1;
+  int chunk = 0;
+  int cmaf = 0;
+  int segmentsBehindLive = 1;
+  double streamJoinOffset = 0;
+  double startJitter = 0;
+  string requestTiming = "Random";
+  double requestWindow = 0;
+  int logLevel = 0;
+  double stopTime = 400;
+
+  CommandLine cmd;
+  cmd.Usage ("Simulation of streaming with DASH from an edge cache in front of an origin server.\n");
+  cmd.AddValue ("simulationId", "The simulation's index (for logging purposes)", simulationId);
+  cmd.AddValue ("numberOfClients", "The number of clients", numberOfClients);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds OR the duration of a chunk if chunks are active", segmentDuration);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithms of the clients, comma separated with optional weights (e.g. bola:3,festive:1)", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes OR chunk sizes if chunks are active", segmentSizeFilePath);
+  cmd.AddValue ("linkRate", "The initial bitrate of every access link (e.g. 5000Kbps)", linkRate);
+  cmd.AddValue ("delay", "The delay of every access link (e.g. 10ms)", delay);
+  cmd.AddValue ("backboneRate", "The bitrate of the link between edge and router", backboneRate);
+  cmd.AddValue ("backboneDelay", "The delay of the link between edge and router", backboneDelay);
+  cmd.AddValue ("originRate", "The bitrate of the link between origin and edge", originRate);
+  cmd.AddValue ("originDelay", "The delay of the link between origin and edge", originDelay);
+  cmd.AddValue ("cacheCapacity", "The capacity of the edge cache in bytes", cacheCapacity);
+  cmd.AddValue ("cachePolicy", "The replacement policy of the edge cache: LRU or LFU", cachePolicy);
+  cmd.AddValue ("clientsPerLink", "The number of clients sharing one access link", clientsPerLink);
+  cmd.AddValue ("trace", "The relative path (from ns-3.x directory) to a network trace file used for all access links", tracePath);
+  cmd.AddValue ("playbackStart", "The number of segments/chunks to be fetched before playback starts (default -1: 1 complete DASH/CMAF segment).", playbackStart);
+  cmd.AddValue ("chunk", "Number of chunks in a segment, 0 if no chunks, set chunk duration in segmentDuration and chunk sizes in segmentSizeFile", chunk);
+  cmd.AddValue ("cmaf", "CMAF version: 0: ABRs are dealing with chunks, 1: ABRs are dealing with segments, 2: ABRs optimized, 3: worst case scenario", cmaf);
+  cmd.AddValue ("liveDelay", "Number of full DASH/CMAF segments behind live.", segmentsBehindLive);
+  cmd.AddValue ("joinOffset", "Offset time to DASH/CMAF segment generation (s). eg 0.5s: the client will join the stream at 0.5s after a segment was generated", streamJoinOffset);
+  cmd.AddValue ("startJitter", "Clients start uniformly distributed within this many seconds after the live delay", startJitter);
+  cmd.AddValue ("requestTiming", "How requests waiting for a segment are spread over the request window: Random, Offset (per client id) or Paced", requestTiming);
+  cmd.AddValue ("requestWindow", "Window in seconds after the availability of a segment over which waiting requests are spread, 0 for none", requestWindow);
+  cmd.AddValue ("logLevel", "Logging level: 0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency, 3: No log files", logLevel);
+  cmd.AddValue ("stopTime", "Simulation stop time in seconds", stopTime);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (524288));
+  Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue (524288));
+
+  // create folders for logs
+  const char * mylogsDir = dashLogDirectory.c_str();
+  mkdir (mylogsDir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+  std::string temp = dashLogDirectory + "/SimID_" + ToString (simulationId);
+  const char * dir = temp.c_str();
+  mkdir(dir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+  NS_LOG_INFO("Create topology.");
+
+  // the server of the access topology is the edge
+  TcpStreamAccessHelper access;
+  access.SetBackboneDeviceAttribute ("DataRate", StringValue (backboneRate));
+  access.SetBackboneChannelAttribute ("Delay", StringValue (backboneDelay));
+  access.SetAccessDeviceAttribute ("DataRate", StringValue (linkRate));
+  access.SetAccessChannelAttribute ("Delay", StringValue (delay));
+  access.SetClientsPerLink (clientsPerLink);
+  if (!tracePath.empty ())
+  {
+    access.AddTraceFile (tracePath);
+  }
+  access.Install (numberOfClients);
+  Ptr<Node> edge = access.GetServer ();
+
+  // the origin hangs off the edge, the edge reaches it directly over the link
+  Ptr<Node> origin = CreateObject<Node> ();
+  InternetStackHelper stack;
+  stack.Install (origin);
+  PointToPointHelper originLink;
+  originLink.SetDeviceAttribute ("DataRate", StringValue (originRate));
+  originLink.SetChannelAttribute ("Delay", StringValue (originDelay));
+  NetDeviceContainer originDevices = originLink.Install (origin, edge);
+  Ipv4AddressHelper originAddress ("192.168.0.0", "255.255.255.252");
+  Ipv4InterfaceContainer originInterfaces = originAddress.Assign (originDevices);
+
+  /* Install the origin server and the edge cache */
+  TcpStreamServerHelper originHelper (80);
+  originHelper.SetAttribute ("StopWhenIdle", BooleanValue (false));
+  ApplicationContainer originApp = originHelper.Install (origin);
+  originApp.Start (Seconds (0));
+
+  TcpStreamEdgeServerHelper edgeHelper (originInterfaces.GetAddress (0), 80, 80);
+  edgeHelper.SetAttribute ("CacheCapacity", UintegerValue (cacheCapacity));
+  edgeHelper.SetAttribute ("ReplacementPolicy", StringValue (cachePolicy));
+  ApplicationContainer edgeApp = edgeHelper.Install (edge);
+  edgeApp.Start (Seconds (0));
+
+  /* Install TCP/UDP Transmitter on the clients */
+  TcpStreamClientHelper clientHelper (access.GetServerAddress (), 80);
+  clientHelper.SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+  clientHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  clientHelper.SetAttribute ("NumberOfClients", UintegerValue(numberOfClients));
+  clientHelper.SetAttribute ("SimulationId", UintegerValue (simulationId));
+  if(playbackStart > 0) {
+    clientHelper.SetAttribute ("PlaybackStart", UintegerValue (playbackStart));
+  }
+  clientHelper.SetAttribute ("Chunk", UintegerValue (chunk));
+  clientHelper.SetAttribute ("Cmaf", UintegerValue (cmaf));
+  clientHelper.SetAttribute ("LogLevel", UintegerValue (logLevel));
+  clientHelper.SetAttribute ("RequestTiming", StringValue (requestTiming));
+  clientHelper.SetAttribute ("RequestJitter", TimeValue (Seconds (requestWindow)));
+  double segDuration = (segmentDuration/1000000);
+  if(chunk > 0) segDuration = ((segmentDuration*chunk)/1000000);
+  double startTime = (segmentsBehindLive*segDuration)+(streamJoinOffset);
+  TcpStreamClientPopulation population;
+  population.AddAlgorithms (adaptationAlgo);
+  Ptr<UniformRandomVariable> jitter = 0;
+  if (startJitter > 0)
+  {
+    jitter = CreateObject<UniformRandomVariable> ();
+    jitter->SetAttribute ("Max", DoubleValue (startJitter));
+  }
+  population.SetStartTime (Seconds (startTime), jitter);
+  ApplicationContainer clientApps = clientHelper.Install (access.GetClients (), population);
+
+  /* Aggregate the QoE of all clients into one summary */
+  Ptr<TcpStreamQoeAggregator> qoe = CreateObject<TcpStreamQoeAggregator> ();
+  qoe->Install (clientApps);
+
+  access.StartTraces (Seconds (0));
+
+  NS_LOG_INFO ("Run Simulation.");
+  NS_LOG_INFO ("Sim ID: " << simulationId << " Clients: " << numberOfClients);
+  Simulator::Stop (Seconds(stopTime));
+  Simulator::Run ();
+  qoe->Write (temp + "/" + "qoeSummary.txt");
+
+  // hit ratio of the edge and the egress of the origin it caused
+  edgeCacheMetrics cache = DynamicCast<TcpStreamEdgeServer> (edgeApp.Get (0))->GetCacheMetrics ();
+  std::ofstream cacheSummary;
+  std::string cacheSummaryFile = temp + "/" + "cacheSummary.txt";
+  cacheSummary.open (cacheSummaryFile.c_str ());
+  cacheSummary << "Requests Hits Coalesced Misses Hit_Ratio Byte_Hit_Ratio Bytes_Served Origin_Bytes Evictions\n"
+               << cache.requests << " " << cache.hits << " " << cache.coalesced << " " << cache.misses << " "
+               << (cache.requests > 0 ? (double) cache.hits / cache.requests : 0) << " "
+               << (cache.bytesServed > 0 ? (double) cache.bytesFromCache / cache.bytesServed : 0) << " "
+               << cache.bytesServed << " " << cache.originBytes << " " << cache.evictions << "\n";
+  cacheSummary.close ();
+  Simulator::Destroy ();
+  NS_LOG_INFO ("Done.");
+
+}
@@ -0,0 +1,109 @@
+/*
+  Merges latency and stall histograms written by TcpStreamClient (attribute RecordHistograms) or by
+  TcpStreamQoeAggregator::WriteHistograms, e.g. of all runs of a parameter sweep, and prints their percentiles.
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/tcp-stream-histogram.h"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamHistogramMerge");
+
+static void
+PrintHistogram (std::ostream & os, const std::string & name, const LogLinearHistogram & histogram, const std::vector<double> & percentiles)
+{
+  os << name << " " << histogram.GetCount () << " " << histogram.GetMean () / (double)1000000 << " " << histogram.GetMin () / (double)1000000;
+  for (uint32_t i = 0; i < percentiles.size (); i++)
+    {
+      os << " " << histogram.GetPercentile (percentiles.at (i)) / (double)1000000;
+    }
+  os << " " << histogram.GetMax () / (double)1000000 << "\n";
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string histogramFiles;
+  std::string listFile;
+  std::string outputPath;
+  std::string percentileList = "50,90,95,99,99.9";
+
+  CommandLine cmd;
+  cmd.Usage ("Merge latency and stall histograms of clients or runs and print their percentiles (in seconds).\n");
+  cmd.AddValue ("histograms", "Comma separated list of histogram files (clientX_histograms.txt or histograms.txt)", histogramFiles);
+  cmd.AddValue ("list", "File listing one histogram file per line, for large sweeps", listFile);
+  cmd.AddValue ("output", "File the merged histograms are written to, for merging them further", outputPath);
+  cmd.AddValue ("percentiles", "Comma separated list of percentiles to print", percentileList);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> files;
+  std::stringstream names (histogramFiles);
+  std::string name;
+  while (std::getline (names, name, ','))
+    {
+      files.push_back (name);
+    }
+  if (!listFile.empty ())
+    {
+      std::ifstream list (listFile.c_str ());
+      if (!list)
+        {
+          NS_LOG_ERROR ("Opening list file " << listFile << " failed.");
+          return 1;
+        }
+      while (std::getline (list, name))
+        {
+          if (!name.empty ())
+            {
+              files.push_back (name);
+            }
+        }
+    }
+
+  std::vector<double> percentiles;
+  std::stringstream percentileStream (percentileList);
+  std::string percentile;
+  while (std::getline (percentileStream, percentile, ','))
+    {
+      percentiles.push_back (atof (percentile.c_str ()));
+    }
+
+  streamHistograms merged;
+  uint32_t read = 0;
+  for (uint32_t i = 0; i < files.size (); i++)
+    {
+      std::ifstream in (files.at (i).c_str ());
+      streamHistograms file;
+      if (!in || !file.MergeFrom (in))
+        {
+          NS_LOG_ERROR ("Skipping unreadable histogram file " << files.at (i));
+          continue;
+        }
+      merged.Merge (file);
+      read++;
+    }
+
+  if (!outputPath.empty ())
+    {
+      std::ofstream output (outputPath.c_str ());
+      merged.Write (output);
+    }
+
+  std::cout << "Files: " << read << "\n";
+  std::cout << "Metric Count Mean Min";
+  for (uint32_t i = 0; i < percentiles.size (); i++)
+    {
+      std::cout << " P" << percentiles.at (i);
+    }
+  std::cout << " Max\n";
+  PrintHistogram (std::cout, "Live_Latency", merged.liveLatency, percentiles);
+  PrintHistogram (std::cout, "Stall_Duration", merged.stallDuration, percentiles);
+  PrintHistogram (std::cout, "Download_Time", merged.downloadTime, percentiles);
+  PrintHistogram (std::cout, "First_Byte_Time", merged.firstByteTime, percentiles);
+  return 0;
+}
@@ -19,6 +19,8 @@
 #include "ns3/flow-monitor-module.h"
 #include "ns3/tcp-stream-helper.h"
 #include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-trace-replayer.h"
+#include "ns3/tcp-stream-qoe-aggregator.h"
 #include "ns3/csma-module.h"
 #include <fstream>
 
@@ -35,16 +37,6 @@ using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE ("TcpStreamExampleLan");
 
-queue<double> trafficShaping;
-
-void ChangeBandwidth()
-{
-  string newBandwidth = to_string(trafficShaping.front()) + "Kbps";
-  trafficShaping.pop();
-  //cout << newBandwidth << "\n";
-  Config::Set("/NodeList/0/DeviceList/0/$ns3::PointToPointNetDevice/DataRate", StringValue(newBandwidth) );
-}
-
 int
 main (int argc, char *argv[])
 {
@@ -61,9 +53,14 @@ main (int argc, char *argv[])
   int chunk = 0;
   int cmaf = 0; //0: ABRs are dealing with chunks, 1: ABRs are dealing with segments, 2: ABRs optimized, 3: worst case scenario
   string tracePath;
+  bool traceLoop = false;
+  double traceTimeScale = 1.0;
+  string traceFormat = "plain";
+  double traceSampleInterval = 0;
   int segmentsBehindLive = 1;
   double streamJoinOffset = 0;
   int logLevel = 0; //0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency
+  bool histograms = false;
 
   CommandLine cmd;
   cmd.Usage ("Simulation of streaming with DASH.\n");
@@ -77,11 +74,16 @@ main (int argc, char *argv[])
   cmd.AddValue ("buffer", "The initial buffer size as number of segments (eg 5)", buffer);
   cmd.AddValue ("playbackStart", "The number of segments/chunks to be fetched before playback starts (default -1: 1 complete DASH/CMAF segment).", playbackStart);
   cmd.AddValue ("trace", "The relative path (from ns-3.x directory) to the network trace file", tracePath);
+  cmd.AddValue ("traceLoop", "Restart the network trace when its end is reached", traceLoop);
+  cmd.AddValue ("traceTimeScale", "Factor applied to the timestamps of the network trace", traceTimeScale);
+  cmd.AddValue ("traceFormat", "Format of the network trace: plain (s kbps), mahimahi, fcc (s Mbps) or hsdpa", traceFormat);
+  cmd.AddValue ("traceSampleInterval", "Resample the network trace to this interval in seconds (mahimahi: bin size, default 1), 0 for none", traceSampleInterval);
   cmd.AddValue ("chunk", "Number of chunks in a segment, 0 if no chunks, set chunk duration in segmentDuration and chunk sizes in segmentSizeFile", chunk);
   cmd.AddValue ("cmaf", "CMAF version: 0: ABRs are dealing with chunks, 1: ABRs are dealing with segments, 2: ABRs optimized, 3: worst case scenario", cmaf);
   cmd.AddValue ("liveDelay", "Number of full DASH/CMAF segments behind live.", segmentsBehindLive);
   cmd.AddValue ("joinOffset", "Offset time to DASH/CMAF segment generation (s). eg 0.5s: the client will join the stream at 0.5s after a segment was generated", streamJoinOffset);
-  cmd.AddValue ("logLevel", "Logging level: 0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency", logLevel);
+  cmd.AddValue ("logLevel", "Logging level: 0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency, 3: No log files", logLevel);
+  cmd.AddValue ("histograms", "Record latency and stall histograms per client and write their merge to histograms.txt", histograms);
   cmd.Parse (argc, argv);
 
 
@@ -175,6 +177,7 @@ main (int argc, char *argv[])
   clientHelper.SetAttribute ("Chunk", UintegerValue (chunk));
   clientHelper.SetAttribute ("Cmaf", UintegerValue (cmaf));
   clientHelper.SetAttribute ("LogLevel", UintegerValue (logLevel));
+  clientHelper.SetAttribute ("RecordHistograms", BooleanValue (histograms));
   ApplicationContainer clientApps = clientHelper.Install (clients);
   for (uint i = 0; i < clientApps.GetN (); i++)
   {
@@ -191,23 +194,41 @@ main (int argc, char *argv[])
     clientApps.Get (i)->SetStartTime (Seconds (startTime));
   }
 
+  /* Aggregate the QoE of all clients into one summary */
+  Ptr<TcpStreamQoeAggregator> qoe = CreateObject<TcpStreamQoeAggregator> ();
+  qoe->Install (clientApps);
+
   Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
   NS_LOG_INFO ("Run Simulation.");
   NS_LOG_INFO ("Sim ID: " << simulationId << " Clients: " << numberOfClients);
 	
-  /* Read traffic shaping file, populate the queue and schedule the bandwidth changes */
-  std::ifstream infile(tracePath);
-  double a, b;
-  while (infile >> a >> b)
+  /* Shape the server side of the bottleneck according to the network trace */
+  Ptr<TraceReplayer> traceReplayer = CreateObject<TraceReplayer> ();
+  if (!tracePath.empty ())
   {
-    //cout << a << " " << b << "\n";
-    trafficShaping.push(b);
-    Simulator::Schedule (Seconds(a) , &ChangeBandwidth);
+    traceReplayer->SetAttribute ("Loop", BooleanValue (traceLoop));
+    traceReplayer->SetAttribute ("TimeScale", DoubleValue (traceTimeScale));
+    traceReplayer->SetAttribute ("Format", StringValue (traceFormat));
+    traceReplayer->SetAttribute ("SampleInterval", TimeValue (Seconds (traceSampleInterval)));
+    if (traceReplayer->SetTraceFile (tracePath))
+    {
+      traceReplayer->AddDevice (DynamicCast<PointToPointNetDevice> (p2pDevices.Get (0)));
+      traceReplayer->Start (Seconds (0));
+    }
+    else
+    {
+      NS_LOG_ERROR ("Opening trace file " << tracePath << " failed.");
+    }
   }
 	  
   Simulator::Stop (Seconds(400));
   Simulator::Run ();
+  qoe->Write (temp + "/" + "qoeSummary.txt");
+  if (histograms)
+  {
+    qoe->WriteHistograms (temp + "/" + "histograms.txt");
+  }
   Simulator::Destroy ();
   NS_LOG_INFO ("Done.");
 
@@ -0,0 +1,239 @@
+/*
+  Example script for distributed simulation of large client populations. Every MPI rank simulates one
+  subnet of clients behind its own access point, the server and the shared bottleneck live on rank 0.
+  The router - access point links cross rank boundaries, their delay is the lookahead of the ranks.
+
+  mpirun -np 4 ./waf "--run=tcp-stream-mpi --simulationId=0 --numberOfClients=5000 --adaptationAlgo=festive ..."
+*/
+
+#include <fstream>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/network-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/mpi-interface.h"
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include "ns3/tcp-stream-helper.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-trace-replayer.h"
+
+template <typename T>
+std::string ToString(T val)
+{
+    std::stringstream stream;
+    stream << val;
+    return stream.str();
+}
+
+using namespace std;
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamExampleMpi");
+
+int
+main (int argc, char *argv[])
+{
+  uint64_t segmentDuration;
+  // The simulation id is used to distinguish log file results from potentially multiple consequent simulation runs.
+  uint32_t simulationId;
+  uint32_t numberOfClients;
+  std::string adaptationAlgo;
+  std::string segmentSizeFilePath;
+  std::string linkRate = "500Kbps";
+  std::string delay = "5ms";
+  std::string apRate = "10Gbps";
+  std::string apDelay = "1ms";
+  bool nullmsg = false;
+  int playbackStart = -1;
+  int chunk = 0;
+  int cmaf = 0;
+  string tracePath;
+  bool traceLoop = false;
+  double traceTimeScale = 1.0;
+  string traceFormat = "plain";
+  double traceSampleInterval = 0;
+  int segmentsBehindLive = 1;
+  double streamJoinOffset = 0;
+  double startJitter = 0;
+  int logLevel = 0;
+  double stopTime = 400;
+
+  CommandLine cmd;
+  cmd.Usage ("Distributed simulation of streaming with DASH.\n");
+  cmd.AddValue ("simulationId", "The simulation's index (for logging purposes)", simulationId);
+  cmd.AddValue ("numberOfClients", "The number of clients, spread evenly over the ranks", numberOfClients);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds OR the duration of a chunk if chunks are active", segmentDuration);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithms of the clients, comma separated with optional weights (e.g. bola:3,festive:1)", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes OR chunk sizes if chunks are active", segmentSizeFilePath);
+  cmd.AddValue ("linkRate", "The bitrate of the shared bottleneck between server and router (e.g. 500kbps)", linkRate);
+  cmd.AddValue ("delay", "The delay of the shared bottleneck between server and router (e.g. 5ms)", delay);
+  cmd.AddValue ("apRate", "The bitrate of the links between the router and the access points", apRate);
+  cmd.AddValue ("apDelay", "The delay of the links between the router and the access points, the lookahead of the ranks (must be > 0)", apDelay);
+  cmd.AddValue ("nullmsg", "Use the null message synchronisation instead of the granted time window", nullmsg);
+  cmd.AddValue ("playbackStart", "The number of segments/chunks to be fetched before playback starts (default -1: 1 complete DASH/CMAF segment).", playbackStart);
+  cmd.AddValue ("trace", "The relative path (from ns-3.x directory) to the network trace file shaping the bottleneck", tracePath);
+  cmd.AddValue ("traceLoop", "Restart the network trace when its end is reached", traceLoop);
+  cmd.AddValue ("traceTimeScale", "Factor applied to the timestamps of the network trace", traceTimeScale);
+  cmd.AddValue ("traceFormat", "Format of the network trace: plain (s kbps), mahimahi, fcc (s Mbps) or hsdpa", traceFormat);
+  cmd.AddValue ("traceSampleInterval", "Resample the network trace to this interval in seconds (mahimahi: bin size, default 1), 0 for none", traceSampleInterval);
+  cmd.AddValue ("chunk", "Number of chunks in a segment, 0 if no chunks, set chunk duration in segmentDuration and chunk sizes in segmentSizeFile", chunk);
+  cmd.AddValue ("cmaf", "CMAF version: 0: ABRs are dealing with chunks, 1: ABRs are dealing with segments, 2: ABRs optimized, 3: worst case scenario", cmaf);
+  cmd.AddValue ("liveDelay", "Number of full DASH/CMAF segments behind live.", segmentsBehindLive);
+  cmd.AddValue ("joinOffset", "Offset time to DASH/CMAF segment generation (s). eg 0.5s: the client will join the stream at 0.5s after a segment was generated", streamJoinOffset);
+  cmd.AddValue ("startJitter", "Clients start uniformly distributed within this many seconds after the live delay", startJitter);
+  cmd.AddValue ("logLevel", "Logging level: 0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency, 3: No log files", logLevel);
+  cmd.AddValue ("stopTime", "Simulation stop time in seconds, the same on every rank", stopTime);
+  cmd.Parse (argc, argv);
+
+  if (nullmsg)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::NullMessageSimulatorImpl"));
+    }
+  else
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DistributedSimulatorImpl"));
+    }
+  MpiInterface::Enable (&argc, &argv);
+
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  uint32_t systemCount = MpiInterface::GetSize ();
+  NS_ABORT_MSG_IF (Time (apDelay).IsZero (), "The access point links provide the lookahead, apDelay must be > 0");
+
+  Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (524288));
+  Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue (524288));
+
+  // create folders for logs, clients of all ranks log into the same directory
+  const char * mylogsDir = dashLogDirectory.c_str();
+  mkdir (mylogsDir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+  std::string temp = dashLogDirectory + "/SimID_" + ToString (simulationId);
+  const char * dir = temp.c_str();
+  mkdir(dir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+  // log parameters
+  if(logLevel == 0 && systemId == 0) {
+    std::ofstream parLog;
+    std::string pars = temp + "/" + "parameters.txt";
+    parLog.open (pars.c_str());
+    parLog << ToString(simulationId) << "," << ToString(numberOfClients) << "," << ToString(segmentDuration) << "," << ToString(systemCount) << "," << ToString(adaptationAlgo) << "," << ToString(linkRate) << "," << ToString(delay) << "\n";
+    parLog.flush ();
+  }
+
+  NS_LOG_INFO("Create nodes.");
+
+  /* Every rank creates the complete topology, each node is owned by one rank */
+  Ptr<Node> server = CreateObject<Node> (0);
+  Ptr<Node> router = CreateObject<Node> (0);
+
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue (linkRate));
+  bottleneck.SetChannelAttribute ("Delay", StringValue (delay));
+  NetDeviceContainer bottleneckDevices = bottleneck.Install (server, router);
+
+  PointToPointHelper apLink;
+  apLink.SetDeviceAttribute ("DataRate", StringValue (apRate));
+  apLink.SetChannelAttribute ("Delay", StringValue (apDelay));
+
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("100Mbps"));
+  csma.SetChannelAttribute ("Delay", TimeValue (NanoSeconds (6560)));
+
+  InternetStackHelper stack;
+  stack.Install (server);
+  stack.Install (router);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer bottleneckInterfaces = address.Assign (bottleneckDevices);
+
+  /* Determin client nodes for object creation with client helper class, contiguous client ids per rank */
+  NodeContainer clients;
+  for (uint32_t rank = 0; rank < systemCount; rank++)
+    {
+      uint32_t first = (uint64_t) numberOfClients * rank / systemCount;
+      uint32_t last = (uint64_t) numberOfClients * (rank + 1) / systemCount;
+
+      Ptr<Node> accessPoint = CreateObject<Node> (rank);
+      NodeContainer subnet (accessPoint);
+      NodeContainer subnetClients;
+      subnetClients.Create (last - first, rank);
+      subnet.Add (subnetClients);
+      stack.Install (subnet);
+
+      NetDeviceContainer apDevices = apLink.Install (router, accessPoint);
+      address.SetBase (Ipv4Address (0x0a020000 + (rank << 8)), "255.255.255.0");
+      address.Assign (apDevices);
+
+      NetDeviceContainer csmaDevices = csma.Install (subnet);
+      address.SetBase (Ipv4Address (0x0a800000 + (rank << 16)), "255.255.0.0");
+      address.Assign (csmaDevices);
+
+      clients.Add (subnetClients);
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  /* Install TCP Receiver on the server, only on rank 0. With clients on other ranks it must not stop the simulation on its own. */
+  TcpStreamServerHelper serverHelper (80);
+  serverHelper.SetAttribute ("StopWhenIdle", BooleanValue (systemCount == 1));
+  ApplicationContainer serverApp = serverHelper.Install (server);
+  serverApp.Start (Seconds (0));
+
+  /* Install TCP/UDP Transmitter on the clients owned by this rank */
+  TcpStreamClientHelper clientHelper (bottleneckInterfaces.GetAddress (0), 80);
+  clientHelper.SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+  clientHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  clientHelper.SetAttribute ("NumberOfClients", UintegerValue(numberOfClients));
+  clientHelper.SetAttribute ("SimulationId", UintegerValue (simulationId));
+  if(playbackStart > 0) {
+    clientHelper.SetAttribute ("PlaybackStart", UintegerValue (playbackStart));
+  }
+  clientHelper.SetAttribute ("Chunk", UintegerValue (chunk));
+  clientHelper.SetAttribute ("Cmaf", UintegerValue (cmaf));
+  clientHelper.SetAttribute ("LogLevel", UintegerValue (logLevel));
+  double segDuration = (segmentDuration/1000000);
+  if(chunk > 0) segDuration = ((segmentDuration*chunk)/1000000);
+  double startTime = (segmentsBehindLive*segDuration)+(streamJoinOffset);
+  TcpStreamClientPopulation population;
+  population.AddAlgorithms (adaptationAlgo);
+  Ptr<UniformRandomVariable> jitter = 0;
+  if (startJitter > 0)
+  {
+    jitter = CreateObject<UniformRandomVariable> ();
+    jitter->SetAttribute ("Max", DoubleValue (startJitter));
+  }
+  population.SetStartTime (Seconds (startTime), jitter);
+  ApplicationContainer clientApps = clientHelper.Install (clients, population);
+
+  /* Shape the server side of the bottleneck according to the network trace, on the rank owning it */
+  Ptr<TraceReplayer> traceReplayer = CreateObject<TraceReplayer> ();
+  if (!tracePath.empty () && systemId == 0)
+  {
+    traceReplayer->SetAttribute ("Loop", BooleanValue (traceLoop));
+    traceReplayer->SetAttribute ("TimeScale", DoubleValue (traceTimeScale));
+    traceReplayer->SetAttribute ("Format", StringValue (traceFormat));
+    traceReplayer->SetAttribute ("SampleInterval", TimeValue (Seconds (traceSampleInterval)));
+    if (traceReplayer->SetTraceFile (tracePath))
+    {
+      traceReplayer->AddDevice (DynamicCast<PointToPointNetDevice> (bottleneckDevices.Get (0)));
+      traceReplayer->Start (Seconds (0));
+    }
+    else
+    {
+      NS_LOG_ERROR ("Opening trace file " << tracePath << " failed.");
+    }
+  }
+
+  NS_LOG_INFO ("Run Simulation.");
+  NS_LOG_INFO ("Sim ID: " << simulationId << " Rank: " << systemId << "/" << systemCount << " Clients: " << clientApps.GetN ());
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  MpiInterface::Disable ();
+  NS_LOG_INFO ("Done.");
+
+}
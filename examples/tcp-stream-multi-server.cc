@@ -0,0 +1,234 @@
+/*
+  Example script where the clients choose among several servers, each behind its own backbone link,
+  and fail over to the others when a server is stopped.
+*/
+
+#include <fstream>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/network-module.h"
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include "ns3/tcp-stream-helper.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-access-helper.h"
+#include "ns3/tcp-stream-qoe-aggregator.h"
+#include "ns3/tcp-stream-server.h"
+#include "ns3/tcp-stream-client.h"
+
+template <typename T>
+std::string ToString(T val)
+{
+    std::stringstream stream;
+    stream << val;
+    return stream.str();
+}
+
+using namespace std;
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamExampleMultiServer");
+
+static std::ofstream failoverLog;
+static uint32_t sessionsLeft;
+
+static void
+LogFailover (uint32_t clientId, uint32_t fromServer, uint32_t toServer, Time outage)
+{
+  failoverLog << Simulator::Now ().GetSeconds () << " " << clientId << " " << fromServer << " " << toServer << " " << outage.GetSeconds () << "\n";
+}
+
+static void
+SessionEnded (Ptr<TcpStreamClient> client)
+{
+  // the servers do not stop the simulation, every client is connected to several of them
+  if (--sessionsLeft == 0)
+    {
+      Simulator::Stop ();
+    }
+}
+
+static std::vector<std::string>
+SplitList (std::string list)
+{
+  std::vector<std::string> values;
+  std::stringstream stream (list);
+  std::string value;
+  while (std::getline (stream, value, ','))
+    {
+      values.push_back (value);
+    }
+  return values;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint64_t segmentDuration;
+  // The simulation id is used to distinguish log file results from potentially multiple consequent simulation runs.
+  uint32_t simulationId;
+  uint32_t numberOfClients;
+  std::string adaptationAlgo;
+  std::string segmentSizeFilePath;
+  std::string linkRate = "5000Kbps";
+  std::string delay = "10ms";
+  std::string backboneRate = "100Mbps";
+  std::string backboneDelay = "5ms";
+  uint32_t numberOfServers = 2;
+  string serverRates;
+  string serverWeights;
+  string serverSelection = "RoundRobin";
+  int failServer = -1;
+  double failTime = 60;
+  double requestTimeout = 0;
+  double serverRetry = 10;
+  uint32_t clientsPerLink = 1;
+  string tracePath;
+  int segmentsBehindLive = 1;
+  double streamJoinOffset = 0;
+  double startJitter = 0;
+  int logLevel = 0;
+  double stopTime = 400;
+
+  CommandLine cmd;
+  cmd.Usage ("Simulation of streaming with DASH from several servers with server selection and failover.\n");
+  cmd.AddValue ("simulationId", "The simulation's index (for logging purposes)", simulationId);
+  cmd.AddValue ("numberOfClients", "The number of clients", numberOfClients);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds", segmentDuration);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithms of the clients, comma separated with optional weights (e.g. bola:3,festive:1)", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes", segmentSizeFilePath);
+  cmd.AddValue ("linkRate", "The initial bitrate of every access link (e.g. 5000Kbps)", linkRate);
+  cmd.AddValue ("delay", "The delay of every access link (e.g. 10ms)", delay);
+  cmd.AddValue ("backboneRate", "The bitrate of the link between every server and the router", backboneRate);
+  cmd.AddValue ("backboneDelay", "The delay of the link between every server and the router", backboneDelay);
+  cmd.AddValue ("numberOfServers", "The number of servers", numberOfServers);
+  cmd.AddValue ("serverRates", "Comma separated bitrates of the server links, in server order, overriding backboneRate (e.g. 100Mbps,20Mbps)", serverRates);
+  cmd.AddValue ("serverWeights", "Comma separated weights of the servers for weighted selection (e.g. 3,1)", serverWeights);
+  cmd.AddValue ("serverSelection", "How clients choose the server of a request: RoundRobin, Weighted, Rtt or Throughput", serverSelection);
+  cmd.AddValue ("failServer", "Index of the server that is stopped at failTime, -1 for none", failServer);
+  cmd.AddValue ("failTime", "Time in seconds at which failServer is stopped", failTime);
+  cmd.AddValue ("requestTimeout", "Seconds without progress after which a request is repeated on another server, 0 to only fail over on broken connections", requestTimeout);
+  cmd.AddValue ("serverRetry", "Seconds a failed server is skipped before it is tried again", serverRetry);
+  cmd.AddValue ("clientsPerLink", "The number of clients sharing one access link", clientsPerLink);
+  cmd.AddValue ("trace", "The relative path (from ns-3.x directory) to a network trace file used for all access links", tracePath);
+  cmd.AddValue ("liveDelay", "Number of full DASH segments behind live.", segmentsBehindLive);
+  cmd.AddValue ("joinOffset", "Offset time to DASH segment generation (s). eg 0.5s: the client will join the stream at 0.5s after a segment was generated", streamJoinOffset);
+  cmd.AddValue ("startJitter", "Clients start uniformly distributed within this many seconds after the live delay", startJitter);
+  cmd.AddValue ("logLevel", "Logging level: 0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency, 3: No log files", logLevel);
+  cmd.AddValue ("stopTime", "Simulation stop time in seconds", stopTime);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (524288));
+  Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue (524288));
+
+  // create folders for logs
+  const char * mylogsDir = dashLogDirectory.c_str();
+  mkdir (mylogsDir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+  std::string temp = dashLogDirectory + "/SimID_" + ToString (simulationId);
+  const char * dir = temp.c_str();
+  mkdir(dir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+  NS_LOG_INFO("Create topology.");
+
+  TcpStreamAccessHelper access;
+  access.SetBackboneDeviceAttribute ("DataRate", StringValue (backboneRate));
+  access.SetBackboneChannelAttribute ("Delay", StringValue (backboneDelay));
+  access.SetAccessDeviceAttribute ("DataRate", StringValue (linkRate));
+  access.SetAccessChannelAttribute ("Delay", StringValue (delay));
+  access.SetClientsPerLink (clientsPerLink);
+  access.SetServers (numberOfServers);
+  if (!tracePath.empty ())
+  {
+    access.AddTraceFile (tracePath);
+  }
+  access.Install (numberOfClients);
+
+  // shape the egress of the servers individually
+  std::vector<std::string> rates = SplitList (serverRates);
+  for (uint32_t i = 0; i < rates.size () && i < numberOfServers; i++)
+  {
+    access.GetBackboneDevices ().Get (i)->SetAttribute ("DataRate", StringValue (rates.at (i)));
+  }
+
+  /* Install TCP Receiver on the servers */
+  TcpStreamServerHelper serverHelper (80);
+  serverHelper.SetAttribute ("StopWhenIdle", BooleanValue (false));
+  ApplicationContainer serverApps = serverHelper.Install (access.GetServers ());
+  serverApps.Start (Seconds (0));
+  if (failServer >= 0 && failServer < (int) numberOfServers)
+  {
+    serverApps.Get (failServer)->SetStopTime (Seconds (failTime));
+  }
+
+  /* Install TCP/UDP Transmitter on the clients */
+  TcpStreamClientHelper clientHelper (access.GetServerAddress (), 80);
+  std::vector<std::string> weights = SplitList (serverWeights);
+  for (uint32_t i = 0; i < numberOfServers; i++)
+  {
+    clientHelper.AddServer (access.GetServerAddress (i), 80, i < weights.size () ? atof (weights.at (i).c_str ()) : 1);
+  }
+  clientHelper.SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+  clientHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  clientHelper.SetAttribute ("NumberOfClients", UintegerValue(numberOfClients));
+  clientHelper.SetAttribute ("SimulationId", UintegerValue (simulationId));
+  clientHelper.SetAttribute ("LogLevel", UintegerValue (logLevel));
+  clientHelper.SetAttribute ("ServerSelection", StringValue (serverSelection));
+  clientHelper.SetAttribute ("RequestTimeout", TimeValue (Seconds (requestTimeout)));
+  clientHelper.SetAttribute ("ServerRetryInterval", TimeValue (Seconds (serverRetry)));
+  double segDuration = (segmentDuration/1000000);
+  double startTime = (segmentsBehindLive*segDuration)+(streamJoinOffset);
+  TcpStreamClientPopulation population;
+  population.AddAlgorithms (adaptationAlgo);
+  Ptr<UniformRandomVariable> jitter = 0;
+  if (startJitter > 0)
+  {
+    jitter = CreateObject<UniformRandomVariable> ();
+    jitter->SetAttribute ("Max", DoubleValue (startJitter));
+  }
+  population.SetStartTime (Seconds (startTime), jitter);
+  ApplicationContainer clientApps = clientHelper.Install (access.GetClients (), population);
+
+  std::string failovers = temp + "/" + "failover.txt";
+  failoverLog.open (failovers.c_str ());
+  failoverLog << "Time Client From_Server To_Server Outage\n";
+  sessionsLeft = clientApps.GetN ();
+  for (uint32_t i = 0; i < clientApps.GetN (); i++)
+  {
+    Ptr<TcpStreamClient> client = DynamicCast<TcpStreamClient> (clientApps.Get (i));
+    client->TraceConnectWithoutContext ("Failover", MakeCallback (&LogFailover));
+    client->SetSessionEndCallback (MakeCallback (&SessionEnded));
+  }
+
+  /* Aggregate the QoE of all clients into one summary */
+  Ptr<TcpStreamQoeAggregator> qoe = CreateObject<TcpStreamQoeAggregator> ();
+  qoe->Install (clientApps);
+
+  access.StartTraces (Seconds (0));
+
+  NS_LOG_INFO ("Run Simulation.");
+  NS_LOG_INFO ("Sim ID: " << simulationId << " Clients: " << numberOfClients << " Servers: " << numberOfServers);
+  Simulator::Stop (Seconds(stopTime));
+  Simulator::Run ();
+  qoe->Write (temp + "/" + "qoeSummary.txt");
+  failoverLog.close ();
+
+  // distribution of the load over the servers
+  std::ofstream serverLoad;
+  std::string serverLoadFile = temp + "/" + "serverLoad.txt";
+  serverLoad.open (serverLoadFile.c_str ());
+  serverLoad << "Server Requests Peak_Requests_In_Window Peak_Active_Requests Mean_Active_Requests Peak_Outstanding_Bytes Mean_Outstanding_Bytes\n";
+  for (uint32_t i = 0; i < serverApps.GetN (); i++)
+  {
+    serverLoadMetrics load = DynamicCast<TcpStreamServer> (serverApps.Get (i))->GetLoadMetrics ();
+    serverLoad << i << " " << load.requests << " " << load.peakRequestsInWindow << " " << load.peakActiveRequests << " " << load.meanActiveRequests << " "
+               << load.peakOutstandingBytes << " " << load.meanOutstandingBytes << "\n";
+  }
+  serverLoad.close ();
+  Simulator::Destroy ();
+  NS_LOG_INFO ("Done.");
+
+}
@@ -0,0 +1,200 @@
+/*
+  Example script where the clients take the segments from multicast groups, one group per representation,
+  replicated at the router, and request only the bytes they missed from the server.
+*/
+
+#include <fstream>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/network-module.h"
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include "ns3/tcp-stream-helper.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-access-helper.h"
+#include "ns3/tcp-stream-qoe-aggregator.h"
+#include "ns3/tcp-stream-server.h"
+#include "ns3/tcp-stream-multicast.h"
+
+template <typename T>
+std::string ToString(T val)
+{
+    std::stringstream stream;
+    stream << val;
+    return stream.str();
+}
+
+using namespace std;
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamExampleMulticast");
+
+static uint64_t repairs;
+static uint64_t repairBytes;
+
+static void
+LogRepair (uint32_t clientId, int64_t segmentIndex, int64_t repIndex, int64_t bytes)
+{
+  repairs++;
+  repairBytes += bytes;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint64_t segmentDuration;
+  // The simulation id is used to distinguish log file results from potentially multiple consequent simulation runs.
+  uint32_t simulationId;
+  uint32_t numberOfClients;
+  std::string adaptationAlgo;
+  std::string segmentSizeFilePath;
+  std::string linkRate = "5000Kbps";
+  std::string delay = "10ms";
+  std::string backboneRate = "100Mbps";
+  std::string backboneDelay = "5ms";
+  bool multicast = true;
+  double speedup = 1.25;
+  uint32_t packetSize = 1400;
+  double repairTimeout = 0.5;
+  uint32_t clientsPerLink = 1;
+  string tracePath;
+  int segmentsBehindLive = 1;
+  double streamJoinOffset = 0;
+  double startJitter = 0;
+  int logLevel = 0;
+  double stopTime = 400;
+
+  CommandLine cmd;
+  cmd.Usage ("Simulation of live streaming with DASH over multicast groups with unicast repair.\n");
+  cmd.AddValue ("simulationId", "The simulation's index (for logging purposes)", simulationId);
+  cmd.AddValue ("numberOfClients", "The number of clients", numberOfClients);
+  cmd.AddValue ("segmentDuration", "The duration of a video segment in microseconds", segmentDuration);
+  cmd.AddValue ("adaptationAlgo", "The adaptation algorithms of the clients, comma separated with optional weights (e.g. bola:3,festive:1)", adaptationAlgo);
+  cmd.AddValue ("segmentSizeFile", "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes", segmentSizeFilePath);
+  cmd.AddValue ("linkRate", "The initial bitrate of every access link (e.g. 5000Kbps)", linkRate);
+  cmd.AddValue ("delay", "The delay of every access link (e.g. 10ms)", delay);
+  cmd.AddValue ("backboneRate", "The bitrate of the link between server and router", backboneRate);
+  cmd.AddValue ("backboneDelay", "The delay of the link between server and router", backboneDelay);
+  cmd.AddValue ("multicast", "Take the segments from multicast groups (1) or request all of them from the server (0)", multicast);
+  cmd.AddValue ("speedup", "A segment is multicast within its duration divided by this", speedup);
+  cmd.AddValue ("packetSize", "Segment bytes per multicast datagram", packetSize);
+  cmd.AddValue ("repairTimeout", "Seconds without datagrams of the awaited segment after which its missing bytes are requested from the server", repairTimeout);
+  cmd.AddValue ("clientsPerLink", "The number of clients sharing one access link", clientsPerLink);
+  cmd.AddValue ("trace", "The relative path (from ns-3.x directory) to a network trace file used for all access links", tracePath);
+  cmd.AddValue ("liveDelay", "Number of full DASH segments behind live.", segmentsBehindLive);
+  cmd.AddValue ("joinOffset", "Offset time to DASH segment generation (s). eg 0.5s: the client will join the stream at 0.5s after a segment was generated", streamJoinOffset);
+  cmd.AddValue ("startJitter", "Clients start uniformly distributed within this many seconds after the live delay", startJitter);
+  cmd.AddValue ("logLevel", "Logging level: 0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency, 3: No log files", logLevel);
+  cmd.AddValue ("stopTime", "Simulation stop time in seconds", stopTime);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue (1446));
+  Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue (524288));
+  Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue (524288));
+
+  // create folders for logs
+  const char * mylogsDir = dashLogDirectory.c_str();
+  mkdir (mylogsDir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+  std::string temp = dashLogDirectory + "/SimID_" + ToString (simulationId);
+  const char * dir = temp.c_str();
+  mkdir(dir, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+  NS_LOG_INFO("Create topology.");
+
+  TcpStreamAccessHelper access;
+  access.SetBackboneDeviceAttribute ("DataRate", StringValue (backboneRate));
+  access.SetBackboneChannelAttribute ("Delay", StringValue (backboneDelay));
+  access.SetAccessDeviceAttribute ("DataRate", StringValue (linkRate));
+  access.SetAccessChannelAttribute ("Delay", StringValue (delay));
+  access.SetClientsPerLink (clientsPerLink);
+  if (!tracePath.empty ())
+  {
+    access.AddTraceFile (tracePath);
+  }
+  access.Install (numberOfClients);
+
+  /* Install TCP Receiver on the server, it answers the repairs */
+  TcpStreamServerHelper serverHelper (80);
+  ApplicationContainer serverApp = serverHelper.Install (access.GetServer ());
+  serverApp.Start (Seconds (0));
+
+  /* The source on the server multicasts every representation, the router replicates the groups */
+  ApplicationContainer sourceApp;
+  ApplicationContainer replicatorApp;
+  if (multicast)
+  {
+    TcpStreamMulticastReplicatorHelper replicatorHelper (5001, 5000);
+    replicatorApp = replicatorHelper.Install (access.GetRouter ());
+    replicatorApp.Start (Seconds (0));
+
+    TcpStreamMulticastSourceHelper sourceHelper (access.GetRouterAddress (), 5001);
+    sourceHelper.SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+    sourceHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+    sourceHelper.SetAttribute ("PacketSize", UintegerValue (packetSize));
+    sourceHelper.SetAttribute ("Speedup", DoubleValue (speedup));
+    sourceApp = sourceHelper.Install (access.GetServer ());
+    sourceApp.Start (Seconds (0));
+  }
+
+  /* Install TCP/UDP Transmitter on the clients */
+  TcpStreamClientHelper clientHelper (access.GetServerAddress (), 80);
+  clientHelper.SetAttribute ("SegmentDuration", UintegerValue (segmentDuration));
+  clientHelper.SetAttribute ("SegmentSizeFilePath", StringValue (segmentSizeFilePath));
+  clientHelper.SetAttribute ("NumberOfClients", UintegerValue(numberOfClients));
+  clientHelper.SetAttribute ("SimulationId", UintegerValue (simulationId));
+  clientHelper.SetAttribute ("LogLevel", UintegerValue (logLevel));
+  if (multicast)
+  {
+    clientHelper.SetAttribute ("MulticastAddress", AddressValue (access.GetRouterAddress ()));
+    clientHelper.SetAttribute ("MulticastControlPort", UintegerValue (5000));
+    clientHelper.SetAttribute ("RepairTimeout", TimeValue (Seconds (repairTimeout)));
+  }
+  double segDuration = (segmentDuration/1000000);
+  double startTime = (segmentsBehindLive*segDuration)+(streamJoinOffset);
+  TcpStreamClientPopulation population;
+  population.AddAlgorithms (adaptationAlgo);
+  Ptr<UniformRandomVariable> jitter = 0;
+  if (startJitter > 0)
+  {
+    jitter = CreateObject<UniformRandomVariable> ();
+    jitter->SetAttribute ("Max", DoubleValue (startJitter));
+  }
+  population.SetStartTime (Seconds (startTime), jitter);
+  ApplicationContainer clientApps = clientHelper.Install (access.GetClients (), population);
+  Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::TcpStreamClient/MulticastRepair", MakeCallback (&LogRepair));
+
+  /* Aggregate the QoE of all clients into one summary */
+  Ptr<TcpStreamQoeAggregator> qoe = CreateObject<TcpStreamQoeAggregator> ();
+  qoe->Install (clientApps);
+
+  access.StartTraces (Seconds (0));
+
+  NS_LOG_INFO ("Run Simulation.");
+  NS_LOG_INFO ("Sim ID: " << simulationId << " Clients: " << numberOfClients << " Multicast: " << multicast);
+  Simulator::Stop (Seconds(stopTime));
+  Simulator::Run ();
+  qoe->Write (temp + "/" + "qoeSummary.txt");
+
+  // load of the server and of the link to the router, and what the groups saved
+  serverLoadMetrics load = DynamicCast<TcpStreamServer> (serverApp.Get (0))->GetLoadMetrics ();
+  uint64_t sourceBytes = 0;
+  uint64_t forwardedBytes = 0;
+  if (multicast)
+  {
+    sourceBytes = DynamicCast<TcpStreamMulticastSource> (sourceApp.Get (0))->GetBytesSent ();
+    forwardedBytes = DynamicCast<TcpStreamMulticastReplicator> (replicatorApp.Get (0))->GetBytesForwarded ();
+  }
+  std::ofstream multicastSummary;
+  std::string multicastSummaryFile = temp + "/" + "multicastSummary.txt";
+  multicastSummary.open (multicastSummaryFile.c_str ());
+  multicastSummary << "Multicast Server_Requests Peak_Active_Requests Repairs Repair_Bytes Source_Bytes Forwarded_Bytes\n"
+                   << multicast << " " << load.requests << " " << load.peakActiveRequests << " " << repairs << " " << repairBytes << " "
+                   << sourceBytes << " " << forwardedBytes << "\n";
+  multicastSummary.close ();
+  Simulator::Destroy ();
+  NS_LOG_INFO ("Done.");
+
+}
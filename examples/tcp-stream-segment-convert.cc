@@ -0,0 +1,70 @@
+/*
+  Converts a segment size file from the text format to the binary format, which the clients memory-map
+  instead of reading (see SegmentSizeMappedFile), and checks the result by mapping it again.
+*/
+
+#include "ns3/core-module.h"
+#include "ns3/tcp-stream-client.h"
+#include "ns3/tcp-stream-interface.h"
+#include "ns3/tcp-stream-segment-sizes.h"
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamSegmentConvert");
+
+int
+main (int argc, char *argv[])
+{
+  std::string inputPath;
+  std::string outputPath;
+
+  CommandLine cmd;
+  cmd.Usage ("Convert a segment size file to the binary, memory-mappable format.\n");
+  cmd.AddValue ("input", "The segment size file in text format", inputPath);
+  cmd.AddValue ("output", "The binary segment size file to write", outputPath);
+  cmd.Parse (argc, argv);
+
+  if (inputPath.empty () || outputPath.empty ())
+    {
+      std::cerr << "Both --input and --output are needed." << std::endl;
+      return 1;
+    }
+
+  videoData text;
+  text.segmentDuration = 0;
+  if (TcpStreamClient::ReadInBitrateValues (inputPath, text) == -1)
+    {
+      std::cerr << "Opening segment size file " << inputPath << " failed." << std::endl;
+      return 1;
+    }
+  if (!SegmentSizeMappedFile::Write (outputPath, text))
+    {
+      std::cerr << "Writing " << outputPath << " failed." << std::endl;
+      return 1;
+    }
+
+  // every size has to come back as it was read
+  videoData binary;
+  binary.segmentDuration = 0;
+  if (SegmentSizeMappedFile::Load (outputPath, binary) == -1)
+    {
+      std::cerr << "Mapping " << outputPath << " failed." << std::endl;
+      return 1;
+    }
+  int64_t segments = text.segmentSize.at (0).size ();
+  for (uint32_t r = 0; r < text.segmentSize.size (); r++)
+    {
+      for (int64_t i = 0; i < segments; i++)
+        {
+          if (binary.segmentSize.at (r).at (i) != text.segmentSize.at (r).at (i))
+            {
+              std::cerr << "Segment " << i << " of representation " << r << " differs after conversion." << std::endl;
+              return 1;
+            }
+        }
+    }
+  std::cout << outputPath << ": " << text.segmentSize.size () << " representations, " << segments << " segments"
+            << (text.segmentStart.empty () ? "" : ", with durations") << std::endl;
+  return 0;
+}
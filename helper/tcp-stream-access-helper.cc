@@ -0,0 +1,335 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "tcp-stream-access-helper.h"
+#include "ns3/log.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4.h"
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamAccessHelper");
+
+namespace {
+
+/**
+ * Route everything that is not directly connected over the given interface address of the peer.
+ */
+void
+SetDefaultRoute (Ptr<Node> node, Ipv4Address nextHop, Ptr<NetDevice> device)
+{
+  Ipv4StaticRoutingHelper staticRouting;
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  staticRouting.GetStaticRouting (ipv4)->SetDefaultRoute (nextHop, ipv4->GetInterfaceForDevice (device));
+}
+
+/**
+ * Route the network over the given interface address of the peer.
+ */
+void
+AddNetworkRoute (Ptr<Node> node, Ipv4Address network, Ipv4Mask mask, Ipv4Address nextHop, Ptr<NetDevice> device)
+{
+  Ipv4StaticRoutingHelper staticRouting;
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  staticRouting.GetStaticRouting (ipv4)->AddNetworkRouteTo (network, mask, nextHop, ipv4->GetInterfaceForDevice (device));
+}
+
+} // anonymous namespace
+
+TcpStreamAccessHelper::TcpStreamAccessHelper ()
+  : m_clientsPerLink (1),
+    m_numberOfServers (1),
+    m_assignment (roundRobin)
+{
+  m_backbone.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  m_backbone.SetChannelAttribute ("Delay", StringValue ("5ms"));
+  m_access.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  m_access.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  m_lan.SetChannelAttribute ("DataRate", StringValue ("100Mbps"));
+  m_lan.SetChannelAttribute ("Delay", TimeValue (NanoSeconds (6560)));
+  m_replayerFactory.SetTypeId (TraceReplayer::GetTypeId ());
+  m_rng = CreateObject<UniformRandomVariable> ();
+}
+
+void
+TcpStreamAccessHelper::SetBackboneDeviceAttribute (std::string name, const AttributeValue &value)
+{
+  m_backbone.SetDeviceAttribute (name, value);
+}
+
+void
+TcpStreamAccessHelper::SetBackboneChannelAttribute (std::string name, const AttributeValue &value)
+{
+  m_backbone.SetChannelAttribute (name, value);
+}
+
+void
+TcpStreamAccessHelper::SetAccessDeviceAttribute (std::string name, const AttributeValue &value)
+{
+  m_access.SetDeviceAttribute (name, value);
+}
+
+void
+TcpStreamAccessHelper::SetAccessChannelAttribute (std::string name, const AttributeValue &value)
+{
+  m_access.SetChannelAttribute (name, value);
+}
+
+void
+TcpStreamAccessHelper::SetReplayerAttribute (std::string name, const AttributeValue &value)
+{
+  m_replayerFactory.Set (name, value);
+}
+
+void
+TcpStreamAccessHelper::SetClientsPerLink (uint32_t clientsPerLink)
+{
+  NS_ASSERT_MSG (clientsPerLink > 0, "At least one client must be behind an access link");
+  m_clientsPerLink = clientsPerLink;
+}
+
+void
+TcpStreamAccessHelper::SetServers (uint32_t servers)
+{
+  NS_ASSERT_MSG (servers > 0, "At least one server is needed");
+  m_numberOfServers = servers;
+}
+
+void
+TcpStreamAccessHelper::SetTraceAssignment (traceAssignment assignment, int64_t seed)
+{
+  m_assignment = assignment;
+  m_rng->SetStream (seed);
+}
+
+void
+TcpStreamAccessHelper::AddTraceFile (std::string tracePath)
+{
+  m_traces.push_back (tracePath);
+}
+
+uint32_t
+TcpStreamAccessHelper::AddTraceDirectory (std::string directory)
+{
+  DIR *dir = opendir (directory.c_str ());
+  if (dir == NULL)
+    {
+      NS_LOG_ERROR ("Opening trace directory " << directory << " failed.");
+      return 0;
+    }
+  std::vector<std::string> files;
+  struct dirent *entry;
+  while ((entry = readdir (dir)) != NULL)
+    {
+      std::string name = entry->d_name;
+      if (name.empty () || name[0] == '.')
+        {
+          continue;
+        }
+      std::string path = directory + "/" + name;
+      struct stat info;
+      if (stat (path.c_str (), &info) == 0 && S_ISREG (info.st_mode))
+        {
+          files.push_back (path);
+        }
+    }
+  closedir (dir);
+  // readdir order is file system dependent, sort to keep the assignment reproducible
+  std::sort (files.begin (), files.end ());
+  m_traces.insert (m_traces.end (), files.begin (), files.end ());
+  return files.size ();
+}
+
+std::string
+TcpStreamAccessHelper::PickTrace (uint32_t link)
+{
+  if (m_traces.empty ())
+    {
+      return "";
+    }
+  if (m_assignment == random)
+    {
+      return m_traces.at (m_rng->GetInteger (0, m_traces.size () - 1));
+    }
+  return m_traces.at (link % m_traces.size ());
+}
+
+void
+TcpStreamAccessHelper::Install (uint32_t numberOfClients)
+{
+  NS_LOG_FUNCTION (this << numberOfClients);
+  m_servers.Create (m_numberOfServers);
+  m_router = CreateObject<Node> ();
+  m_clients.Create (numberOfClients);
+
+  InternetStackHelper stack;
+  stack.Install (m_servers);
+  stack.Install (m_router);
+  stack.Install (m_clients);
+
+  // Backbone links get consecutive /30 networks from 10.0.0.0/10.
+  Ipv4AddressHelper backboneAddress ("10.0.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < m_numberOfServers; i++)
+    {
+      NetDeviceContainer backboneDevices = m_backbone.Install (m_servers.Get (i), m_router);
+      Ipv4InterfaceContainer backboneInterfaces = backboneAddress.Assign (backboneDevices);
+      backboneAddress.NewNetwork ();
+      m_serverAddresses.push_back (backboneInterfaces.GetAddress (0));
+      if (i == 0)
+        {
+          m_routerAddress = backboneInterfaces.GetAddress (1);
+        }
+      m_backboneDevices.Add (backboneDevices.Get (0));
+      SetDefaultRoute (m_servers.Get (i), backboneInterfaces.GetAddress (1), backboneDevices.Get (0));
+    }
+
+  // Access links get /30 networks from 10.64.0.0/10, LANs behind shared links /24 networks from 10.128.0.0/9.
+  Ipv4AddressHelper accessAddress ("10.64.0.0", "255.255.255.252");
+  Ipv4AddressHelper lanAddress ("10.128.0.0", "255.255.255.0");
+
+  uint32_t links = (numberOfClients + m_clientsPerLink - 1) / m_clientsPerLink;
+  for (uint32_t link = 0; link < links; link++)
+    {
+      uint32_t first = link * m_clientsPerLink;
+      uint32_t last = std::min (first + m_clientsPerLink, numberOfClients);
+
+      Ptr<Node> edge;
+      if (m_clientsPerLink == 1)
+        {
+          edge = m_clients.Get (first);
+        }
+      else
+        {
+          edge = CreateObject<Node> ();
+          stack.Install (edge);
+        }
+
+      NetDeviceContainer accessDevices = m_access.Install (m_router, edge);
+      Ipv4InterfaceContainer accessInterfaces = accessAddress.Assign (accessDevices);
+      accessAddress.NewNetwork ();
+      SetDefaultRoute (edge, accessInterfaces.GetAddress (0), accessDevices.Get (1));
+      m_accessDevices.Add (accessDevices.Get (0));
+
+      if (m_clientsPerLink > 1)
+        {
+          NodeContainer lanNodes (edge);
+          for (uint32_t i = first; i < last; i++)
+            {
+              lanNodes.Add (m_clients.Get (i));
+            }
+          NetDeviceContainer lanDevices = m_lan.Install (lanNodes);
+          Ipv4InterfaceContainer lanInterfaces = lanAddress.Assign (lanDevices);
+          lanAddress.NewNetwork ();
+          for (uint32_t i = first; i < last; i++)
+            {
+              SetDefaultRoute (m_clients.Get (i), lanInterfaces.GetAddress (0), lanDevices.Get (i - first + 1));
+            }
+          // the router reaches the LAN over the edge at the other end of the access link
+          Ipv4Mask lanMask ("255.255.255.0");
+          AddNetworkRoute (m_router, lanInterfaces.GetAddress (0).CombineMask (lanMask), lanMask,
+                           accessInterfaces.GetAddress (1), accessDevices.Get (0));
+        }
+
+      // Shape the downstream direction, i.e. the router side of the access link.
+      std::string trace = PickTrace (link);
+      m_linkTraces.push_back (trace);
+      if (trace.empty ())
+        {
+          continue;
+        }
+      std::map<std::string, Ptr<TraceReplayer> >::iterator it = m_replayers.find (trace);
+      if (it == m_replayers.end ())
+        {
+          Ptr<TraceReplayer> replayer = m_replayerFactory.Create<TraceReplayer> ();
+          if (!replayer->SetTraceFile (trace))
+            {
+              NS_LOG_ERROR ("Opening trace file " << trace << " failed.");
+            }
+          it = m_replayers.insert (std::make_pair (trace, replayer)).first;
+        }
+      it->second->AddDevice (DynamicCast<PointToPointNetDevice> (accessDevices.Get (0)));
+    }
+}
+
+void
+TcpStreamAccessHelper::StartTraces (Time delay)
+{
+  for (std::map<std::string, Ptr<TraceReplayer> >::iterator it = m_replayers.begin (); it != m_replayers.end (); ++it)
+    {
+      it->second->Start (delay);
+    }
+}
+
+Ptr<Node>
+TcpStreamAccessHelper::GetServer (uint32_t server) const
+{
+  return m_servers.Get (server);
+}
+
+Ipv4Address
+TcpStreamAccessHelper::GetServerAddress (uint32_t server) const
+{
+  return m_serverAddresses.at (server);
+}
+
+NodeContainer
+TcpStreamAccessHelper::GetServers () const
+{
+  return m_servers;
+}
+
+NetDeviceContainer
+TcpStreamAccessHelper::GetBackboneDevices () const
+{
+  return m_backboneDevices;
+}
+
+NodeContainer
+TcpStreamAccessHelper::GetClients () const
+{
+  return m_clients;
+}
+
+Ptr<Node>
+TcpStreamAccessHelper::GetRouter () const
+{
+  return m_router;
+}
+
+Ipv4Address
+TcpStreamAccessHelper::GetRouterAddress () const
+{
+  return m_routerAddress;
+}
+
+NetDeviceContainer
+TcpStreamAccessHelper::GetAccessDevices () const
+{
+  return m_accessDevices;
+}
+
+std::string
+TcpStreamAccessHelper::GetClientTrace (uint32_t client) const
+{
+  return m_linkTraces.at (client / m_clientsPerLink);
+}
+
+} // namespace ns3
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TCP_STREAM_ACCESS_HELPER_H
+#define TCP_STREAM_ACCESS_HELPER_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/csma-helper.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/object-factory.h"
+#include "tcp-stream-trace-replayer.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Build a topology where every client (or group of clients) has its own shaped access link.
+ *
+ *   server ---backbone--- router ---access link 0--- client 0 (or group gateway 0 --csma-- clients)
+ *                                ---access link 1--- client 1
+ *                                ...
+ *
+ * With several servers, every server has a backbone link of its own to the router.
+ *
+ * Every access link is driven by a throughput trace, picked from the configured trace files either
+ * round-robin or randomly (reproducible for a given seed). All links that share a trace file are
+ * driven by a single TraceReplayer, so the number of scheduled rate changes and open files grows with
+ * the number of distinct traces, not with the number of links. Routing is set up with static default
+ * routes, which keeps Install linear in the number of clients.
+ */
+class TcpStreamAccessHelper
+{
+public:
+  /**
+   * \brief How trace files are assigned to access links.
+   */
+  enum traceAssignment
+  {
+    roundRobin, random
+  };
+
+  TcpStreamAccessHelper ();
+
+  /**
+   * Set an attribute of the point-to-point devices or the channel of the server-router links.
+   */
+  void SetBackboneDeviceAttribute (std::string name, const AttributeValue &value);
+  void SetBackboneChannelAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Set an attribute of the point-to-point devices or the channel of every access link.
+   */
+  void SetAccessDeviceAttribute (std::string name, const AttributeValue &value);
+  void SetAccessChannelAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Set an attribute of every TraceReplayer, e.g. Loop or TimeScale.
+   */
+  void SetReplayerAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * \param clientsPerLink the number of clients sharing one access link. With more than one client,
+   *        the access link ends at a gateway node that connects the clients over a CSMA LAN.
+   */
+  void SetClientsPerLink (uint32_t clientsPerLink);
+
+  /**
+   * \param servers the number of servers, each behind its own backbone link (1 by default)
+   */
+  void SetServers (uint32_t servers);
+
+  /**
+   * \param assignment how trace files are assigned to access links
+   * \param seed the random stream used for random assignment
+   */
+  void SetTraceAssignment (traceAssignment assignment, int64_t seed = 0);
+
+  /**
+   * \brief Add a trace file to the pool of traces assigned to access links.
+   */
+  void AddTraceFile (std::string tracePath);
+
+  /**
+   * \brief Add every regular file of a directory (sorted by name) to the pool of traces.
+   * \return the number of files added
+   */
+  uint32_t AddTraceDirectory (std::string directory);
+
+  /**
+   * \brief Create the servers, the router and numberOfClients clients with their access links.
+   *
+   * Installs the internet stack, assigns addresses and sets up routing. Links are shaped only
+   * if at least one trace file was added.
+   */
+  void Install (uint32_t numberOfClients);
+
+  /**
+   * \brief Start all trace replayers, trace time 0 corresponds to the given delay from now.
+   */
+  void StartTraces (Time delay);
+
+  Ptr<Node> GetServer (uint32_t server = 0) const;
+  Ipv4Address GetServerAddress (uint32_t server = 0) const;
+  NodeContainer GetServers () const;
+  NodeContainer GetClients () const;
+  Ptr<Node> GetRouter () const;
+
+  /**
+   * \return the router-side address of the backbone link of the first server
+   */
+  Ipv4Address GetRouterAddress () const;
+
+  /**
+   * \return the server-side devices of the backbone links, in server order
+   */
+  NetDeviceContainer GetBackboneDevices () const;
+
+  /**
+   * \return the router-side devices of the access links, in link order
+   */
+  NetDeviceContainer GetAccessDevices () const;
+
+  /**
+   * \return the trace file driving the access link of the given client, empty if unshaped
+   */
+  std::string GetClientTrace (uint32_t client) const;
+
+private:
+  std::string PickTrace (uint32_t link);
+
+  PointToPointHelper m_backbone; //!< Helper for the server-router links
+  PointToPointHelper m_access; //!< Helper for the access links
+  CsmaHelper m_lan; //!< Helper for the LANs behind shared access links
+  ObjectFactory m_replayerFactory; //!< Factory for the trace replayers
+  uint32_t m_clientsPerLink; //!< Number of clients behind one access link
+  uint32_t m_numberOfServers; //!< Number of servers
+  traceAssignment m_assignment; //!< How traces are assigned to access links
+  Ptr<UniformRandomVariable> m_rng; //!< Random stream for random trace assignment
+  std::vector<std::string> m_traces; //!< Pool of trace files
+
+  NodeContainer m_servers;
+  Ptr<Node> m_router;
+  Ipv4Address m_routerAddress; //!< Router-side address of the first backbone link
+  std::vector<Ipv4Address> m_serverAddresses; //!< Backbone address of every server
+  NetDeviceContainer m_backboneDevices; //!< Server-side devices of the backbone links
+  NodeContainer m_clients;
+  NetDeviceContainer m_accessDevices;
+  std::vector<std::string> m_linkTraces; //!< Trace file of every access link
+  std::map<std::string, Ptr<TraceReplayer> > m_replayers; //!< One replayer per distinct trace file
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_ACCESS_HELPER_H */
@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "tcp-stream-churn-generator.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamChurnGenerator");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpStreamChurnGenerator);
+
+TypeId
+TcpStreamChurnGenerator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpStreamChurnGenerator")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TcpStreamChurnGenerator> ()
+    .AddAttribute ("InterArrivalTime",
+                   "Random variable for the time between two arrivals, in seconds",
+                   StringValue ("ns3::ExponentialRandomVariable[Mean=1.0]"),
+                   MakePointerAccessor (&TcpStreamChurnGenerator::m_interArrival),
+                   MakePointerChecker<RandomVariableStream> ())
+    .AddAttribute ("SessionLength",
+                   "Random variable for the length of a session, in seconds",
+                   StringValue ("ns3::ExponentialRandomVariable[Mean=300.0]"),
+                   MakePointerAccessor (&TcpStreamChurnGenerator::m_sessionLength),
+                   MakePointerChecker<RandomVariableStream> ())
+    .AddAttribute ("LiveDelay",
+                   "Number of segments behind the newest segment a session starts at",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpStreamChurnGenerator::m_liveDelay),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("SessionStart",
+                     "A session started, with the id of its client",
+                     MakeTraceSourceAccessor (&TcpStreamChurnGenerator::m_sessionStartTrace),
+                     "ns3::TcpStreamChurnGenerator::SessionCallback")
+    .AddTraceSource ("SessionEnd",
+                     "A session ended, with the id of its client",
+                     MakeTraceSourceAccessor (&TcpStreamChurnGenerator::m_sessionEndTrace),
+                     "ns3::TcpStreamChurnGenerator::SessionCallback")
+  ;
+  return tid;
+}
+
+TcpStreamChurnGenerator::TcpStreamChurnGenerator ()
+  : m_liveDelay (1),
+    m_nextClientId (0),
+    m_blocked (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_clientFactory.SetTypeId (TcpStreamClient::GetTypeId ());
+}
+
+TcpStreamChurnGenerator::~TcpStreamChurnGenerator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpStreamChurnGenerator::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nextArrival.Cancel ();
+  for (uint32_t slot = 0; slot < m_departures.size (); slot++)
+    {
+      m_departures.at (slot).Cancel ();
+    }
+  m_clients.clear ();
+  m_slotOf.clear ();
+  m_interArrival = 0;
+  m_sessionLength = 0;
+  Object::DoDispose ();
+}
+
+void
+TcpStreamChurnGenerator::SetClientAttribute (std::string name, const AttributeValue &value)
+{
+  m_clientFactory.Set (name, value);
+}
+
+void
+TcpStreamChurnGenerator::SetPopulation (const TcpStreamClientPopulation &population)
+{
+  m_population = population;
+}
+
+void
+TcpStreamChurnGenerator::Install (NodeContainer nodes)
+{
+  NS_LOG_FUNCTION (this);
+  m_nodes = nodes;
+  m_clients.assign (nodes.GetN (), Ptr<TcpStreamClient> ());
+  m_departures.assign (nodes.GetN (), EventId ());
+  m_sessionIds.assign (nodes.GetN (), 0);
+  m_freeSlots.clear ();
+  // hand out low slots first
+  for (uint32_t slot = nodes.GetN (); slot > 0; slot--)
+    {
+      m_freeSlots.push_back (slot - 1);
+    }
+}
+
+void
+TcpStreamChurnGenerator::Start (Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  m_nextArrival.Cancel ();
+  m_nextArrival = Simulator::Schedule (delay, &TcpStreamChurnGenerator::Arrival, this);
+}
+
+void
+TcpStreamChurnGenerator::Stop ()
+{
+  NS_LOG_FUNCTION (this);
+  m_nextArrival.Cancel ();
+}
+
+uint32_t
+TcpStreamChurnGenerator::GetActiveSessions () const
+{
+  return m_nodes.GetN () - m_freeSlots.size ();
+}
+
+uint32_t
+TcpStreamChurnGenerator::GetStartedSessions () const
+{
+  return m_nextClientId;
+}
+
+uint64_t
+TcpStreamChurnGenerator::GetBlockedArrivals () const
+{
+  return m_blocked;
+}
+
+void
+TcpStreamChurnGenerator::ScheduleArrival ()
+{
+  m_nextArrival = Simulator::Schedule (Seconds (m_interArrival->GetValue ()), &TcpStreamChurnGenerator::Arrival, this);
+}
+
+void
+TcpStreamChurnGenerator::Arrival ()
+{
+  NS_LOG_FUNCTION (this);
+  ScheduleArrival ();
+  if (m_freeSlots.empty ())
+    {
+      m_blocked++;
+      NS_LOG_INFO ("Arrival blocked, all " << m_nodes.GetN () << " slots are busy");
+      return;
+    }
+  uint32_t slot = m_freeSlots.back ();
+  m_freeSlots.pop_back ();
+
+  Ptr<TcpStreamClient> client = m_clients.at (slot);
+  if (client == 0)
+    {
+      client = m_clientFactory.Create<TcpStreamClient> ();
+      client->SetSessionEndCallback (MakeCallback (&TcpStreamChurnGenerator::SessionEnded, this));
+      m_nodes.Get (slot)->AddApplication (client);
+      m_clients.at (slot) = client;
+      m_slotOf[client] = slot;
+    }
+
+  uint32_t clientId = m_nextClientId++;
+  m_sessionIds.at (slot) = clientId;
+  client->BeginSession (clientId, m_population.GetAlgorithm (clientId), m_liveDelay);
+  m_departures.at (slot) = Simulator::Schedule (Seconds (m_sessionLength->GetValue ()), &TcpStreamChurnGenerator::Departure, this, slot);
+  m_sessionStartTrace (clientId);
+}
+
+void
+TcpStreamChurnGenerator::Departure (uint32_t slot)
+{
+  NS_LOG_FUNCTION (this << slot);
+  m_clients.at (slot)->EndSession ();
+  ReleaseSlot (slot);
+}
+
+void
+TcpStreamChurnGenerator::SessionEnded (Ptr<TcpStreamClient> client)
+{
+  NS_LOG_FUNCTION (this << client);
+  uint32_t slot = m_slotOf[client];
+  m_departures.at (slot).Cancel ();
+  // the callback is the last action of the client, the session can be torn down right away
+  client->EndSession ();
+  ReleaseSlot (slot);
+}
+
+void
+TcpStreamChurnGenerator::ReleaseSlot (uint32_t slot)
+{
+  m_freeSlots.push_back (slot);
+  m_sessionEndTrace (m_sessionIds.at (slot));
+}
+
+} // namespace ns3
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TCP_STREAM_CHURN_GENERATOR_H
+#define TCP_STREAM_CHURN_GENERATOR_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/object-factory.h"
+#include "ns3/node-container.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
+#include "ns3/tcp-stream-client.h"
+#include "tcp-stream-helper.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Lets clients join and leave a live stream according to an arrival process and a session length distribution.
+ *
+ * The client nodes passed to Install are the slots of the audience: every slot runs at most one session at a
+ * time. A session starts with every arrival drawn from InterArrivalTime (exponential, i.e. Poisson arrivals,
+ * by default) on a free slot and ends after a duration drawn from SessionLength, or earlier if the end of the
+ * content was played. Arrivals finding no free slot are counted as blocked.
+ *
+ * The TcpStreamClient of a slot is created on its first session and reused afterwards (BeginSession /
+ * EndSession), so memory does not grow with the number of sessions. Every session gets a new client id,
+ * its algorithm is taken from the client population. The server should be installed with StopWhenIdle
+ * set to false, so that it survives periods without any client.
+ */
+class TcpStreamChurnGenerator : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Signature of the SessionStart and SessionEnd trace sources.
+   * \param clientId the id of the client of the session
+   */
+  typedef void (* SessionCallback)(uint32_t clientId);
+
+  TcpStreamChurnGenerator ();
+  virtual ~TcpStreamChurnGenerator ();
+
+  /**
+   * \brief Set an attribute of every client created, e.g. RemoteAddress or SegmentSizeFilePath.
+   */
+  void SetClientAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * \brief Set the algorithm pool sessions draw their algorithm from, start times are ignored.
+   */
+  void SetPopulation (const TcpStreamClientPopulation &population);
+
+  /**
+   * \brief Use the given nodes as slots for sessions.
+   */
+  void Install (NodeContainer nodes);
+
+  /**
+   * \brief Start generating arrivals after the given delay.
+   */
+  void Start (Time delay);
+
+  /**
+   * \brief Stop generating arrivals, running sessions continue until they end.
+   */
+  void Stop ();
+
+  uint32_t GetActiveSessions () const;
+  uint32_t GetStartedSessions () const;
+  uint64_t GetBlockedArrivals () const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  void Arrival ();
+  void ScheduleArrival ();
+
+  /**
+   * \brief The session length of the slot expired.
+   */
+  void Departure (uint32_t slot);
+
+  /**
+   * \brief The client of a slot played the end of the content.
+   */
+  void SessionEnded (Ptr<TcpStreamClient> client);
+
+  void ReleaseSlot (uint32_t slot);
+
+  ObjectFactory m_clientFactory; //!< Factory for the clients of the slots
+  TcpStreamClientPopulation m_population; //!< Algorithm pool of the sessions
+  Ptr<RandomVariableStream> m_interArrival; //!< Time between two arrivals in seconds
+  Ptr<RandomVariableStream> m_sessionLength; //!< Length of a session in seconds
+  uint32_t m_liveDelay; //!< Number of segments behind live a session starts at
+  NodeContainer m_nodes; //!< The slots
+  std::vector<Ptr<TcpStreamClient> > m_clients; //!< Client of every slot, null until the slot is first used
+  std::vector<EventId> m_departures; //!< Pending departure of every slot
+  std::vector<uint32_t> m_sessionIds; //!< Client id of the current or last session of every slot
+  std::vector<uint32_t> m_freeSlots; //!< Slots without a running session
+  std::map<Ptr<TcpStreamClient>, uint32_t> m_slotOf; //!< Slot of every client
+  EventId m_nextArrival; //!< The pending arrival
+  uint32_t m_nextClientId; //!< Id of the next session
+  uint64_t m_blocked; //!< Number of arrivals that found no free slot
+
+  TracedCallback<uint32_t> m_sessionStartTrace; //!< Trace of session starts, with the client id
+  TracedCallback<uint32_t> m_sessionEndTrace; //!< Trace of session ends, with the client id
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_CHURN_GENERATOR_H */
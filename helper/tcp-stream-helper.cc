@@ -20,8 +20,14 @@
 #include "tcp-stream-helper.h"
 #include "ns3/tcp-stream-server.h"
 #include "ns3/tcp-stream-client.h"
+#include "ns3/tcp-stream-edge-server.h"
+#include "ns3/tcp-stream-multicast.h"
 #include "ns3/uinteger.h"
 #include "ns3/names.h"
+#include "ns3/simulator.h"
+#include "ns3/assert.h"
+#include <cstdlib>
+#include <sstream>
 
 namespace ns3 {
 
@@ -42,6 +48,10 @@ TcpStreamServerHelper::SetAttribute (
 ApplicationContainer
 TcpStreamServerHelper::Install (Ptr<Node> node) const
 {
+  if (node->GetSystemId () != Simulator::GetSystemId ())
+    {
+      return ApplicationContainer ();
+    }
   return ApplicationContainer (InstallPriv (node));
 }
 
@@ -49,7 +59,7 @@ ApplicationContainer
 TcpStreamServerHelper::Install (std::string nodeName) const
 {
   Ptr<Node> node = Names::Find<Node> (nodeName);
-  return ApplicationContainer (InstallPriv (node));
+  return Install (node);
 }
 
 ApplicationContainer
@@ -58,6 +68,10 @@ TcpStreamServerHelper::Install (NodeContainer c) const
   ApplicationContainer apps;
   for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
     {
+      if ((*i)->GetSystemId () != Simulator::GetSystemId ())
+        {
+          continue;
+        }
       apps.Add (InstallPriv (*i));
     }
 
@@ -73,6 +87,193 @@ TcpStreamServerHelper::InstallPriv (Ptr<Node> node) const
   return app;
 }
 
+TcpStreamEdgeServerHelper::TcpStreamEdgeServerHelper (Address origin, uint16_t originPort, uint16_t port)
+{
+  m_factory.SetTypeId (TcpStreamEdgeServer::GetTypeId ());
+  SetAttribute ("OriginAddress", AddressValue (origin));
+  SetAttribute ("OriginPort", UintegerValue (originPort));
+  SetAttribute ("Port", UintegerValue (port));
+}
+
+void
+TcpStreamEdgeServerHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+TcpStreamEdgeServerHelper::Install (Ptr<Node> node) const
+{
+  if (node->GetSystemId () != Simulator::GetSystemId ())
+    {
+      return ApplicationContainer ();
+    }
+  Ptr<Application> app = m_factory.Create<TcpStreamEdgeServer> ();
+  node->AddApplication (app);
+  return ApplicationContainer (app);
+}
+
+ApplicationContainer
+TcpStreamEdgeServerHelper::Install (NodeContainer c) const
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      apps.Add (Install (*i));
+    }
+  return apps;
+}
+
+TcpStreamMulticastSourceHelper::TcpStreamMulticastSourceHelper (Address replicator, uint16_t port)
+{
+  m_factory.SetTypeId (TcpStreamMulticastSource::GetTypeId ());
+  SetAttribute ("RemoteAddress", AddressValue (replicator));
+  SetAttribute ("RemotePort", UintegerValue (port));
+}
+
+void
+TcpStreamMulticastSourceHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+TcpStreamMulticastSourceHelper::Install (Ptr<Node> node) const
+{
+  if (node->GetSystemId () != Simulator::GetSystemId ())
+    {
+      return ApplicationContainer ();
+    }
+  Ptr<Application> app = m_factory.Create<TcpStreamMulticastSource> ();
+  node->AddApplication (app);
+  return ApplicationContainer (app);
+}
+
+TcpStreamMulticastReplicatorHelper::TcpStreamMulticastReplicatorHelper (uint16_t port, uint16_t controlPort)
+{
+  m_factory.SetTypeId (TcpStreamMulticastReplicator::GetTypeId ());
+  SetAttribute ("Port", UintegerValue (port));
+  SetAttribute ("ControlPort", UintegerValue (controlPort));
+}
+
+void
+TcpStreamMulticastReplicatorHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+ApplicationContainer
+TcpStreamMulticastReplicatorHelper::Install (Ptr<Node> node) const
+{
+  if (node->GetSystemId () != Simulator::GetSystemId ())
+    {
+      return ApplicationContainer ();
+    }
+  Ptr<Application> app = m_factory.Create<TcpStreamMulticastReplicator> ();
+  node->AddApplication (app);
+  return ApplicationContainer (app);
+}
+
+const uint32_t TcpStreamClientPopulation::maxWeight;
+
+TcpStreamClientPopulation::TcpStreamClientPopulation ()
+  : m_start (Seconds (0))
+{
+}
+
+void
+TcpStreamClientPopulation::AddAlgorithm (std::string algorithm, uint32_t weight)
+{
+  // the schedule has one entry per unit of weight
+  if (weight == 0 || weight > maxWeight)
+    {
+      NS_FATAL_ERROR ("The weight of algorithm " << algorithm << " must be between 1 and " << maxWeight
+                      << ", not " << weight << ". Terminating.");
+    }
+  m_algorithms.push_back (algorithm);
+  m_weights.push_back (weight);
+
+  // Smooth weighted round robin: spreads every algorithm evenly over one period of the schedule
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < m_weights.size (); i++)
+    {
+      total += m_weights.at (i);
+    }
+  std::vector<int64_t> current (m_weights.size (), 0);
+  m_schedule.clear ();
+  for (uint64_t slot = 0; slot < total; slot++)
+    {
+      uint32_t best = 0;
+      for (uint32_t i = 0; i < m_weights.size (); i++)
+        {
+          current.at (i) += m_weights.at (i);
+          if (current.at (i) > current.at (best))
+            {
+              best = i;
+            }
+        }
+      current.at (best) -= total;
+      m_schedule.push_back (best);
+    }
+}
+
+void
+TcpStreamClientPopulation::AddAlgorithms (std::string spec)
+{
+  std::istringstream entries (spec);
+  std::string entry;
+  while (std::getline (entries, entry, ','))
+    {
+      if (entry.empty ())
+        {
+          continue;
+        }
+      uint32_t weight = 1;
+      std::string::size_type colon = entry.find (':');
+      if (colon != std::string::npos)
+        {
+          std::string value = entry.substr (colon + 1);
+          char *end = NULL;
+          long parsed = std::strtol (value.c_str (), &end, 10);
+          if (value.empty () || *end != '\0' || parsed <= 0 || parsed > (long) maxWeight)
+            {
+              NS_FATAL_ERROR ("Invalid weight \"" << value << "\" in the algorithm list " << spec
+                              << ", it has to be a number between 1 and " << maxWeight << ". Terminating.");
+            }
+          weight = parsed;
+          entry = entry.substr (0, colon);
+        }
+      AddAlgorithm (entry, weight);
+    }
+}
+
+void
+TcpStreamClientPopulation::SetStartTime (Time start, Ptr<RandomVariableStream> jitter)
+{
+  m_start = start;
+  m_jitter = jitter;
+}
+
+const std::string &
+TcpStreamClientPopulation::GetAlgorithm (uint32_t clientId) const
+{
+  if (m_schedule.empty ())
+    {
+      NS_FATAL_ERROR ("No algorithm added to the client population. Terminating.");
+    }
+  return m_algorithms.at (m_schedule.at (clientId % m_schedule.size ()));
+}
+
+Time
+TcpStreamClientPopulation::GetStartTime () const
+{
+  if (m_jitter == 0)
+    {
+      return m_start;
+    }
+  return m_start + Seconds (m_jitter->GetValue ());
+}
+
 TcpStreamClientHelper::TcpStreamClientHelper (Address address, uint16_t port)
 {
   m_factory.SetTypeId (TcpStreamClient::GetTypeId ());
@@ -101,22 +302,61 @@ TcpStreamClientHelper::SetAttribute (std::string name, const AttributeValue &val
 }
 
 ApplicationContainer
-TcpStreamClientHelper::Install (std::vector <std::pair <Ptr<Node>, std::string> > clients) const
+TcpStreamClientHelper::Install (const std::vector <std::pair <Ptr<Node>, std::string> > &clients) const
 {
   ApplicationContainer apps;
   for (uint i = 0; i < clients.size (); i++)
     {
+      // In a distributed simulation, only the rank owning the node runs its client
+      if (clients.at (i).first->GetSystemId () != Simulator::GetSystemId ())
+        {
+          continue;
+        }
       apps.Add (InstallPriv (clients.at (i).first, clients.at (i).second, i));
     }
 
   return apps;
 }
 
+void
+TcpStreamClientHelper::AddServer (Address ip, uint16_t port, double weight)
+{
+  serverEntry server;
+  server.address = ip;
+  server.port = port;
+  server.weight = weight;
+  m_servers.push_back (server);
+}
+
+ApplicationContainer
+TcpStreamClientHelper::Install (const NodeContainer &nodes, const TcpStreamClientPopulation &population, uint32_t firstClientId) const
+{
+  ApplicationContainer apps;
+  uint32_t clientId = firstClientId;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i, clientId++)
+    {
+      Time start = population.GetStartTime ();
+      if ((*i)->GetSystemId () != Simulator::GetSystemId ())
+        {
+          continue;
+        }
+      Ptr<Application> app = InstallPriv (*i, population.GetAlgorithm (clientId), clientId);
+      app->SetStartTime (start);
+      apps.Add (app);
+    }
+
+  return apps;
+}
+
 Ptr<Application>
-TcpStreamClientHelper::InstallPriv (Ptr<Node> node, std::string algo, uint16_t clientId) const
+TcpStreamClientHelper::InstallPriv (Ptr<Node> node, const std::string &algo, uint32_t clientId) const
 {
   Ptr<Application> app = m_factory.Create<TcpStreamClient> ();
   app->GetObject<TcpStreamClient> ()->SetAttribute ("ClientId", UintegerValue (clientId));
+  for (uint32_t i = 0; i < m_servers.size (); i++)
+    {
+      app->GetObject<TcpStreamClient> ()->AddServer (m_servers.at (i).address, m_servers.at (i).port, m_servers.at (i).weight);
+    }
   app->GetObject<TcpStreamClient> ()->Initialise (algo, clientId);
   node->AddApplication (app);
   return app;
@@ -26,6 +26,10 @@
 #include "ns3/object-factory.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include <string>
+#include <vector>
 
 namespace ns3 {
 
@@ -59,7 +63,8 @@ public:
    * \param node The node on which to create the Application.  The node is
    *             specified by a Ptr<Node>.
    *
-   * \returns An ApplicationContainer holding the Application created,
+   * \returns An ApplicationContainer holding the Application created, empty if the node
+   *          belongs to another rank of a distributed simulation
    */
   ApplicationContainer Install (Ptr<Node> node) const;
 
@@ -99,6 +104,165 @@ private:
   ObjectFactory m_factory; //!< Object factory.
 };
 
+/**
+ * \ingroup TcpStream
+ * \brief Create edge cache servers relaying the requests of clients to an origin TcpStreamServer.
+ */
+class TcpStreamEdgeServerHelper
+{
+public:
+  /**
+   * \param origin The address of the origin server
+   * \param originPort The port of the origin server
+   * \param port The port the edge server waits on for clients
+   */
+  TcpStreamEdgeServerHelper (Address origin, uint16_t originPort, uint16_t port);
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Create a TcpStreamEdgeServer on the specified Node.
+   *
+   * \returns An ApplicationContainer holding the Application created, empty if the node
+   *          belongs to another rank of a distributed simulation
+   */
+  ApplicationContainer Install (Ptr<Node> node) const;
+
+  /**
+   * Create one edge server on each of the Nodes in the NodeContainer.
+   *
+   * \returns The applications created, one Application per Node of this rank.
+   */
+  ApplicationContainer Install (NodeContainer c) const;
+
+private:
+  ObjectFactory m_factory; //!< Object factory.
+};
+
+/**
+ * \ingroup TcpStream
+ * \brief Create live sources multicasting every representation to a TcpStreamMulticastReplicator.
+ */
+class TcpStreamMulticastSourceHelper
+{
+public:
+  /**
+   * \param replicator The address of the replicator
+   * \param port The data port of the replicator
+   */
+  TcpStreamMulticastSourceHelper (Address replicator, uint16_t port);
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Create a TcpStreamMulticastSource on the specified Node.
+   *
+   * \returns An ApplicationContainer holding the Application created, empty if the node
+   *          belongs to another rank of a distributed simulation
+   */
+  ApplicationContainer Install (Ptr<Node> node) const;
+
+private:
+  ObjectFactory m_factory; //!< Object factory.
+};
+
+/**
+ * \ingroup TcpStream
+ * \brief Create the replication points of the multicast groups, usually on the router of the clients.
+ */
+class TcpStreamMulticastReplicatorHelper
+{
+public:
+  /**
+   * \param port The port the source sends to
+   * \param controlPort The port clients join and leave groups on
+   */
+  TcpStreamMulticastReplicatorHelper (uint16_t port, uint16_t controlPort);
+
+  /**
+   * Record an attribute to be set in each Application after it is is created.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   */
+  void SetAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * Create a TcpStreamMulticastReplicator on the specified Node.
+   *
+   * \returns An ApplicationContainer holding the Application created, empty if the node
+   *          belongs to another rank of a distributed simulation
+   */
+  ApplicationContainer Install (Ptr<Node> node) const;
+
+private:
+  ObjectFactory m_factory; //!< Object factory.
+};
+
+/**
+ * \ingroup TcpStream
+ * \brief Compact description of a client population: a weighted pool of adaptation algorithms
+ *        and the distribution of the start times.
+ *
+ * Algorithms are assigned by smooth weighted round robin over the client ids, so every window of
+ * (sum of weights) consecutive clients contains each algorithm exactly weight times, independent of
+ * random streams. Each algorithm name is stored once, however large the population.
+ */
+class TcpStreamClientPopulation
+{
+public:
+  static const uint32_t maxWeight = 1000; //!< Largest weight of an algorithm, the schedule grows with the sum of the weights
+
+  TcpStreamClientPopulation ();
+
+  /**
+   * \brief Add an algorithm to the pool.
+   * \param algorithm the name of the adaptation algorithm
+   * \param weight the share of clients using it, relative to the other algorithms of the pool, 1 to maxWeight
+   */
+  void AddAlgorithm (std::string algorithm, uint32_t weight = 1);
+
+  /**
+   * \brief Add algorithms given as comma separated list with optional weights, e.g. "bola:3,festive:1".
+   */
+  void AddAlgorithms (std::string spec);
+
+  /**
+   * \param start the start time of every client
+   * \param jitter optional random variable, in seconds, added to the start time of every client
+   */
+  void SetStartTime (Time start, Ptr<RandomVariableStream> jitter = 0);
+
+  /**
+   * \return the name of the algorithm assigned to the given client
+   */
+  const std::string & GetAlgorithm (uint32_t clientId) const;
+
+  /**
+   * \return the start time for the next client, drawing from the jitter variable
+   */
+  Time GetStartTime () const;
+
+private:
+  std::vector<std::string> m_algorithms; //!< The pool of algorithm names
+  std::vector<uint32_t> m_weights; //!< The weight of every algorithm of the pool
+  std::vector<uint32_t> m_schedule; //!< Algorithm index for every client of one round robin period
+  Time m_start; //!< The start time of every client
+  Ptr<RandomVariableStream> m_jitter; //!< Random offset of the start time in seconds, may be null
+};
+
 /**
  * \ingroup TcpStream
  * \brief Create an application which sends a UDP packet and waits for an echo of this packet
@@ -139,16 +303,40 @@ public:
    */
   void SetAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * Add a server every client chooses from, see TcpStreamClient::AddServer. Once servers are added,
+   * the address and port given to the constructor are ignored.
+   *
+   * \param ip The address of the server
+   * \param port The port of the server
+   * \param weight The share of the requests sent to the server with weighted server selection
+   */
+  void AddServer (Address ip, uint16_t port, double weight = 1);
+
   /**
    * \param clients the nodes with the name of the adaptation algorithm to be used
    *
    * Create one tcp stream client application on each of the input nodes and
    * instantiate an adaptation algorithm on each of the tcp stream client according
-   * to the given string.
+   * to the given string. The client id is the position in the vector. In a distributed
+   * simulation, nodes owned by other ranks are skipped, so ids stay globally unique.
+   *
+   * \returns the applications created, one application per local input node.
+   */
+  ApplicationContainer Install (const std::vector <std::pair <Ptr<Node>, std::string> > &clients) const;
+
+  /**
+   * \param nodes the client nodes, the client id is firstClientId plus the position in the container
+   * \param population the algorithm pool and start times of the clients
+   * \param firstClientId the id of the first client, to install several populations in one simulation
+   *
+   * Create one tcp stream client application on each node and set its start time. Start times are
+   * drawn for all nodes, including those skipped in a distributed simulation, so they do not depend
+   * on the partitioning.
    *
-   * \returns the applications created, one application per input node.
+   * \returns the applications created, one application per local node.
    */
-  ApplicationContainer Install (std::vector <std::pair <Ptr<Node>, std::string> > clients) const;
+  ApplicationContainer Install (const NodeContainer &nodes, const TcpStreamClientPopulation &population, uint32_t firstClientId = 0) const;
 
 private:
   /**
@@ -161,8 +349,19 @@ private:
    * \param simulationId distinguish this simulation from other subsequently started simulations, for logging purposes
    * \returns Ptr to the application installed.
    */
-  Ptr<Application> InstallPriv (Ptr<Node> node, std::string algo, uint16_t clientId) const;
+  Ptr<Application> InstallPriv (Ptr<Node> node, const std::string &algo, uint32_t clientId) const;
   ObjectFactory m_factory; //!< Object factory.
+
+  /**
+   * \brief A server added with AddServer.
+   */
+  struct serverEntry
+  {
+    Address address; //!< Address of the server
+    uint16_t port; //!< Port of the server
+    double weight; //!< Weight of the server
+  };
+  std::vector<serverEntry> m_servers; //!< Servers of every client, empty for the single remote server
 };
 
 } // namespace ns3
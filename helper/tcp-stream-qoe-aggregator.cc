@@ -0,0 +1,442 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "tcp-stream-qoe-aggregator.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamQoeAggregator");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpStreamQoeAggregator);
+
+P2Quantile::P2Quantile (double p)
+  : m_p (p),
+    m_count (0)
+{
+  for (int i = 0; i < 5; i++)
+    {
+      m_height[i] = 0;
+      m_position[i] = i;
+    }
+  m_desired[0] = 0;
+  m_desired[1] = 2 * p;
+  m_desired[2] = 4 * p;
+  m_desired[3] = 2 + 2 * p;
+  m_desired[4] = 4;
+  m_increment[0] = 0;
+  m_increment[1] = p / 2;
+  m_increment[2] = p;
+  m_increment[3] = (1 + p) / 2;
+  m_increment[4] = 1;
+}
+
+void
+P2Quantile::Add (double x)
+{
+  if (m_count < 5)
+    {
+      // collect the first five values as initial marker heights
+      m_height[m_count++] = x;
+      std::sort (m_height, m_height + m_count);
+      return;
+    }
+  m_count++;
+
+  int k;
+  if (x < m_height[0])
+    {
+      m_height[0] = x;
+      k = 0;
+    }
+  else if (x >= m_height[4])
+    {
+      m_height[4] = std::max (m_height[4], x);
+      k = 3;
+    }
+  else
+    {
+      k = 0;
+      while (x >= m_height[k + 1])
+        {
+          k++;
+        }
+    }
+  for (int i = k + 1; i < 5; i++)
+    {
+      m_position[i]++;
+    }
+  for (int i = 0; i < 5; i++)
+    {
+      m_desired[i] += m_increment[i];
+    }
+
+  // move the inner markers towards their desired positions
+  for (int i = 1; i < 4; i++)
+    {
+      double d = m_desired[i] - m_position[i];
+      if ((d >= 1 && m_position[i + 1] - m_position[i] > 1) || (d <= -1 && m_position[i - 1] - m_position[i] < -1))
+        {
+          int sign = d > 0 ? 1 : -1;
+          double height = Parabolic (i, sign);
+          if (m_height[i - 1] < height && height < m_height[i + 1])
+            {
+              m_height[i] = height;
+            }
+          else
+            {
+              m_height[i] = Linear (i, sign);
+            }
+          m_position[i] += sign;
+        }
+    }
+}
+
+double
+P2Quantile::Parabolic (int i, int d) const
+{
+  return m_height[i] + d / (m_position[i + 1] - m_position[i - 1])
+         * ((m_position[i] - m_position[i - 1] + d) * (m_height[i + 1] - m_height[i]) / (m_position[i + 1] - m_position[i])
+            + (m_position[i + 1] - m_position[i] - d) * (m_height[i] - m_height[i - 1]) / (m_position[i] - m_position[i - 1]));
+}
+
+double
+P2Quantile::Linear (int i, int d) const
+{
+  return m_height[i] + d * (m_height[i + d] - m_height[i]) / (m_position[i + d] - m_position[i]);
+}
+
+double
+P2Quantile::Get () const
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  if (m_count < 5)
+    {
+      // nearest rank of the sorted values
+      uint64_t rank = (uint64_t) std::ceil (m_p * m_count);
+      return m_height[rank > 0 ? rank - 1 : 0];
+    }
+  return m_height[2];
+}
+
+QoeStatistic::QoeStatistic ()
+  : m_count (0),
+    m_mean (0),
+    m_m2 (0),
+    m_min (0),
+    m_max (0)
+{
+  for (uint32_t i = 0; i < GetQuantiles ().size (); i++)
+    {
+      m_quantiles.push_back (P2Quantile (GetQuantiles ().at (i)));
+    }
+}
+
+const std::vector<double> &
+QoeStatistic::GetQuantiles ()
+{
+  static const double quantiles[] = {0.05, 0.25, 0.5, 0.75, 0.95};
+  static const std::vector<double> list (quantiles, quantiles + 5);
+  return list;
+}
+
+void
+QoeStatistic::Add (double x)
+{
+  if (m_count == 0)
+    {
+      m_min = x;
+      m_max = x;
+    }
+  m_min = std::min (m_min, x);
+  m_max = std::max (m_max, x);
+  // Welford's update, numerically stable for long runs
+  m_count++;
+  double delta = x - m_mean;
+  m_mean += delta / m_count;
+  m_m2 += delta * (x - m_mean);
+  for (uint32_t i = 0; i < m_quantiles.size (); i++)
+    {
+      m_quantiles.at (i).Add (x);
+    }
+}
+
+uint64_t
+QoeStatistic::GetCount () const
+{
+  return m_count;
+}
+
+double
+QoeStatistic::GetMean () const
+{
+  return m_mean;
+}
+
+double
+QoeStatistic::GetStdDev () const
+{
+  return m_count > 0 ? std::sqrt (m_m2 / m_count) : 0;
+}
+
+double
+QoeStatistic::GetMin () const
+{
+  return m_min;
+}
+
+double
+QoeStatistic::GetMax () const
+{
+  return m_max;
+}
+
+double
+QoeStatistic::GetMeanSquare () const
+{
+  return m_count > 0 ? m_mean * m_mean + m_m2 / m_count : 0;
+}
+
+double
+QoeStatistic::GetQuantile (uint32_t i) const
+{
+  return m_quantiles.at (i).Get ();
+}
+
+TcpStreamQoeAggregator::clientQoe::clientQoe ()
+  : segmentDuration (0),
+    bytes (0),
+    segments (0),
+    downloadTime (0),
+    playedSegments (0),
+    lastRep (-1),
+    switches (0),
+    stalls (0),
+    stallTime (0),
+    stalled (false),
+    stallStart (0),
+    finished (false)
+{
+}
+
+TypeId
+TcpStreamQoeAggregator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpStreamQoeAggregator")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TcpStreamQoeAggregator> ()
+  ;
+  return tid;
+}
+
+TcpStreamQoeAggregator::TcpStreamQoeAggregator ()
+  : m_stalls (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpStreamQoeAggregator::~TcpStreamQoeAggregator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpStreamQoeAggregator::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_apps.clear ();
+  Object::DoDispose ();
+}
+
+void
+TcpStreamQoeAggregator::Install (ApplicationContainer apps)
+{
+  for (ApplicationContainer::Iterator i = apps.Begin (); i != apps.End (); ++i)
+    {
+      Ptr<TcpStreamClient> client = DynamicCast<TcpStreamClient> (*i);
+      if (client != 0)
+        {
+          Add (client);
+        }
+    }
+}
+
+void
+TcpStreamQoeAggregator::Add (Ptr<TcpStreamClient> client)
+{
+  NS_LOG_FUNCTION (this << client);
+  UintegerValue clientId;
+  client->GetAttribute ("ClientId", clientId);
+  UintegerValue segmentDuration;
+  client->GetAttribute ("SegmentDuration", segmentDuration);
+  m_clients[clientId.Get ()].segmentDuration = segmentDuration.Get ();
+  m_apps.push_back (client);
+
+  client->TraceConnectWithoutContext ("Representation", MakeCallback (&TcpStreamQoeAggregator::Representation, this));
+  client->TraceConnectWithoutContext ("DownloadEnd", MakeCallback (&TcpStreamQoeAggregator::DownloadEnd, this));
+  client->TraceConnectWithoutContext ("StallStart", MakeCallback (&TcpStreamQoeAggregator::StallStart, this));
+  client->TraceConnectWithoutContext ("StallEnd", MakeCallback (&TcpStreamQoeAggregator::StallEnd, this));
+  client->TraceConnectWithoutContext ("LiveLatency", MakeCallback (&TcpStreamQoeAggregator::LiveLatency, this));
+}
+
+void
+TcpStreamQoeAggregator::Representation (uint32_t clientId, int64_t segmentIndex, int64_t repIndex)
+{
+  clientQoe &client = m_clients[clientId];
+  if (client.lastRep >= 0 && repIndex != client.lastRep)
+    {
+      client.switches++;
+    }
+  client.lastRep = repIndex;
+}
+
+void
+TcpStreamQoeAggregator::DownloadEnd (uint32_t clientId, int64_t segmentIndex, int64_t repIndex, int64_t bytes, Time duration)
+{
+  clientQoe &client = m_clients[clientId];
+  client.bytes += bytes;
+  client.segments++;
+  client.downloadTime += duration.GetMicroSeconds ();
+}
+
+void
+TcpStreamQoeAggregator::StallStart (uint32_t clientId, int64_t segmentIndex)
+{
+  clientQoe &client = m_clients[clientId];
+  client.stalled = true;
+  client.stallStart = Simulator::Now ().GetMicroSeconds ();
+  client.stalls++;
+  m_stalls++;
+}
+
+void
+TcpStreamQoeAggregator::StallEnd (uint32_t clientId, Time duration)
+{
+  clientQoe &client = m_clients[clientId];
+  client.stalled = false;
+  client.stallTime += duration.GetMicroSeconds ();
+}
+
+void
+TcpStreamQoeAggregator::LiveLatency (uint32_t clientId, int64_t segmentIndex, Time latency)
+{
+  m_clients[clientId].playedSegments++;
+  m_latency.Add (latency.GetSeconds ());
+}
+
+void
+TcpStreamQoeAggregator::Finish (clientQoe &client)
+{
+  if (client.finished || client.segments == 0)
+    {
+      return;
+    }
+  client.finished = true;
+  if (client.stalled)
+    {
+      client.stallTime += Simulator::Now ().GetMicroSeconds () - client.stallStart;
+    }
+  m_bitrate.Add (client.bytes * 8 / (double) (client.segments * client.segmentDuration) * 1000);
+  if (client.downloadTime > 0)
+    {
+      m_throughput.Add (client.bytes * 8 / (double) client.downloadTime * 1000);
+    }
+  double played = client.playedSegments * client.segmentDuration;
+  if (played > 0)
+    {
+      m_stallRatio.Add (client.stallTime / played);
+      m_switchFrequency.Add (client.switches / (played / 60000000));
+    }
+}
+
+double
+TcpStreamQoeAggregator::GetThroughputFairness () const
+{
+  // (sum x)^2 / (n * sum x^2) = mean^2 / mean of the squares
+  double meanSquare = m_throughput.GetMeanSquare ();
+  if (meanSquare == 0)
+    {
+      return 1;
+    }
+  return m_throughput.GetMean () * m_throughput.GetMean () / meanSquare;
+}
+
+bool
+TcpStreamQoeAggregator::Write (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  for (std::map<uint32_t, clientQoe>::iterator it = m_clients.begin (); it != m_clients.end (); ++it)
+    {
+      Finish (it->second);
+    }
+
+  std::ofstream out (fileName.c_str ());
+  if (!out)
+    {
+      return false;
+    }
+  out << "Clients " << m_bitrate.GetCount () << "\n";
+  out << "Stalls " << m_stalls << "\n";
+  out << "Jain_Fairness_Throughput " << GetThroughputFairness () << "\n";
+  out << "Metric Count Mean SD Min";
+  for (uint32_t i = 0; i < QoeStatistic::GetQuantiles ().size (); i++)
+    {
+      out << " P" << QoeStatistic::GetQuantiles ().at (i) * 100;
+    }
+  out << " Max\n";
+
+  const char *names[] = {"Bitrate_kbps", "Throughput_kbps", "Stall_Ratio", "Switches_Per_Minute", "Live_Latency_s"};
+  const QoeStatistic *statistics[] = {&m_bitrate, &m_throughput, &m_stallRatio, &m_switchFrequency, &m_latency};
+  for (uint32_t m = 0; m < 5; m++)
+    {
+      const QoeStatistic &statistic = *statistics[m];
+      out << names[m] << " " << statistic.GetCount () << " " << statistic.GetMean () << " " << statistic.GetStdDev () << " " << statistic.GetMin ();
+      for (uint32_t i = 0; i < QoeStatistic::GetQuantiles ().size (); i++)
+        {
+          out << " " << statistic.GetQuantile (i);
+        }
+      out << " " << statistic.GetMax () << "\n";
+    }
+  return true;
+}
+
+bool
+TcpStreamQoeAggregator::WriteHistograms (std::string fileName) const
+{
+  NS_LOG_FUNCTION (this << fileName);
+  streamHistograms merged;
+  for (uint32_t i = 0; i < m_apps.size (); i++)
+    {
+      merged.Merge (m_apps.at (i)->GetHistograms ());
+    }
+  std::ofstream out (fileName.c_str ());
+  if (!out)
+    {
+      return false;
+    }
+  merged.Write (out);
+  return true;
+}
+
+} // namespace ns3
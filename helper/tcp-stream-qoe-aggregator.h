@@ -0,0 +1,204 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TCP_STREAM_QOE_AGGREGATOR_H
+#define TCP_STREAM_QOE_AGGREGATOR_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/application-container.h"
+#include "ns3/tcp-stream-client.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Estimates a quantile of a stream of values with the P-square algorithm (Jain and Chlamtac, 1985).
+ *
+ * Only five markers are kept, independent of the number of values added.
+ */
+class P2Quantile
+{
+public:
+  /**
+   * \param p the quantile to estimate, between 0 and 1
+   */
+  P2Quantile (double p);
+
+  void Add (double x);
+
+  /**
+   * \return the estimate, exact as long as less than five values were added, 0 without values
+   */
+  double Get () const;
+
+private:
+  double Parabolic (int i, int d) const;
+  double Linear (int i, int d) const;
+
+  double m_p; //!< The quantile
+  uint64_t m_count; //!< Number of values added
+  double m_height[5]; //!< Marker heights
+  double m_position[5]; //!< Actual marker positions
+  double m_desired[5]; //!< Desired marker positions
+  double m_increment[5]; //!< Increments of the desired marker positions per value
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Mean, standard deviation, extremes and quantiles of a stream of values in constant memory.
+ */
+class QoeStatistic
+{
+public:
+  QoeStatistic ();
+
+  void Add (double x);
+
+  uint64_t GetCount () const;
+  double GetMean () const;
+  /**
+   * \return the population standard deviation
+   */
+  double GetStdDev () const;
+  double GetMin () const;
+  double GetMax () const;
+  /**
+   * \return the mean of the squared values
+   */
+  double GetMeanSquare () const;
+  /**
+   * \param i index into GetQuantiles ()
+   */
+  double GetQuantile (uint32_t i) const;
+
+  /**
+   * \return the estimated quantiles: 0.05, 0.25, 0.5, 0.75 and 0.95
+   */
+  static const std::vector<double> & GetQuantiles ();
+
+private:
+  uint64_t m_count; //!< Number of values
+  double m_mean; //!< Running mean
+  double m_m2; //!< Running sum of squared deviations from the mean
+  double m_min; //!< Smallest value
+  double m_max; //!< Largest value
+  std::vector<P2Quantile> m_quantiles; //!< One estimator per quantile
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Aggregates the QoE of all clients of a simulation online, from the client trace sources.
+ *
+ * Per client, only a few counters are kept while the simulation runs, no samples are stored. When the summary is
+ * written, the average bitrate, throughput, stall ratio and switch frequency of every client are added to
+ * population wide statistics, live latency samples are added as they occur. The summary contains mean, standard
+ * deviation and percentiles of these metrics and Jain's fairness index of the average throughput of the clients.
+ */
+class TcpStreamQoeAggregator : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpStreamQoeAggregator ();
+  virtual ~TcpStreamQoeAggregator ();
+
+  /**
+   * \brief Connect to the trace sources of every TcpStreamClient in the container.
+   */
+  void Install (ApplicationContainer apps);
+
+  /**
+   * \brief Connect to the trace sources of a client, its ClientId attribute has to be set already.
+   */
+  void Add (Ptr<TcpStreamClient> client);
+
+  /**
+   * \brief Finish all clients and write the summary.
+   * \return false if the file could not be opened
+   */
+  bool Write (std::string fileName);
+
+  /**
+   * \brief Merge the histograms of all clients (attribute RecordHistograms) and write them.
+   *
+   * Only the current or last session of a client is included, earlier sessions are in their own histogram files.
+   * \return false if the file could not be opened
+   */
+  bool WriteHistograms (std::string fileName) const;
+
+  /**
+   * \return Jain's fairness index of the average throughput of the clients, 1 for equal shares (valid after Write)
+   */
+  double GetThroughputFairness () const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Counters of a single client.
+   */
+  struct clientQoe
+  {
+    clientQoe ();
+
+    int64_t segmentDuration; //!< Duration of a segment (chunk) in microseconds
+    int64_t bytes; //!< Bytes downloaded
+    int64_t segments; //!< Segments (chunks) downloaded
+    int64_t downloadTime; //!< Sum of the download durations in microseconds
+    int64_t playedSegments; //!< Segments (chunks) whose playback started
+    int64_t lastRep; //!< Representation of the last segment, -1 before the first one
+    int64_t switches; //!< Number of representation switches
+    int64_t stalls; //!< Number of stalls
+    int64_t stallTime; //!< Sum of the stall durations in microseconds
+    bool stalled; //!< A stall is ongoing
+    int64_t stallStart; //!< Start of the ongoing stall in microseconds
+    bool finished; //!< Already added to the population statistics
+  };
+
+  void Representation (uint32_t clientId, int64_t segmentIndex, int64_t repIndex);
+  void DownloadEnd (uint32_t clientId, int64_t segmentIndex, int64_t repIndex, int64_t bytes, Time duration);
+  void StallStart (uint32_t clientId, int64_t segmentIndex);
+  void StallEnd (uint32_t clientId, Time duration);
+  void LiveLatency (uint32_t clientId, int64_t segmentIndex, Time latency);
+
+  /**
+   * \brief Add the metrics of a client to the population statistics.
+   */
+  void Finish (clientQoe &client);
+
+  std::map<uint32_t, clientQoe> m_clients; //!< Counters of every client, by client id
+  std::vector<Ptr<TcpStreamClient> > m_apps; //!< The clients, for merging their histograms
+
+  QoeStatistic m_bitrate; //!< Average bitrate per client in kbps
+  QoeStatistic m_throughput; //!< Average throughput per client in kbps
+  QoeStatistic m_stallRatio; //!< Stall time per client relative to its playback time
+  QoeStatistic m_switchFrequency; //!< Representation switches per client and minute of playback
+  QoeStatistic m_latency; //!< Live latency per segment in seconds
+  uint64_t m_stalls; //!< Stalls of all clients
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_QOE_AGGREGATOR_H */
@@ -0,0 +1,368 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "tcp-stream-trace-replayer.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
+#include "ns3/enum.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TraceReplayer");
+
+NS_OBJECT_ENSURE_REGISTERED (TraceReplayer);
+
+TypeId
+TraceReplayer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TraceReplayer")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TraceReplayer> ()
+    .AddAttribute ("TimeScale",
+                   "Factor applied to every timestamp of the trace",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&TraceReplayer::m_timeScale),
+                   MakeDoubleChecker<double> (std::numeric_limits<double>::min ()))
+    .AddAttribute ("Loop",
+                   "Restart the trace when its end is reached",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TraceReplayer::m_loop),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LoopPeriod",
+                   "Length of one iteration of the trace (before scaling), 0 to use the last timestamp of the trace",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TraceReplayer::m_loopPeriod),
+                   MakeTimeChecker ())
+    .AddAttribute ("Format",
+                   "Layout of the trace file",
+                   EnumValue (TraceReplayer::plain),
+                   MakeEnumAccessor (&TraceReplayer::m_format),
+                   MakeEnumChecker (TraceReplayer::plain, "plain",
+                                    TraceReplayer::mahimahi, "mahimahi",
+                                    TraceReplayer::fcc, "fcc",
+                                    TraceReplayer::hsdpa, "hsdpa"))
+    .AddAttribute ("SampleInterval",
+                   "Resample the trace to one rate change per interval (mahimahi: bin size, 1 s if 0), 0 to replay every sample",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TraceReplayer::m_sampleInterval),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+TraceReplayer::TraceReplayer ()
+  : m_timeScale (1.0),
+    m_loop (false),
+    m_loopOffset (0),
+    m_lastTime (0),
+    m_nextTime (0),
+    m_nextRate (0),
+    m_format (plain),
+    m_started (false),
+    m_done (false),
+    m_hasPeek (false),
+    m_peekTime (0),
+    m_peekRate (0),
+    m_curRate (0),
+    m_bin (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TraceReplayer::~TraceReplayer ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TraceReplayer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nextEvent.Cancel ();
+  m_devices.clear ();
+  if (m_trace.is_open ())
+    {
+      m_trace.close ();
+    }
+  Object::DoDispose ();
+}
+
+bool
+TraceReplayer::SetTraceFile (std::string tracePath)
+{
+  NS_LOG_FUNCTION (this << tracePath);
+  if (m_trace.is_open ())
+    {
+      m_trace.close ();
+    }
+  m_tracePath = tracePath;
+  m_trace.open (tracePath.c_str ());
+  return m_trace.is_open ();
+}
+
+void
+TraceReplayer::AddDevice (Ptr<PointToPointNetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  m_devices.push_back (device);
+}
+
+void
+TraceReplayer::AddDevices (NetDeviceContainer devices)
+{
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice> (devices.Get (i));
+      if (device)
+        {
+          AddDevice (device);
+        }
+    }
+}
+
+void
+TraceReplayer::Start (Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  m_start = Simulator::Now () + delay;
+  m_loopOffset = 0;
+  m_lastTime = 0;
+  m_started = false;
+  m_done = false;
+  m_hasPeek = false;
+  m_bin = 0;
+  if (ReadNext ())
+    {
+      ScheduleNext ();
+    }
+}
+
+void
+TraceReplayer::Stop ()
+{
+  NS_LOG_FUNCTION (this);
+  m_nextEvent.Cancel ();
+}
+
+bool
+TraceReplayer::ReadNext ()
+{
+  if (m_format == mahimahi)
+    {
+      return ReadBin ();
+    }
+  if (!m_sampleInterval.IsZero ())
+    {
+      return ReadResampled ();
+    }
+  return ReadRaw (m_nextTime, m_nextRate);
+}
+
+bool
+TraceReplayer::ReadRaw (double &time, double &rate)
+{
+  std::string line;
+  for (int pass = 0; pass < 2; pass++)
+    {
+      while (std::getline (m_trace, line))
+        {
+          double sampleTime, sampleRate, sampleEnd;
+          if (ParseLine (line, sampleTime, sampleRate, sampleEnd))
+            {
+              m_lastTime = std::max (m_lastTime, sampleEnd);
+              time = m_loopOffset + sampleTime;
+              rate = sampleRate;
+              return true;
+            }
+        }
+      if (!m_loop)
+        {
+          return false;
+        }
+      double period = m_loopPeriod.IsZero () ? m_lastTime : m_loopPeriod.GetSeconds ();
+      // a period scaled below the time resolution would replay the trace at the same instant forever
+      if (period <= 0 || Seconds (period * m_timeScale).IsZero ())
+        {
+          NS_LOG_WARN ("Trace " << m_tracePath << " has no duration, not looping");
+          return false;
+        }
+      m_trace.clear ();
+      m_trace.seekg (0, std::ios::beg);
+      m_loopOffset += period;
+      m_lastTime = 0;
+    }
+  return false;
+}
+
+bool
+TraceReplayer::ParseLine (const std::string &line, double &time, double &rate, double &end) const
+{
+  std::istringstream values (line);
+  switch (m_format)
+    {
+    case mahimahi:
+      {
+        double ms;
+        if (!(values >> ms))
+          {
+            return false;
+          }
+        time = end = ms / 1000;
+        rate = 0;
+        return true;
+      }
+    case fcc:
+      {
+        double mbps;
+        if (!(values >> time >> mbps))
+          {
+            return false;
+          }
+        end = time;
+        rate = mbps * 1000;
+        return true;
+      }
+    case hsdpa:
+      {
+        double unixTime, sinceStart, latitude, longitude, bytes, sinceLast;
+        if (!(values >> unixTime >> sinceStart >> latitude >> longitude >> bytes >> sinceLast) || sinceLast <= 0)
+          {
+            return false;
+          }
+        // the bytes were received during the sinceLast ms before the timestamp, bit/ms = kbit/s
+        time = (sinceStart - sinceLast) / 1000;
+        end = sinceStart / 1000;
+        rate = bytes * 8 / sinceLast;
+        return true;
+      }
+    default:
+      if (!(values >> time >> rate))
+        {
+          return false;
+        }
+      end = time;
+      return true;
+    }
+}
+
+void
+TraceReplayer::Peek ()
+{
+  m_hasPeek = ReadRaw (m_peekTime, m_peekRate);
+}
+
+bool
+TraceReplayer::ReadBin ()
+{
+  double interval = m_sampleInterval.IsZero () ? 1.0 : m_sampleInterval.GetSeconds ();
+  if (!m_started)
+    {
+      Peek ();
+      m_started = true;
+    }
+  if (!m_hasPeek)
+    {
+      return false;
+    }
+  double binEnd = (m_bin + 1) * interval;
+  uint64_t deliveries = 0;
+  while (m_hasPeek && m_peekTime < binEnd)
+    {
+      deliveries++;
+      Peek ();
+    }
+  m_nextTime = m_bin * interval;
+  m_nextRate = deliveries * 1500 * 8 / interval / 1000;
+  m_bin++;
+  return true;
+}
+
+bool
+TraceReplayer::ReadResampled ()
+{
+  double interval = m_sampleInterval.GetSeconds ();
+  if (!m_started)
+    {
+      Peek ();
+      if (!m_hasPeek)
+        {
+          return false;
+        }
+      // the rate before the first sample is unknown, extend the first sample back to its interval start
+      m_bin = (uint64_t) std::floor (m_peekTime / interval);
+      m_curRate = m_peekRate;
+      Peek ();
+      m_started = true;
+    }
+  if (m_done)
+    {
+      return false;
+    }
+  double binStart = m_bin * interval;
+  double binEnd = binStart + interval;
+  double position = binStart;
+  double bits = 0;
+  while (m_hasPeek && m_peekTime < binEnd)
+    {
+      if (m_peekTime > position)
+        {
+          bits += m_curRate * (m_peekTime - position);
+          position = m_peekTime;
+        }
+      m_curRate = m_peekRate;
+      Peek ();
+    }
+  bits += m_curRate * (binEnd - position);
+  // after the last sample the rate stays constant, so one interval entirely past it ends the trace
+  m_done = !m_hasPeek && position <= binStart;
+  m_nextTime = binStart;
+  m_nextRate = bits / interval;
+  m_bin++;
+  return true;
+}
+
+void
+TraceReplayer::ScheduleNext ()
+{
+  Time at = m_start + Seconds (m_nextTime * m_timeScale);
+  Time delay = at > Simulator::Now () ? at - Simulator::Now () : Seconds (0);
+  m_nextEvent = Simulator::Schedule (delay, &TraceReplayer::ChangeBandwidth, this);
+}
+
+void
+TraceReplayer::ChangeBandwidth ()
+{
+  NS_LOG_FUNCTION (this << m_nextRate);
+  // outages (e.g. empty mahimahi bins) are replayed as 1 kbit/s, a zero rate would stall the device for good
+  DataRate rate ((uint64_t)(std::max (m_nextRate, 1.0) * 1000));
+  for (std::vector<Ptr<PointToPointNetDevice> >::iterator it = m_devices.begin (); it != m_devices.end (); ++it)
+    {
+      (*it)->SetDataRate (rate);
+    }
+  if (ReadNext ())
+    {
+      ScheduleNext ();
+    }
+}
+
+} // namespace ns3
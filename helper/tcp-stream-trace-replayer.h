@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TCP_STREAM_TRACE_REPLAYER_H
+#define TCP_STREAM_TRACE_REPLAYER_H
+
+#include <stdint.h>
+#include <fstream>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/net-device-container.h"
+#include "ns3/point-to-point-net-device.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Shapes the data rate of point-to-point devices according to a throughput trace.
+ *
+ * The trace consists of "time kbps" lines (time in seconds, rate in kbit/s). The file is read
+ * lazily: only the next rate change is kept in memory and scheduled, so long traces with a fine
+ * resolution do not fill the event queue at simulation start. The devices are bound directly,
+ * so a rate change costs no Config path resolution.
+ *
+ * With Loop enabled, the trace restarts after LoopPeriod (or after its last timestamp if
+ * LoopPeriod is zero). TimeScale stretches (> 1) or compresses (< 1) the trace timeline.
+ *
+ * Besides the native format, the Format attribute selects a parser for the public trace corpora,
+ * which are converted line by line while replaying:
+ *  - mahimahi: one packet delivery opportunity (1500 bytes) per line, timestamp in ms. Deliveries
+ *    are counted in bins of SampleInterval (1 s if zero) and replayed as the mean rate of each bin.
+ *  - fcc: "time Mbps" lines, the layout the FCC broadband and Norway HSDPA corpora are distributed in
+ *    for ABR evaluation.
+ *  - hsdpa: raw Norway HSDPA logs, "unixtime ms_since_start lat long bytes ms_since_last" per line.
+ * If SampleInterval is non-zero, the other formats are resampled to one rate change per interval,
+ * each being the time-weighted mean rate over the interval.
+ */
+class TraceReplayer : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Layout of the trace file.
+   */
+  enum traceFormat
+  {
+    plain, mahimahi, fcc, hsdpa
+  };
+
+  TraceReplayer ();
+  virtual ~TraceReplayer ();
+
+  /**
+   * \brief Open the trace file to replay.
+   * \param tracePath the relative path (from ns-3.x directory) to the trace file
+   * \return false if the file could not be opened
+   */
+  bool SetTraceFile (std::string tracePath);
+
+  /**
+   * \brief Add a device whose data rate follows the trace.
+   */
+  void AddDevice (Ptr<PointToPointNetDevice> device);
+
+  /**
+   * \brief Add all point-to-point devices of the container, other device types are ignored.
+   */
+  void AddDevices (NetDeviceContainer devices);
+
+  /**
+   * \brief Start replaying the trace, trace time 0 corresponds to the given delay from now.
+   */
+  void Start (Time delay);
+
+  /**
+   * \brief Stop replaying, the devices keep their current data rate.
+   */
+  void Stop ();
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Read the next rate change from the trace into m_nextTime and m_nextRate.
+   *
+   * Dispatches to binning or resampling depending on Format and SampleInterval.
+   *
+   * \return false if the trace is exhausted
+   */
+  bool ReadNext ();
+
+  /**
+   * \brief Read the next sample of the file, as converted by ParseLine.
+   *
+   * Rewinds the file when looping is enabled and the end of the trace was reached.
+   *
+   * \param time trace time of the sample in seconds, including the offset of the current iteration
+   * \param rate rate of the sample in kbit/s (unused for mahimahi)
+   * \return false if the trace is exhausted
+   */
+  bool ReadRaw (double &time, double &rate);
+
+  /**
+   * \brief Convert one line of the file according to m_format.
+   * \param end set to the time up to which the sample is valid, if known
+   * \return false for comments, empty or malformed lines
+   */
+  bool ParseLine (const std::string &line, double &time, double &rate, double &end) const;
+
+  /**
+   * \brief Read the next sample into m_peekTime and m_peekRate, clears m_hasPeek at the end of the trace.
+   */
+  void Peek ();
+
+  /**
+   * \brief Count the mahimahi deliveries of the next bin.
+   */
+  bool ReadBin ();
+
+  /**
+   * \brief Average the piecewise constant rate of the trace over the next interval.
+   */
+  bool ReadResampled ();
+
+  /**
+   * \brief Apply the pending rate change to all devices and schedule the next one.
+   */
+  void ChangeBandwidth ();
+
+  void ScheduleNext ();
+
+  std::string m_tracePath; //!< Path of the trace file, for logging purposes
+  std::ifstream m_trace; //!< The trace file, read one line per rate change
+  std::vector<Ptr<PointToPointNetDevice> > m_devices; //!< Devices shaped by this trace
+  EventId m_nextEvent; //!< The pending rate change
+  Time m_start; //!< Simulation time corresponding to trace time 0
+  double m_timeScale; //!< Factor applied to all trace timestamps
+  bool m_loop; //!< Restart the trace when its end is reached
+  Time m_loopPeriod; //!< Length of one iteration of the trace, 0 to use the last timestamp
+  double m_loopOffset; //!< Trace time in seconds at which the current iteration started
+  double m_lastTime; //!< Last timestamp read in the current iteration, in seconds
+  double m_nextTime; //!< Trace time of the pending rate change, in seconds
+  double m_nextRate; //!< Rate of the pending rate change, in kbit/s
+  traceFormat m_format; //!< Layout of the trace file
+  Time m_sampleInterval; //!< Resampling (or mahimahi binning) interval, 0 for none
+  bool m_started; //!< Whether the first sample was read since Start
+  bool m_done; //!< Whether the final resampled interval was emitted
+  bool m_hasPeek; //!< Whether m_peekTime and m_peekRate hold an unconsumed sample
+  double m_peekTime; //!< Trace time of the lookahead sample, in seconds
+  double m_peekRate; //!< Rate of the lookahead sample, in kbit/s
+  double m_curRate; //!< Rate in effect at the current resampling position, in kbit/s
+  uint64_t m_bin; //!< Index of the next interval to emit
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_TRACE_REPLAYER_H */
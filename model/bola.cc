@@ -12,8 +12,8 @@ namespace ns3 {
   NS_LOG_COMPONENT_DEFINE ("BolaAlgo");
   NS_OBJECT_ENSURE_REGISTERED (BolaAlgo);
 
-  BolaAlgo::BolaAlgo (const videoData &videoData, const playbackData & playbackData, const bufferData & bufferData, const throughputData & throughput, int chunks, int cmaf) : AdaptationAlgorithm (videoData, playbackData, bufferData, throughput), m_highestRepIndex (videoData.averageBitrate.size () - 1),
-	chunks(chunks), cmaf(cmaf) {
+  BolaAlgo::BolaAlgo (const videoData &videoData, const playbackData & playbackData, const bufferData & bufferData, const throughputData & throughput, int chunks, int cmaf, bool useSegmentSizes) : AdaptationAlgorithm (videoData, playbackData, bufferData, throughput), m_highestRepIndex (videoData.averageBitrate.size () - 1),
+	chunks(chunks), cmaf(cmaf), m_useSegmentSizes(useSegmentSizes) {
     NS_LOG_INFO (this);
     NS_ASSERT_MSG (m_highestRepIndex >= 0, "The highest quality representation index should be >= 0");
   }
@@ -27,13 +27,14 @@ namespace ns3 {
     int64_t bDelay = 0;
     const int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
 
-    if(segmentCounter == 0) {  
+    // the duration of the segment to be requested, segments may last differently long
+    if(chunks > 0) {
+      segDuration = chunks*m_videoData.GetSegmentDuration (segmentCounter);
+    } else {
+      segDuration = m_videoData.GetSegmentDuration (segmentCounter);
+    }
 
-      if(chunks > 0) {
-      	segDuration = chunks*m_videoData.segmentDuration;
-      } else {
-        segDuration = m_videoData.segmentDuration;
-      }
+    if(segmentCounter == 0) {
       m_lastRepIndex = nextRepIndex;
       algorithmReply answer;
       answer.nextRepIndex = nextRepIndex;
@@ -67,6 +68,21 @@ namespace ns3 {
 
     }
 
+    // bolavbr: the utilities stay with the average bitrates, but the scores and the comparison with the
+    // throughput use the bitrate of the segment about to be requested
+    if (m_useSegmentSizes) {
+      int64_t group = chunks > 0 ? chunks : 1;
+      int64_t available = GetSizeWindow (segmentCounter, group, m_sizeWindow);
+      double seconds = (m_videoData.GetSegmentStart (segmentCounter + available) - m_videoData.GetSegmentStart (segmentCounter)) / (double)1000000;
+      for(int i=0; i<=m_highestRepIndex && available > 0; i++) {
+        double bits = 0;
+        for(int64_t e=0; e<available; e++) {
+          bits += 8.0 * m_sizeWindow[i][e];
+        }
+        bitrates[i] = bits / seconds / 1000;
+      }
+    }
+
     double throughput = AverageSegmentThroughput(segmentCounter)/1000;
     
     
@@ -12,7 +12,7 @@ public:
                       const playbackData & playbackData,
                       const bufferData & bufferData,
                       const throughputData & throughput,
-					  int chunks, int cmaf);
+					  int chunks, int cmaf, bool useSegmentSizes = false);
 
   algorithmReply GetNextRep ( const int64_t segmentCounter, int64_t clientId);
 
@@ -45,6 +45,9 @@ private:
   uint64_t segDuration;
   int64_t chunks;
   int cmaf;
+
+  bool m_useSegmentSizes; //!< Score with the bitrate of the upcoming segment instead of the average bitrate
+  std::vector<std::vector<int64_t> > m_sizeWindow; //!< Sizes of the upcoming segment, reused across decisions
 };
 } // namespace ns3
 #endif /* BOLA_ALGORITHM_H */
\ No newline at end of file
@@ -182,6 +182,12 @@ FestiveAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
     harmonicMeanDenominator += 1 / (thrptEstimationTmp.at (i));
   }
   double thrptEstimation = thrptEstimationTmp.size () / harmonicMeanDenominator;
+  // with network assistance, do not aim above the share recommended by the server
+  double assistedBitrate;
+  if (GetAssistedBitrate (assistedBitrate))
+  {
+    thrptEstimation = std::min (thrptEstimation, assistedBitrate);
+  }
   thrptEstimation = thrptEstimation * m_thrptThrsh;
   answer.bandwidthEstimate = thrptEstimation/(double)1000000;
 
@@ -11,8 +11,8 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("MPCAlgo");
 NS_OBJECT_ENSURE_REGISTERED (MPCAlgo);
 
-MPCAlgo::MPCAlgo (const videoData &videoData, const playbackData & playbackData, const bufferData & bufferData, const throughputData & throughput, int chunks, int cmaf) : AdaptationAlgorithm (videoData, playbackData, bufferData, throughput), m_highestRepIndex (videoData.averageBitrate.size () - 1),
-	chunks(chunks), cmaf(cmaf)
+MPCAlgo::MPCAlgo (const videoData &videoData, const playbackData & playbackData, const bufferData & bufferData, const throughputData & throughput, int chunks, int cmaf, bool useSegmentSizes) : AdaptationAlgorithm (videoData, playbackData, bufferData, throughput), m_highestRepIndex (videoData.averageBitrate.size () - 1),
+	chunks(chunks), cmaf(cmaf), m_useSegmentSizes(useSegmentSizes)
 {
   NS_LOG_INFO (this);
   NS_ASSERT_MSG (m_highestRepIndex >= 0, "The highest quality representation index should be >= 0");
@@ -26,12 +26,14 @@ algorithmReply MPCAlgo::GetNextRep ( const int64_t segmentCounter, int64_t clien
 	int64_t bDelay = 0;
 	const int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
 
+	// the duration of the segment to be requested, segments may last differently long
+	if(chunks > 0) {
+		segDuration = chunks*m_videoData.GetSegmentDuration (segmentCounter);
+	} else {
+		segDuration = m_videoData.GetSegmentDuration (segmentCounter);
+	}
+
 	if(segmentCounter == 0) {
-		if(chunks > 0) {
-			segDuration = chunks*m_videoData.segmentDuration;
-		} else {
-			segDuration = m_videoData.segmentDuration;
-		}
 		m_lastRepIndex = nextRepIndex;
 		algorithmReply answer;
 		answer.nextRepIndex = nextRepIndex;
@@ -197,6 +199,11 @@ algorithmReply MPCAlgo::GetNextRep ( const int64_t segmentCounter, int64_t clien
 		if(count > 4) { break; }
 	}
 	double future_bandwidth = harmonic_bandwidth/(1+max_error); // robustMPC here
+	// with network assistance, do not plan above the share recommended by the server
+	double assisted_bandwidth;
+	if (GetAssistedBitrate (assisted_bandwidth)) {
+		future_bandwidth = std::min (future_bandwidth, assisted_bandwidth);
+	}
 
 	past_bandwidth_ests.push_front(harmonic_bandwidth);
 
@@ -204,7 +211,27 @@ algorithmReply MPCAlgo::GetNextRep ( const int64_t segmentCounter, int64_t clien
 	double start_buffer = (m_bufferData.bufferLevelNew.back ()/ (double)1000000 - (timeNow - m_bufferData.timeNow.back())/ (double)1000000);
 	nextRepIndex = (int)m_lastRepIndex;
 
-	int possibleCombos = (int)std::pow(5.0, m_highestRepIndex+1);
+	// mpcvbr: the download time of every step of the horizon follows from the actual size of its segments,
+	// the horizon ends with the stream
+	int horizon = 5;
+	if (m_useSegmentSizes) {
+		int64_t group = chunks > 0 ? chunks : 1;
+		int64_t available = GetSizeWindow (segmentCounter, 5*group, m_sizeWindow);
+		horizon = std::max ((int64_t) 1, (available + group - 1) / group);
+		m_stepBits.resize (m_highestRepIndex+1);
+		for (int r=0; r<=m_highestRepIndex; r++) {
+			m_stepBits[r].assign (horizon, 0);
+			for (int64_t e=0; e<available; e++) {
+				m_stepBits[r][e/group] += 8.0 * m_sizeWindow[r][e];
+			}
+		}
+		m_stepSeconds.resize (horizon);
+		for (int j=0; j<horizon; j++) {
+			m_stepSeconds[j] = (m_videoData.GetSegmentStart (segmentCounter + (j+1)*group) - m_videoData.GetSegmentStart (segmentCounter + j*group)) / (double)1000000;
+		}
+	}
+
+	int possibleCombos = (int)std::pow((double)(m_highestRepIndex+1), 5);
 
 	int combos[possibleCombos+1][5];
 	count = 0;
@@ -234,9 +261,14 @@ algorithmReply MPCAlgo::GetNextRep ( const int64_t segmentCounter, int64_t clien
 		double smoothness_diffs = 0;
 		int last_quality = (int)m_lastRepIndex;
 
-		for(int j=0; j<5; j++) {
+		for(int j=0; j<horizon; j++) {
 			int chunk_quality = combos[i][j];
 			double download_time = (m_videoData.averageBitrate.at(chunk_quality) * a) / future_bandwidth;
+			double step = a;
+			if (m_useSegmentSizes) {
+				download_time = m_stepBits[chunk_quality][j] / future_bandwidth;
+				step = m_stepSeconds[j];
+			}
 
 			if ( curr_buffer < download_time ) {
 				curr_rebuffer_time += (download_time - curr_buffer);
@@ -245,7 +277,7 @@ algorithmReply MPCAlgo::GetNextRep ( const int64_t segmentCounter, int64_t clien
 				curr_buffer -= download_time;
 			}
 
-			curr_buffer += a;
+			curr_buffer += step;
 			bitrate_sum += m_videoData.averageBitrate.at(chunk_quality)/1000;
 			smoothness_diffs += abs((m_videoData.averageBitrate.at(chunk_quality)/1000) - (m_videoData.averageBitrate.at(last_quality)/1000));
 			last_quality = chunk_quality;
@@ -12,7 +12,7 @@ public:
                       const playbackData & playbackData,
                       const bufferData & bufferData,
                       const throughputData & throughput,
-					  int chunks, int cmaf);
+					  int chunks, int cmaf, bool useSegmentSizes = false);
 
   algorithmReply GetNextRep ( const int64_t segmentCounter, int64_t clientId);
 
@@ -30,6 +30,11 @@ private:
   uint64_t segDuration;
   int64_t chunks;
   int cmaf;
+
+  bool m_useSegmentSizes; //!< Predict download times from the sizes of the upcoming segments instead of the average bitrates
+  std::vector<std::vector<int64_t> > m_sizeWindow; //!< Sizes of the upcoming segments, reused across decisions
+  std::vector<std::vector<double> > m_stepBits; //!< Bits of every representation in every step of the horizon
+  std::vector<double> m_stepSeconds; //!< Duration of every step of the horizon in seconds
   
 };
 } // namespace ns3
@@ -50,13 +50,14 @@ PandaAlgorithm::GetNextRep (const int64_t segmentCounter, int64_t clientId)
 {
   const int64_t timeNow = Simulator::Now ().GetMicroSeconds ();
   int64_t delay = 0;
+  // the duration of the segment to be requested, segments may last differently long
+  if(chunks > 0) {
+    segDuration = chunks*m_videoData.GetSegmentDuration (segmentCounter);
+  } else {
+    segDuration = m_videoData.GetSegmentDuration (segmentCounter);
+  }
   if (segmentCounter == 0)
     {
-		if(chunks > 0) {
-			segDuration = chunks*m_videoData.segmentDuration;
-		} else {
-			segDuration = m_videoData.segmentDuration;
-		}
       m_lastVideoIndex = 0;
       m_lastBuffer = (segDuration) / 1e6;
       m_lastTargetInterrequestTime = 0;
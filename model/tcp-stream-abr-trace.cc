@@ -0,0 +1,349 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "tcp-stream-abr-trace.h"
+#include "tcp-stream-adaptation-algorithm.h"
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AbrTrace");
+
+namespace {
+
+const char abrTraceMagic[8] = { 'D', 'A', 'S', 'H', 'A', 'B', 'R', '1' };
+const uint8_t abrTraceRecordTag = 1;
+
+void
+WriteVarint (std::ostream & out, uint64_t value)
+{
+  while (value >= 0x80)
+    {
+      out.put ((char)((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+  out.put ((char) value);
+}
+
+void
+WriteSigned (std::ostream & out, int64_t value)
+{
+  WriteVarint (out, ((uint64_t) value << 1) ^ (uint64_t)(value >> 63));
+}
+
+bool
+ReadVarint (std::istream & in, uint64_t & value)
+{
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7)
+    {
+      int c = in.get ();
+      if (c == EOF)
+        {
+          return false;
+        }
+      value |= (uint64_t)(c & 0x7f) << shift;
+      if ((c & 0x80) == 0)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+ReadSigned (std::istream & in, int64_t & value)
+{
+  uint64_t raw;
+  if (!ReadVarint (in, raw))
+    {
+      return false;
+    }
+  value = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+  return true;
+}
+
+void
+WriteString (std::ostream & out, const std::string & value)
+{
+  WriteVarint (out, value.size ());
+  out.write (value.data (), value.size ());
+}
+
+bool
+ReadString (std::istream & in, std::string & value)
+{
+  uint64_t length;
+  if (!ReadVarint (in, length))
+    {
+      return false;
+    }
+  value.resize (length);
+  in.read (&value[0], length);
+  return (uint64_t) in.gcount () == length;
+}
+
+} // anonymous namespace
+
+AbrTraceRecorder::AbrTraceRecorder ()
+{
+  std::fill (m_recorded, m_recorded + 9, 0);
+}
+
+bool
+AbrTraceRecorder::Open (std::string fileName, const abrTraceHeader & header)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  m_file.open (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file)
+    {
+      return false;
+    }
+  m_file.write (abrTraceMagic, sizeof (abrTraceMagic));
+  WriteVarint (m_file, header.clientId);
+  WriteSigned (m_file, header.segmentDuration);
+  WriteSigned (m_file, header.chunk);
+  WriteSigned (m_file, header.cmaf);
+  WriteString (m_file, header.algorithm);
+  WriteString (m_file, header.segmentSizeFile);
+  std::fill (m_recorded, m_recorded + 9, 0);
+  return true;
+}
+
+void
+AbrTraceRecorder::Record (int64_t segmentCounter, int64_t timeNow,
+                          const throughputData & throughput,
+                          const bufferData & bufferData,
+                          const playbackData & playbackData,
+                          const algorithmReply & answer)
+{
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  m_file.put ((char) abrTraceRecordTag);
+  WriteSigned (m_file, segmentCounter);
+  WriteSigned (m_file, timeNow);
+  WriteTail (throughput.transmissionRequested, m_recorded[0]);
+  WriteTail (throughput.transmissionStart, m_recorded[1]);
+  WriteTail (throughput.transmissionEnd, m_recorded[2]);
+  WriteTail (throughput.bytesReceived, m_recorded[3]);
+  WriteTail (bufferData.timeNow, m_recorded[4]);
+  WriteTail (bufferData.bufferLevelOld, m_recorded[5]);
+  WriteTail (bufferData.bufferLevelNew, m_recorded[6]);
+  WriteTail (playbackData.playbackIndex, m_recorded[7]);
+  WriteTail (playbackData.playbackStart, m_recorded[8]);
+  WriteSigned (m_file, answer.nextRepIndex);
+}
+
+void
+AbrTraceRecorder::WriteTail (const std::vector<int64_t> & values, size_t & recorded)
+{
+  NS_ASSERT_MSG (values.size () >= recorded, "ABR input histories must only grow");
+  WriteVarint (m_file, values.size () - recorded);
+  // Histories are mostly monotonic timestamps, so successive entries are stored as differences.
+  int64_t previous = recorded > 0 ? values[recorded - 1] : 0;
+  for (size_t i = recorded; i < values.size (); i++)
+    {
+      WriteSigned (m_file, values[i] - previous);
+      previous = values[i];
+    }
+  recorded = values.size ();
+}
+
+void
+AbrTraceRecorder::Close ()
+{
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+}
+
+bool
+AbrTraceRecorder::IsOpen () const
+{
+  return m_file.is_open ();
+}
+
+AbrTraceReplayer::AbrTraceReplayer ()
+  : m_algo (0),
+    m_output (0),
+    m_segmentCounter (0),
+    m_decisionTime (0),
+    m_recordedRepIndex (0),
+    m_decisions (0),
+    m_agreements (0)
+{
+}
+
+AbrTraceReplayer::~AbrTraceReplayer ()
+{
+  m_algo = 0;
+  m_output = 0;
+}
+
+bool
+AbrTraceReplayer::Open (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  m_file.open (fileName.c_str (), std::ios::in | std::ios::binary);
+  if (!m_file)
+    {
+      return false;
+    }
+  char magic[sizeof (abrTraceMagic)];
+  m_file.read (magic, sizeof (magic));
+  if (m_file.gcount () != sizeof (magic) || std::memcmp (magic, abrTraceMagic, sizeof (magic)) != 0)
+    {
+      NS_LOG_ERROR ("Not an ABR input trace: " << fileName);
+      return false;
+    }
+  uint64_t clientId;
+  bool ok = ReadVarint (m_file, clientId)
+    && ReadSigned (m_file, m_header.segmentDuration)
+    && ReadSigned (m_file, m_header.chunk)
+    && ReadSigned (m_file, m_header.cmaf)
+    && ReadString (m_file, m_header.algorithm)
+    && ReadString (m_file, m_header.segmentSizeFile);
+  m_header.clientId = (uint32_t) clientId;
+  m_videoData.segmentDuration = m_header.segmentDuration;
+  return ok;
+}
+
+const abrTraceHeader &
+AbrTraceReplayer::GetHeader () const
+{
+  return m_header;
+}
+
+void
+AbrTraceReplayer::Replay (AdaptationAlgorithm *algo, std::ostream & output)
+{
+  NS_LOG_FUNCTION (this);
+  m_algo = algo;
+  m_output = &output;
+  if (ReadRecord ())
+    {
+      Simulator::Schedule (MicroSeconds (m_decisionTime) - Simulator::Now (), &AbrTraceReplayer::ReplayNext, this);
+    }
+  Simulator::Run ();
+}
+
+void
+AbrTraceReplayer::ReplayNext ()
+{
+  algorithmReply answer = m_algo->GetNextRep (m_segmentCounter, m_header.clientId);
+  m_decisions++;
+  if (answer.nextRepIndex == m_recordedRepIndex)
+    {
+      m_agreements++;
+    }
+  *m_output << m_header.clientId << " "
+            << m_segmentCounter << " "
+            << m_decisionTime / (double)1000000 << " "
+            << m_recordedRepIndex << " "
+            << answer.nextRepIndex << "\n";
+
+  if (ReadRecord ())
+    {
+      Simulator::Schedule (MicroSeconds (m_decisionTime) - Simulator::Now (), &AbrTraceReplayer::ReplayNext, this);
+    }
+}
+
+bool
+AbrTraceReplayer::ReadRecord ()
+{
+  int tag = m_file.get ();
+  if (tag != abrTraceRecordTag)
+    {
+      return false;
+    }
+  return ReadSigned (m_file, m_segmentCounter)
+         && ReadSigned (m_file, m_decisionTime)
+         && ReadTail (m_throughput.transmissionRequested)
+         && ReadTail (m_throughput.transmissionStart)
+         && ReadTail (m_throughput.transmissionEnd)
+         && ReadTail (m_throughput.bytesReceived)
+         && ReadTail (m_bufferData.timeNow)
+         && ReadTail (m_bufferData.bufferLevelOld)
+         && ReadTail (m_bufferData.bufferLevelNew)
+         && ReadTail (m_playbackData.playbackIndex)
+         && ReadTail (m_playbackData.playbackStart)
+         && ReadSigned (m_file, m_recordedRepIndex);
+}
+
+bool
+AbrTraceReplayer::ReadTail (std::vector<int64_t> & values)
+{
+  uint64_t count;
+  if (!ReadVarint (m_file, count))
+    {
+      return false;
+    }
+  int64_t value = values.empty () ? 0 : values.back ();
+  for (uint64_t i = 0; i < count; i++)
+    {
+      int64_t delta;
+      if (!ReadSigned (m_file, delta))
+        {
+          return false;
+        }
+      value += delta;
+      values.push_back (value);
+    }
+  return true;
+}
+
+uint64_t
+AbrTraceReplayer::GetDecisions () const
+{
+  return m_decisions;
+}
+
+uint64_t
+AbrTraceReplayer::GetAgreements () const
+{
+  return m_agreements;
+}
+
+videoData &
+AbrTraceReplayer::GetVideoData ()
+{
+  return m_videoData;
+}
+
+const playbackData &
+AbrTraceReplayer::GetPlaybackData () const
+{
+  return m_playbackData;
+}
+
+const bufferData &
+AbrTraceReplayer::GetBufferData () const
+{
+  return m_bufferData;
+}
+
+const throughputData &
+AbrTraceReplayer::GetThroughputData () const
+{
+  return m_throughput;
+}
+
+} // namespace ns3
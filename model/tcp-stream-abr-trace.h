@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_ABR_TRACE_H
+#define TCP_STREAM_ABR_TRACE_H
+
+#include <stdint.h>
+#include <string>
+#include <fstream>
+#include "tcp-stream-interface.h"
+
+namespace ns3 {
+
+class AdaptationAlgorithm;
+
+/**
+ * \ingroup tcpStream
+ * \brief Header of an ABR input trace, describing the client that recorded it.
+ */
+struct abrTraceHeader
+{
+  uint32_t clientId; //!< Id of the client that recorded the trace
+  int64_t segmentDuration; //!< duration of a segment (or chunk) in microseconds
+  int64_t chunk; //!< number of chunks in a segment, 0 if segments have no chunks
+  int64_t cmaf; //!< cmaf version the client was configured with
+  std::string algorithm; //!< name of the adaptation algorithm that made the recorded decisions
+  std::string segmentSizeFile; //!< segment size file the client streamed
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Records the inputs of every AdaptationAlgorithm::GetNextRep call into a compact binary trace.
+ *
+ * The client histories (throughputData, bufferData, playbackData) only ever grow at their end, so every
+ * record holds just the entries appended since the previous record, the segment counter, the simulation
+ * time of the call and the decision that was taken. Integers are written as zigzag LEB128 varints.
+ * Replaying all records in order rebuilds the exact histories every call saw.
+ */
+class AbrTraceRecorder
+{
+public:
+  AbrTraceRecorder ();
+
+  /**
+   * \brief Create the trace file and write its header.
+   * \return false if the file could not be opened
+   */
+  bool Open (std::string fileName, const abrTraceHeader & header);
+
+  /**
+   * \brief Append one decision to the trace.
+   *
+   * Must be called right after GetNextRep returned, before the client modifies its histories.
+   */
+  void Record (int64_t segmentCounter, int64_t timeNow,
+               const throughputData & throughput,
+               const bufferData & bufferData,
+               const playbackData & playbackData,
+               const algorithmReply & answer);
+
+  void Close ();
+  bool IsOpen () const;
+
+private:
+  void WriteTail (const std::vector<int64_t> & values, size_t & recorded);
+
+  std::ofstream m_file; //!< Output stream of the trace
+  size_t m_recorded[9]; //!< Number of entries of every history vector already written to the trace
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Feeds a recorded ABR input trace to an adaptation algorithm.
+ *
+ * The replayer owns its own history structs and appends the recorded entries before every call, so the
+ * algorithm under test sees exactly what the recording algorithm saw. Calls are scheduled at their recorded
+ * simulation time, which keeps Simulator::Now () consistent for algorithms that read it, while no network
+ * is simulated. The representation indices the client played stay the recorded ones: the replay answers
+ * "what would this algorithm have decided given these inputs", not how the session would have evolved.
+ */
+class AbrTraceReplayer
+{
+public:
+  AbrTraceReplayer ();
+  ~AbrTraceReplayer ();
+
+  /**
+   * \brief Open a trace file and read its header.
+   * \return false if the file could not be opened or is not an ABR input trace
+   */
+  bool Open (std::string fileName);
+
+  const abrTraceHeader & GetHeader () const;
+
+  /**
+   * \brief Replay the whole trace through the given algorithm.
+   *
+   * Runs the simulator until the trace is exhausted and writes one line per decision to output:
+   * client id, segment index, decision time, recorded representation index and replayed representation index.
+   * The algorithm must have been constructed on the videoData, playbackData, bufferData and
+   * throughputData references returned by this replayer.
+   */
+  void Replay (AdaptationAlgorithm *algo, std::ostream & output);
+
+  uint64_t GetDecisions () const; //!< number of replayed decisions
+  uint64_t GetAgreements () const; //!< number of decisions where the replayed algorithm chose the recorded index
+
+  videoData & GetVideoData ();
+  const playbackData & GetPlaybackData () const;
+  const bufferData & GetBufferData () const;
+  const throughputData & GetThroughputData () const;
+
+private:
+  bool ReadRecord ();
+  bool ReadTail (std::vector<int64_t> & values);
+  void ReplayNext ();
+
+  std::ifstream m_file; //!< Input stream of the trace
+  abrTraceHeader m_header; //!< Header of the opened trace
+  AdaptationAlgorithm *m_algo; //!< Algorithm under test, not owned
+  std::ostream *m_output; //!< Stream the replayed decisions are written to
+
+  int64_t m_segmentCounter; //!< segment counter of the pending record
+  int64_t m_decisionTime; //!< simulation time of the pending record in microseconds
+  int64_t m_recordedRepIndex; //!< representation index chosen by the recording algorithm
+  uint64_t m_decisions;
+  uint64_t m_agreements;
+
+  videoData m_videoData;
+  throughputData m_throughput;
+  bufferData m_bufferData;
+  playbackData m_playbackData;
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_ABR_TRACE_H */
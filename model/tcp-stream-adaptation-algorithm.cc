@@ -30,8 +30,44 @@ AdaptationAlgorithm::AdaptationAlgorithm (  const videoData & videoData,
   m_videoData (videoData),
   m_bufferData (bufferData),
   m_throughput (throughput),
-  m_playbackData (playbackData)
+  m_playbackData (playbackData),
+  m_assistance (0)
 {
 }
 
+void
+AdaptationAlgorithm::SetAssistanceData (const assistanceData & assistance)
+{
+  m_assistance = &assistance;
+}
+
+bool
+AdaptationAlgorithm::GetAssistedBitrate (double & bitrate) const
+{
+  if (m_assistance == 0 || m_assistance->hintTime.empty ())
+    {
+      return false;
+    }
+  if (Simulator::Now ().GetMicroSeconds () - m_assistance->hintTime.back () > m_assistance->validity.back ())
+    {
+      return false;
+    }
+  bitrate = m_assistance->recommendedBitrate.back ();
+  return true;
+}
+
+int64_t
+AdaptationAlgorithm::GetSizeWindow (int64_t first, int64_t count, std::vector<std::vector<int64_t> > & window) const
+{
+  window.resize (m_videoData.segmentSize.size ());
+  int64_t available = 0;
+  for (uint32_t r = 0; r < window.size (); r++)
+    {
+      window[r].resize (count);
+      available = m_videoData.segmentSize.at (r).GetRange (first, count, window[r].data ());
+      window[r].resize (available);
+    }
+  return available;
+}
+
 } // namespace ns3
\ No newline at end of file
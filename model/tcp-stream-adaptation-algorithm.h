@@ -56,11 +56,35 @@ public:
    */
   virtual algorithmReply GetNextRep ( const int64_t segmentCounter, int64_t clientId) = 0;
 
+  /**
+   * \brief Give the algorithm access to the bitrate hints of the client, see assistanceData.
+   *
+   * Without hints, algorithms rely on their own throughput estimates only.
+   */
+  void SetAssistanceData (const assistanceData & assistance);
+
 protected:
+  /**
+   * \param bitrate set to the newest hint in bit/s, if it is still valid
+   * \return true if a valid hint exists
+   */
+  bool GetAssistedBitrate (double & bitrate) const;
+  /**
+   * \brief Sizes of the upcoming segments of every representation, for algorithms looking ahead.
+   *
+   * window[r][j] is set to the size in bytes of segment first + j in representation r. The vectors keep
+   * their capacity, so a window reused across decisions does not allocate.
+   * \param first the first segment of the window, usually the one about to be requested
+   * \param count the number of segments of the window
+   * \return the number of segments in the window, fewer than count at the end of the stream
+   */
+  int64_t GetSizeWindow (int64_t first, int64_t count, std::vector<std::vector<int64_t> > & window) const;
+
   const videoData & m_videoData;
   const bufferData & m_bufferData;
   const throughputData & m_throughput;
   const playbackData & m_playbackData;
+  const assistanceData * m_assistance; //!< Bitrate hints of the client, null if none are available
 };
 } // namespace ns3
 
@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-availability-notifier.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamAvailabilityNotifier");
+
+typedef std::map<std::pair<std::string, int64_t>, Ptr<TcpStreamAvailabilityNotifier> > notifierMap;
+
+static notifierMap &
+GetStreams ()
+{
+  static notifierMap streams;
+  return streams;
+}
+
+TcpStreamAvailabilityNotifier::TcpStreamAvailabilityNotifier ()
+  : m_nextId (0),
+    m_eventTime (0),
+    m_notifying (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpStreamAvailabilityNotifier::~TcpStreamAvailabilityNotifier ()
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+}
+
+Ptr<TcpStreamAvailabilityNotifier>
+TcpStreamAvailabilityNotifier::GetStream (const std::string & segmentSizeFile, int64_t segmentDuration)
+{
+  notifierMap & streams = GetStreams ();
+  if (streams.empty ())
+    {
+      // the notifiers hold events of this simulation, a following simulation starts with new ones
+      Simulator::ScheduleDestroy (&TcpStreamAvailabilityNotifier::Clear);
+    }
+  Ptr<TcpStreamAvailabilityNotifier> & notifier = streams[std::make_pair (segmentSizeFile, segmentDuration)];
+  if (notifier == 0)
+    {
+      notifier = Create<TcpStreamAvailabilityNotifier> ();
+    }
+  return notifier;
+}
+
+void
+TcpStreamAvailabilityNotifier::Clear ()
+{
+  GetStreams ().clear ();
+}
+
+TcpStreamAvailabilityNotifier::waitId
+TcpStreamAvailabilityNotifier::Wait (Time at, Callback<void> callback, Time paceWindow)
+{
+  NS_LOG_FUNCTION (this << at << paceWindow);
+  waitId id (at.GetTimeStep (), m_nextId++);
+  waiter & w = m_waiters[id];
+  w.callback = callback;
+  w.paceWindow = paceWindow.GetTimeStep ();
+  if (!m_notifying)
+    {
+      ScheduleNext ();
+    }
+  return id;
+}
+
+void
+TcpStreamAvailabilityNotifier::Cancel (const waitId & id)
+{
+  NS_LOG_FUNCTION (this);
+  // a stale event finds no one to wake and reschedules itself for the next waiting client
+  if (m_waiters.erase (id) == 0)
+    {
+      // paced clients keep their arrival number but were moved to their release time
+      for (std::map<waitId, waiter>::iterator it = m_waiters.begin (); it != m_waiters.end (); ++it)
+        {
+          if (it->first.second == id.second)
+            {
+              m_waiters.erase (it);
+              return;
+            }
+        }
+    }
+}
+
+uint32_t
+TcpStreamAvailabilityNotifier::GetWaiting () const
+{
+  return m_waiters.size ();
+}
+
+void
+TcpStreamAvailabilityNotifier::ScheduleNext ()
+{
+  if (m_waiters.empty ())
+    {
+      return;
+    }
+  int64_t next = m_waiters.begin ()->first.first;
+  if (m_event.IsRunning () && m_eventTime <= next)
+    {
+      return;
+    }
+  m_event.Cancel ();
+  m_eventTime = next;
+  m_event = Simulator::Schedule (TimeStep (next) - Simulator::Now (), &TcpStreamAvailabilityNotifier::Notify, this);
+}
+
+void
+TcpStreamAvailabilityNotifier::Notify ()
+{
+  NS_LOG_FUNCTION (this);
+  int64_t now = Simulator::Now ().GetTimeStep ();
+
+  // spread the paced clients due now over their window
+  std::vector<std::map<waitId, waiter>::iterator> paced;
+  for (std::map<waitId, waiter>::iterator it = m_waiters.begin (); it != m_waiters.end () && it->first.first <= now; ++it)
+    {
+      if (it->second.paceWindow > 0)
+        {
+          paced.push_back (it);
+        }
+    }
+  for (uint32_t i = 0; i < paced.size (); i++)
+    {
+      waiter w = paced[i]->second;
+      waitId id (now + w.paceWindow * i / (int64_t) paced.size (), paced[i]->first.second);
+      m_waiters.erase (paced[i]);
+      w.paceWindow = 0;
+      m_waiters[id] = w;
+    }
+
+  m_notifying = true;
+  // clients may start waiting again while they are woken, those due now are woken in this loop as well
+  while (!m_waiters.empty () && m_waiters.begin ()->first.first <= now)
+    {
+      Callback<void> callback = m_waiters.begin ()->second.callback;
+      m_waiters.erase (m_waiters.begin ());
+      callback ();
+    }
+  m_notifying = false;
+  ScheduleNext ();
+}
+
+} // namespace ns3
@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_AVAILABILITY_NOTIFIER_H
+#define TCP_STREAM_AVAILABILITY_NOTIFIER_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <utility>
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Wakes the clients of a live stream that wait for the availability of a segment.
+ *
+ * Synchronised live clients wait for the same availability instants. Instead of one simulator event per
+ * waiting client, the notifier keeps the waiting clients ordered by wake-up time and has at most one event
+ * scheduled, for the earliest of them. All clients due at that time are woken from this event in the order
+ * they started waiting, which is the order their own events would have had. With request jitter, wake-up
+ * times differ per client, but the simulator queue still holds a single event per stream.
+ */
+class TcpStreamAvailabilityNotifier : public SimpleRefCount<TcpStreamAvailabilityNotifier>
+{
+public:
+  /**
+   * \brief Identifies a waiting client, to cancel its wake-up.
+   */
+  typedef std::pair<int64_t, uint64_t> waitId;
+
+  TcpStreamAvailabilityNotifier ();
+  ~TcpStreamAvailabilityNotifier ();
+
+  /**
+   * \brief Get the notifier shared by all clients streaming the given segment size file with the given
+   * segment duration. The notifiers are dropped at Simulator::Destroy.
+   */
+  static Ptr<TcpStreamAvailabilityNotifier> GetStream (const std::string & segmentSizeFile, int64_t segmentDuration);
+
+  /**
+   * \brief Invoke the callback at the given (absolute) time.
+   *
+   * With a pace window, the clients paced for the same time are not woken at once: the n clients due at
+   * that time are released one after the other, evenly spread over the window, in the order they started
+   * waiting.
+   *
+   * \return the id to cancel the wake-up with
+   */
+  waitId Wait (Time at, Callback<void> callback, Time paceWindow = Time (0));
+
+  /**
+   * \brief Cancel a wake-up, nothing happens if it already took place.
+   */
+  void Cancel (const waitId & id);
+
+  /**
+   * \return the number of clients waiting
+   */
+  uint32_t GetWaiting () const;
+
+private:
+  /**
+   * \brief Wake all clients due now and schedule the event for the next wake-up time.
+   */
+  void Notify ();
+  void ScheduleNext ();
+
+  static void Clear ();
+
+  /**
+   * \brief A waiting client.
+   */
+  struct waiter
+  {
+    Callback<void> callback; //!< Wakes the client
+    int64_t paceWindow; //!< Window in time steps the client is paced over, 0 if woken at its time
+  };
+
+  std::map<waitId, waiter> m_waiters; //!< Waiting clients by wake-up time (in time steps) and arrival
+  uint64_t m_nextId; //!< Arrival counter, keeps the wake-up order of clients due at the same time
+  EventId m_event; //!< The single scheduled wake-up event
+  int64_t m_eventTime; //!< Time of m_event in time steps
+  bool m_notifying; //!< Set while clients are woken, rescheduling waits until all are done
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_AVAILABILITY_NOTIFIER_H */
@@ -26,8 +26,10 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/enum.h"
 #include "ns3/trace-source-accessor.h"
 #include "tcp-stream-client.h"
+#include <algorithm>
 #include <math.h>
 #include <sstream>
 #include <stdexcept>
@@ -35,8 +37,12 @@
 #include "ns3/global-value.h"
 #include <ns3/core-module.h>
 #include "tcp-stream-server.h"
+#include "tcp-stream-profiler.h"
+#include "tcp-stream-multicast.h"
+#include "tcp-stream-segment-sizes.h"
 #include <unistd.h>
 #include <iterator>
+#include <map>
 #include <numeric>
 #include <iomanip>
 #include <ctime>
@@ -59,15 +65,19 @@ NS_LOG_COMPONENT_DEFINE ("TcpStreamClientApplication");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpStreamClient);
 
+// names of the controller events, for profiling
+static const char * const controllerEventNames[] = {"downloadFinished", "playbackFinished", "irdFinished", "init", "delayedSend"};
+
 void TcpStreamClient::Controller (controllerEvent event)
 {
   NS_LOG_FUNCTION (this);
+  DashProfilerScope profile ("Controller", controllerEventNames[event]);
   
   //Delay segment requests to simulate live dash streaming where segments become available periodically
   if(event == delayedSend)
   {
     RequestRepIndex ();
-    Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
+    SendRequest ();
     return;
   }
   
@@ -75,33 +85,33 @@ void TcpStreamClient::Controller (controllerEvent event)
     {
       state = downloading;
 
-	  controllerEvent ev = delayedSend;
-    Time delay = MicroSeconds(getAvailabilityTime(m_segmentCounter)-Simulator::Now ().GetMicroSeconds ());
-	  if(delay <= 0) {
-      RequestRepIndex ();
-		  Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
-	  } else {
-		  Simulator::Schedule (delay, &TcpStreamClient::Controller, this, ev);
-	  }
+      RequestWhenAvailable ();
       return;
     }
 
   if (state == downloading)
     {
+      if (!AdditionalSetsReady (m_currentPlaybackIndex))
+        {
+          // an additional adaptation set without the segment holds playback, ResumePlayback starts it later
+          if (m_segmentCounter + 1 < m_lastSegmentIndex)
+            {
+              m_segmentCounter++;
+              RequestWhenAvailable ();
+            }
+          else
+            {
+              state = playing;
+            }
+          return;
+        }
       PlaybackHandle ();
       if (m_currentPlaybackIndex <= m_lastSegmentIndex)
         {
           /*  e_d  */
           m_segmentCounter++;
           state = downloadingPlaying;
-          controllerEvent ev = delayedSend;
-          Time delay = MicroSeconds(getAvailabilityTime(m_segmentCounter)-Simulator::Now ().GetMicroSeconds ());
-          if(delay <= 0) {
-            RequestRepIndex ();
-            Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
-          } else {
-            Simulator::Schedule (delay, &TcpStreamClient::Controller, this, ev);
-          }
+          RequestWhenAvailable ();
         }
       else
         {
@@ -109,7 +119,7 @@ void TcpStreamClient::Controller (controllerEvent event)
           state = playing;
         }
       controllerEvent ev = playbackFinished;
-      Simulator::Schedule (MicroSeconds (m_videoData.segmentDuration), &TcpStreamClient::Controller, this, ev);
+      m_playbackEvent = Simulator::Schedule (MicroSeconds (m_videoData->GetSegmentDuration (m_currentPlaybackIndex - 1)), &TcpStreamClient::Controller, this, ev);
       return;
     }
 
@@ -129,7 +139,7 @@ void TcpStreamClient::Controller (controllerEvent event)
               state = playing;
               controllerEvent ev = irdFinished;
 
-              Simulator::Schedule (MicroSeconds (m_bDelay), &TcpStreamClient::Controller, this, ev);
+              m_requestEvent = Simulator::Schedule (MicroSeconds (m_bDelay), &TcpStreamClient::Controller, this, ev);
             }
           else if (m_segmentCounter == m_lastSegmentIndex)
             {
@@ -139,14 +149,7 @@ void TcpStreamClient::Controller (controllerEvent event)
           else
             {
               /*  e_d  */
-              controllerEvent ev = delayedSend;
-              Time delay = MicroSeconds(getAvailabilityTime(m_segmentCounter)-Simulator::Now ().GetMicroSeconds ());
-              if(delay <= 0) {
-                RequestRepIndex ();
-                Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
-              } else {
-                Simulator::Schedule (delay, &TcpStreamClient::Controller, this, ev);
-              }      
+              RequestWhenAvailable ();
             }
         }
       else if (event == playbackFinished)
@@ -155,7 +158,7 @@ void TcpStreamClient::Controller (controllerEvent event)
             {
               /*  e_pb  */
               controllerEvent ev = playbackFinished;
-              Simulator::Schedule (MicroSeconds (m_videoData.segmentDuration), &TcpStreamClient::Controller, this, ev);
+              m_playbackEvent = Simulator::Schedule (MicroSeconds (m_videoData->GetSegmentDuration (m_currentPlaybackIndex - 1)), &TcpStreamClient::Controller, this, ev);
             }
           else
             {
@@ -173,21 +176,14 @@ void TcpStreamClient::Controller (controllerEvent event)
         {
           /*  e_irc  */
           state = downloadingPlaying;
-          controllerEvent ev = delayedSend;
-          Time delay = MicroSeconds(getAvailabilityTime(m_segmentCounter)-Simulator::Now ().GetMicroSeconds ());
-          if(delay <= 0) {
-            RequestRepIndex ();
-            Send (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
-          } else {
-            Simulator::Schedule (delay, &TcpStreamClient::Controller, this, ev);
-          }
+          RequestWhenAvailable ();
         }
       else if (event == playbackFinished && m_currentPlaybackIndex < m_lastSegmentIndex)
         {
           /*  e_pb  */
           PlaybackHandle ();
           controllerEvent ev = playbackFinished;
-          Simulator::Schedule (MicroSeconds (m_videoData.segmentDuration), &TcpStreamClient::Controller, this, ev);
+          m_playbackEvent = Simulator::Schedule (MicroSeconds (m_videoData->GetSegmentDuration (m_currentPlaybackIndex - 1)), &TcpStreamClient::Controller, this, ev);
         }
       else if (event == playbackFinished && m_currentPlaybackIndex == m_lastSegmentIndex)
         {
@@ -198,11 +194,63 @@ void TcpStreamClient::Controller (controllerEvent event)
           log_QoE();
 
           StopApplication ();
+          if (!m_sessionEndCallback.IsNull ())
+            {
+              m_sessionEndCallback (this);
+            }
         }
       return;
     }
 }
 
+void TcpStreamClient::RequestWhenAvailable ()
+{
+  NS_LOG_FUNCTION (this);
+  int64_t available = (int64_t) getAvailabilityTime (m_segmentCounter);
+  if (available <= Simulator::Now ().GetMicroSeconds ())
+    {
+      RequestRepIndex ();
+      SendRequest ();
+      return;
+    }
+  // wait for the segment together with all clients of the stream, optionally spread over the request window
+  Time at = MicroSeconds (available);
+  Time paceWindow = Seconds (0);
+  if (!m_requestJitter.IsZero ())
+    {
+      switch (m_requestTiming)
+        {
+        case randomJitter:
+          at += NanoSeconds ((int64_t) m_jitter->GetValue (0, m_requestJitter.GetNanoSeconds ()));
+          break;
+        case clientOffset:
+          at += NanoSeconds (m_requestJitter.GetNanoSeconds () * (int64_t) (m_clientId % std::max (m_numberOfClients, (uint32_t) 1)) / std::max (m_numberOfClients, (uint32_t) 1));
+          break;
+        case paced:
+          paceWindow = m_requestJitter;
+          break;
+        }
+    }
+  m_availabilityWait = m_availability->Wait (at, MakeCallback (&TcpStreamClient::AvailabilityReached, this), paceWindow);
+  m_waitingForAvailability = true;
+}
+
+void TcpStreamClient::AvailabilityReached ()
+{
+  NS_LOG_FUNCTION (this);
+  m_waitingForAvailability = false;
+  Controller (delayedSend);
+}
+
+void TcpStreamClient::CancelAvailabilityWait ()
+{
+  if (m_waitingForAvailability)
+    {
+      m_availability->Cancel (m_availabilityWait);
+      m_waitingForAvailability = false;
+    }
+}
+
 TypeId TcpStreamClient::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::TcpStreamClient")
@@ -229,6 +277,11 @@ TypeId TcpStreamClient::GetTypeId (void)
                    StringValue ("bitrates.txt"),
                    MakeStringAccessor (&TcpStreamClient::m_segmentSizeFilePath),
                    MakeStringChecker ())
+    .AddAttribute ("AdditionalSegmentSizeFiles",
+                   "Comma separated segment size files of further adaptation sets (e.g. audio) on the segment grid of the video, each downloaded concurrently over a connection of its own; playback stalls when any set runs dry",
+                   StringValue (""),
+                   MakeStringAccessor (&TcpStreamClient::m_additionalSetFiles),
+                   MakeStringChecker ())
     .AddAttribute ("SimulationId",
                    "The ID of the current simulation, for logging purposes",
                    UintegerValue (0),
@@ -238,7 +291,7 @@ TypeId TcpStreamClient::GetTypeId (void)
                    "The total number of clients for this simulation, for logging purposes",
                    UintegerValue (1),
                    MakeUintegerAccessor (&TcpStreamClient::m_numberOfClients),
-                   MakeUintegerChecker<uint16_t> ())
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("ClientId",
                    "The ID of the this client object, for logging purposes",
                    UintegerValue (0),
@@ -260,10 +313,123 @@ TypeId TcpStreamClient::GetTypeId (void)
                    MakeUintegerAccessor (&TcpStreamClient::cmaf),
                    MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("LogLevel",
-                   "Logging level: 0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency",
+                   "Logging level: 0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency, 3: No log files, use the trace sources",
                    UintegerValue (0),
                    MakeUintegerAccessor (&TcpStreamClient::logLevel),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("AvailabilityOffset",
+                   "Point in time at which the first segment of the stream became available, for clients joining a live stream late",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TcpStreamClient::m_availabilityOffset),
+                   MakeTimeChecker ())
+    .AddAttribute ("RequestJitter",
+                   "Window after the availability of a segment over which waiting requests are spread, see RequestTiming",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TcpStreamClient::m_requestJitter),
+                   MakeTimeChecker ())
+    .AddAttribute ("RequestTiming",
+                   "How requests are spread over the RequestJitter window: Random: uniformly at random, Offset: by a fixed offset per client id (ClientId / NumberOfClients of the window), Paced: the clients waiting for a segment are released evenly over the window",
+                   EnumValue (TcpStreamClient::randomJitter),
+                   MakeEnumAccessor (&TcpStreamClient::m_requestTiming),
+                   MakeEnumChecker (TcpStreamClient::randomJitter, "Random",
+                                    TcpStreamClient::clientOffset, "Offset",
+                                    TcpStreamClient::paced, "Paced"))
+    .AddAttribute ("ServerSelection",
+                   "How the server of every request is chosen among the servers added with AddServer: RoundRobin: in turn, starting at the client id, Weighted: at random in proportion to the server weights, Rtt: lowest smoothed time from request to first byte, Throughput: highest smoothed segment throughput (Rtt and Throughput try every server once first)",
+                   EnumValue (TcpStreamClient::roundRobinServers),
+                   MakeEnumAccessor (&TcpStreamClient::m_serverSelection),
+                   MakeEnumChecker (TcpStreamClient::roundRobinServers, "RoundRobin",
+                                    TcpStreamClient::weightedServers, "Weighted",
+                                    TcpStreamClient::lowestRtt, "Rtt",
+                                    TcpStreamClient::highestThroughput, "Throughput"))
+    .AddAttribute ("RequestTimeout",
+                   "A request whose answer makes no progress for this long is repeated on another server, 0 to only fail over when the connection breaks",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TcpStreamClient::m_requestTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("ServerRetryInterval",
+                   "How long a failed server is skipped before it is tried again",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&TcpStreamClient::m_serverRetry),
+                   MakeTimeChecker ())
+    .AddAttribute ("AssistancePort",
+                   "UDP port on which bitrate hints of the server (or the network) are received and handed to the adaptation algorithm, 0 for none",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TcpStreamClient::m_assistancePort),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("MulticastAddress",
+                   "Address of a multicast replicator: segments are taken from the group of their representation and only missing bytes are requested from the server; unset to request every segment from the server",
+                   AddressValue (),
+                   MakeAddressAccessor (&TcpStreamClient::m_multicastAddress),
+                   MakeAddressChecker ())
+    .AddAttribute ("MulticastControlPort",
+                   "Port on which the multicast replicator accepts subscriptions",
+                   UintegerValue (5000),
+                   MakeUintegerAccessor (&TcpStreamClient::m_multicastControlPort),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("RepairTimeout",
+                   "The missing bytes of a segment awaited from a multicast group are requested from the server once the group delivered nothing of it for this long",
+                   TimeValue (MilliSeconds (500)),
+                   MakeTimeAccessor (&TcpStreamClient::m_repairTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("RecordAbrInputs",
+                   "Record the inputs of every adaptation decision into a binary trace that can be replayed offline",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpStreamClient::m_recordAbrInputs),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RecordHistograms",
+                   "Record live latency, stall duration, download time and time to first byte into log-linear histograms",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpStreamClient::m_recordHistograms),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("BufferLevel",
+                     "The buffer level changed",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_bufferLevelTrace),
+                     "ns3::TcpStreamClient::BufferLevelCallback")
+    .AddTraceSource ("Representation",
+                     "The representation of the next segment was chosen",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_representationTrace),
+                     "ns3::TcpStreamClient::RepresentationCallback")
+    .AddTraceSource ("DownloadStart",
+                     "The first byte of a segment arrived",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_downloadStartTrace),
+                     "ns3::TcpStreamClient::DownloadStartCallback")
+    .AddTraceSource ("DownloadEnd",
+                     "A segment was downloaded completely",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_downloadEndTrace),
+                     "ns3::TcpStreamClient::DownloadEndCallback")
+    .AddTraceSource ("StallStart",
+                     "Playback stalled because the buffer ran empty",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_stallStartTrace),
+                     "ns3::TcpStreamClient::StallStartCallback")
+    .AddTraceSource ("StallEnd",
+                     "Playback resumed after a stall",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_stallEndTrace),
+                     "ns3::TcpStreamClient::StallEndCallback")
+    .AddTraceSource ("LiveLatency",
+                     "Playback of a segment started, with its live latency",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_liveLatencyTrace),
+                     "ns3::TcpStreamClient::LiveLatencyCallback")
+    .AddTraceSource ("ThroughputEstimate",
+                     "The throughput measured for the last downloaded segment",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_throughputTrace),
+                     "ns3::TcpStreamClient::ThroughputEstimateCallback")
+    .AddTraceSource ("Failover",
+                     "A request was repeated on another server and its answer started to arrive",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_failoverTrace),
+                     "ns3::TcpStreamClient::FailoverCallback")
+    .AddTraceSource ("AssistanceHint",
+                     "A bitrate hint arrived on the assistance channel",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_assistanceTrace),
+                     "ns3::TcpStreamClient::AssistanceHintCallback")
+    .AddTraceSource ("MulticastRepair",
+                     "Bytes of a segment missed from its multicast group were requested from the server",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_repairTrace),
+                     "ns3::TcpStreamClient::MulticastRepairCallback")
+    .AddTraceSource ("AdaptationSetDownloadEnd",
+                     "A segment of an additional adaptation set was downloaded completely",
+                     MakeTraceSourceAccessor (&TcpStreamClient::m_setDownloadEndTrace),
+                     "ns3::TcpStreamClient::AdaptationSetDownloadEndCallback")
   ;
   return tid;
 }
@@ -271,10 +437,10 @@ TypeId TcpStreamClient::GetTypeId (void)
 TcpStreamClient::TcpStreamClient ()
 {
   NS_LOG_FUNCTION (this);
-  m_socket = 0;
   m_data = 0;
   m_dataSize = 0;
   state = initial;
+  algo = NULL;
 
   m_currentRepIndex = 0;
   m_segmentCounter = 0;
@@ -290,6 +456,31 @@ TcpStreamClient::TcpStreamClient ()
   playbackStart = -1;
 
   logLevel = 0;
+  m_recordAbrInputs = false;
+  m_recordHistograms = false;
+  m_jitter = CreateObject<UniformRandomVariable> ();
+  m_requestTiming = randomJitter;
+  m_waitingForAvailability = false;
+  m_currentServer = 0;
+  m_serverChosen = false;
+  m_nextServer = 0;
+  m_serverSelection = roundRobinServers;
+  m_running = false;
+  m_controllerStarted = false;
+  m_requestOutstanding = false;
+  m_requestPending = false;
+  m_serverRequestSent = 0;
+  m_lastProgress = 0;
+  m_failingOver = false;
+  m_failedServer = 0;
+  m_outageStart = 0;
+  m_assistancePort = 0;
+  m_multicastControlPort = 5000;
+  m_joinedRep = -1;
+  m_multicastWait = false;
+  m_requestOffset = 0;
+  m_additionalBytes = 0;
+  m_additionalBytesAtRequest = 0;
 
   stallsTotal = 0;
   stallsTime = 0.0;
@@ -298,78 +489,128 @@ TcpStreamClient::TcpStreamClient ()
   m_bufferData.bufferLevelNew.push_back (0);
 }
 
-void TcpStreamClient::Initialise (std::string algorithm, uint16_t clientId)
+void TcpStreamClient::Initialise (const std::string &algorithm, uint32_t clientId)
 {
   NS_LOG_FUNCTION (this);
-  m_videoData.segmentDuration = m_segmentDuration;
-  if (ReadInBitrateValues (ToString (m_segmentSizeFilePath)) == -1)
+  m_videoData = LoadVideoData (m_segmentSizeFilePath, m_segmentDuration);
+  if (!m_videoData)
+    {
+      NS_FATAL_ERROR ("Opening test bitrate file failed. Terminating.");
+    }
+  m_lastSegmentIndex = (int64_t) m_videoData->segmentSize.at (0).size ();
+  m_highestRepIndex = m_videoData->averageBitrate.size () - 1;
+  algo = CreateAdaptationAlgorithm (algorithm, *m_videoData, m_playbackData, m_bufferData, m_throughput, chunk, cmaf);
+  if (algo == NULL)
+    {
+      NS_FATAL_ERROR ("Invalid algorithm name entered. Terminating.");
+    }
+  algo->SetAssistanceData (m_assistanceData);
+
+  std::istringstream setFiles (m_additionalSetFiles);
+  std::string setFile;
+  while (std::getline (setFiles, setFile, ','))
+    {
+      adaptationSet set;
+      set.data = LoadVideoData (setFile, m_segmentDuration);
+      if (!set.data)
+        {
+          NS_FATAL_ERROR ("Opening segment size file " << setFile << " of an additional adaptation set failed. Terminating.");
+        }
+      if ((int64_t) set.data->segmentSize.at (0).size () < m_lastSegmentIndex)
+        {
+          NS_FATAL_ERROR ("The additional adaptation set " << setFile << " has fewer segments than the video. Terminating.");
+        }
+      set.server = 0;
+      set.connected = false;
+      set.downloading = false;
+      set.segmentCounter = 0;
+      set.repIndex = 0;
+      set.bytesReceived = 0;
+      m_additionalSets.push_back (set);
+    }
+
+  m_algoName = algorithm;
+  m_availability = TcpStreamAvailabilityNotifier::GetStream (m_segmentSizeFilePath, m_segmentDuration);
+
+  InitializeLogFiles (ToString (m_simulationId), ToString (m_clientId), ToString (m_numberOfClients));
+
+  if (m_recordAbrInputs)
     {
-      NS_LOG_ERROR ("Opening test bitrate file failed. Terminating.\n");
-      Simulator::Stop ();
-      Simulator::Destroy ();
+      abrTraceHeader header;
+      header.clientId = m_clientId;
+      header.segmentDuration = m_videoData->segmentDuration;
+      header.chunk = chunk;
+      header.cmaf = cmaf;
+      header.algorithm = m_algoName;
+      header.segmentSizeFile = m_segmentSizeFilePath;
+      std::string traceFile = dashLogDirectory + "/SimID_" + ToString (m_simulationId) + "/" + "client" + ToString (m_clientId) + "_" + "abrInputs.bin";
+      if (!m_abrTrace.Open (traceFile, header))
+        {
+          NS_LOG_ERROR ("Opening ABR input trace " << traceFile << " failed.");
+        }
+    }
+
+}
+
+AdaptationAlgorithm *
+TcpStreamClient::CreateAdaptationAlgorithm (std::string algorithm,
+                                            const videoData & videoData,
+                                            const playbackData & playbackData,
+                                            const bufferData & bufferData,
+                                            const throughputData & throughput,
+                                            int64_t chunk, int cmaf)
+{
+  int tempChunk = chunk;
+  if (cmaf == 0)
+    {
+      tempChunk = 0;
     }
-  m_lastSegmentIndex = (int64_t) m_videoData.segmentSize.at (0).size ();
-  m_highestRepIndex = m_videoData.averageBitrate.size () - 1;
   if (algorithm == "tobasco")
     {
-      algo = new TobascoAlgorithm (m_videoData, m_playbackData, m_bufferData, m_throughput);
+      return new TobascoAlgorithm (videoData, playbackData, bufferData, throughput);
     }
   else if (algorithm == "panda")
     {
-      int tempChunk = chunk;
-      if(cmaf == 0) { tempChunk = 0; }
-      algo = new PandaAlgorithm (m_videoData, m_playbackData, m_bufferData, m_throughput, tempChunk, cmaf);
+      return new PandaAlgorithm (videoData, playbackData, bufferData, throughput, tempChunk, cmaf);
     }
   else if (algorithm == "festive")
     {
-      int tempChunk = chunk;
-      if(cmaf == 0) { tempChunk = 0; }
-      algo = new FestiveAlgorithm (m_videoData, m_playbackData, m_bufferData, m_throughput, tempChunk, cmaf);
+      return new FestiveAlgorithm (videoData, playbackData, bufferData, throughput, tempChunk, cmaf);
     }
   else if (algorithm == "liveabr")
     {
-      int tempChunk = chunk;
-      if(cmaf == 0) { tempChunk = 0; }
-      algo = new LiveABR (m_videoData, m_playbackData, m_bufferData, m_throughput, tempChunk, cmaf);
+      return new LiveABR (videoData, playbackData, bufferData, throughput, tempChunk, cmaf);
     }
   else if (algorithm == "simple")
     {
-      algo = new SimpleAlgo (m_videoData, m_playbackData, m_bufferData, m_throughput);
+      return new SimpleAlgo (videoData, playbackData, bufferData, throughput);
     }
   else if (algorithm == "simpleBuffer")
     {
-      algo = new SimpleBufferAlgo (m_videoData, m_playbackData, m_bufferData, m_throughput);
+      return new SimpleBufferAlgo (videoData, playbackData, bufferData, throughput);
     }
   else if (algorithm == "mpc")
     {
-      int tempChunk = chunk;
-      if(cmaf == 0) { tempChunk = 0; }
-      algo = new MPCAlgo (m_videoData, m_playbackData, m_bufferData, m_throughput, tempChunk, cmaf);
+      return new MPCAlgo (videoData, playbackData, bufferData, throughput, tempChunk, cmaf);
     }
   else if (algorithm == "bola")
     {
-      int tempChunk = chunk;
-      if(cmaf == 0) { tempChunk = 0; }
-      algo = new BolaAlgo (m_videoData, m_playbackData, m_bufferData, m_throughput, tempChunk, cmaf);
+      return new BolaAlgo (videoData, playbackData, bufferData, throughput, tempChunk, cmaf);
     }
-  else
+  else if (algorithm == "mpcvbr")
     {
-      NS_LOG_ERROR ("Invalid algorithm name entered. Terminating.");
-      StopApplication ();
-      Simulator::Stop ();
-      Simulator::Destroy ();
+      return new MPCAlgo (videoData, playbackData, bufferData, throughput, tempChunk, cmaf, true);
     }
-
-  m_algoName = algorithm;
-
-  InitializeLogFiles (ToString (m_simulationId), ToString (m_clientId), ToString (m_numberOfClients));
-
+  else if (algorithm == "bolavbr")
+    {
+      return new BolaAlgo (videoData, playbackData, bufferData, throughput, tempChunk, cmaf, true);
+    }
+  return NULL;
 }
 
 TcpStreamClient::~TcpStreamClient ()
 {
   NS_LOG_FUNCTION (this);
-  m_socket = 0;
 
   delete algo;
   algo = NULL;
@@ -382,9 +623,11 @@ void TcpStreamClient::RequestRepIndex ()
 {
   NS_LOG_FUNCTION (this);
   algorithmReply answer;
+  bool algorithmDecided = true;
   if(chunk == 0 || m_segmentCounter == 0) {
     
     // Segments have no chunks OR it's the first chunk of the first segment
+    DashProfilerScope profile ("GetNextRep", m_algoName.c_str ());
     answer = algo->GetNextRep ( m_segmentCounter, m_clientId );  
   } else {
     
@@ -393,11 +636,13 @@ void TcpStreamClient::RequestRepIndex ()
     if(remainder == 0) {
       
       // This is the first chunk of a new segment, allow quality change
+      DashProfilerScope profile ("GetNextRep", m_algoName.c_str ());
       answer = algo->GetNextRep ( m_segmentCounter, m_clientId );    
     } else {
       
       // This is the next chunk of the current segment, no quality change allowed - keep previous quality level
       
+      algorithmDecided = false;
       answer.nextRepIndex = m_playbackData.playbackIndex.at (m_segmentCounter-1);
       answer.nextDownloadDelay = 0;
       answer.decisionTime = Simulator::Now().GetMicroSeconds();
@@ -408,9 +653,14 @@ void TcpStreamClient::RequestRepIndex ()
       answer.secondBandwidthEstimate = 0;
     }
   }
+  if (algorithmDecided && m_abrTrace.IsOpen ())
+    {
+      m_abrTrace.Record (m_segmentCounter, Simulator::Now ().GetMicroSeconds (), m_throughput, m_bufferData, m_playbackData, answer);
+    }
   m_currentRepIndex = answer.nextRepIndex;
   NS_ASSERT_MSG (answer.nextRepIndex <= m_highestRepIndex, "The algorithm returned a representation index that's higher than the maximum");
   m_playbackData.playbackIndex.push_back (answer.nextRepIndex);
+  m_representationTrace (m_clientId, m_segmentCounter, answer.nextRepIndex);
   m_bDelay = answer.nextDownloadDelay;
   LogAdaptation (answer);
   
@@ -422,40 +672,111 @@ void TcpStreamClient::Send (T & message)
   NS_LOG_FUNCTION (this);
   PreparePacket (message);
   Ptr<Packet> p;
-  p = Create<Packet> (m_data, m_dataSize);
   m_downloadRequestSent = Simulator::Now ().GetMicroSeconds ();
-  m_socket->Send (p);
+  m_requestOutstanding = true;
+  if (!m_serverChosen)
+    {
+      int32_t server = SelectServer ();
+      if (server < 0)
+        {
+          // every server failed recently, the request waits for the first one to be retried
+          ResumeAfterFailover ();
+          return;
+        }
+      m_currentServer = server;
+    }
+  m_serverChosen = false;
+  SendToServer ();
+}
+
+void TcpStreamClient::SendRequest ()
+{
+  NS_LOG_FUNCTION (this);
+  // the additional sets download alongside, their bytes count into the throughput of this segment
+  m_additionalBytesAtRequest = m_additionalBytes;
+  ScheduleAdditionalSets ();
+  if (m_multicastSocket != 0)
+    {
+      RequestFromGroup ();
+      return;
+    }
+  m_requestOffset = 0;
+  // the server only reads the size, caches identify the segment by the indices following it
+  std::ostringstream request;
+  request << m_videoData->segmentSize.at (m_currentRepIndex).at (m_segmentCounter) << " " << m_segmentCounter << " " << m_currentRepIndex;
+  std::string message = request.str ();
+  Send (message);
 }
 
 void TcpStreamClient::HandleRead (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
   Ptr<Packet> packet;
+  if (FindServer (socket) != (int32_t) m_currentServer || !m_requestOutstanding || m_multicastWait)
+    {
+      // left over of a server the client failed over from
+      while ((packet = socket->Recv ()))
+        {
+        }
+      return;
+    }
+  m_lastProgress = Simulator::Now ().GetMicroSeconds ();
+  if (!m_requestTimeout.IsZero ())
+    {
+      m_timeoutEvent.Cancel ();
+      m_timeoutEvent = Simulator::Schedule (m_requestTimeout, &TcpStreamClient::RequestTimedOut, this);
+    }
+  if (m_bytesReceived == m_requestOffset)
+    {
+      // time to first byte of the current server, smoothed like the TCP round trip time
+      streamServer & server = m_servers.at (m_currentServer);
+      double rtt = Simulator::Now ().GetMicroSeconds () - (int64_t) m_serverRequestSent;
+      server.rtt = server.rtt < 0 ? rtt : 0.875 * server.rtt + 0.125 * rtt;
+      if (m_failingOver)
+        {
+          m_failingOver = false;
+          m_failoverTrace (m_clientId, m_failedServer, m_currentServer, MicroSeconds (Simulator::Now ().GetMicroSeconds () - m_outageStart));
+        }
+    }
   if (m_bytesReceived == 0)
     {
       m_transmissionStartReceivingSegment = Simulator::Now ().GetMicroSeconds ();
+      m_downloadStartTrace (m_clientId, m_segmentCounter, m_currentRepIndex, m_videoData->segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
+      if (m_recordHistograms)
+        {
+          m_histograms.firstByteTime.Record (m_transmissionStartReceivingSegment - (int64_t) m_downloadRequestSent);
+        }
     }
   uint32_t packetSize;
   while ( (packet = socket->Recv ()) )
     {
       packetSize = packet->GetSize ();
       m_bytesReceived += packetSize;
-      if (m_bytesReceived == m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter))
+      if (m_bytesReceived == m_videoData->segmentSize.at (m_currentRepIndex).at (m_segmentCounter))
         {
           SegmentReceivedHandle ();
         }
     }
 }
 
-int TcpStreamClient::ReadInBitrateValues (std::string segmentSizeFile)
+int TcpStreamClient::ReadInBitrateValues (std::string segmentSizeFile, videoData & videoData)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (segmentSizeFile);
+  if (SegmentSizeGenerator::IsSpecification (segmentSizeFile))
+    {
+      return SegmentSizeGenerator::Load (segmentSizeFile, videoData);
+    }
+  if (SegmentSizeMappedFile::IsBinary (segmentSizeFile))
+    {
+      return SegmentSizeMappedFile::Load (segmentSizeFile, videoData);
+    }
   std::ifstream myfile;
   myfile.open (segmentSizeFile.c_str ());
   if (!myfile)
     {
       return -1;
     }
+  std::shared_ptr<SegmentSizeMemory> sizes = std::make_shared<SegmentSizeMemory> ();
   std::string temp;
   while (std::getline (myfile, temp))
     {
@@ -464,21 +785,81 @@ int TcpStreamClient::ReadInBitrateValues (std::string segmentSizeFile)
           break;
         }
       std::istringstream buffer (temp);
+      // an optional line "durations d0 d1 ..." gives every segment its own duration in microseconds
+      std::string keyword;
+      if (temp.compare (0, 9, "durations") == 0)
+        {
+          buffer >> keyword;
+          std::vector<int64_t> durations ((std::istream_iterator<int64_t> (buffer)),
+                                          std::istream_iterator<int64_t>());
+          videoData.segmentStart.assign (1, 0);
+          for (uint64_t i = 0; i < durations.size (); i++)
+            {
+              if (durations.at (i) <= 0)
+                {
+                  NS_LOG_ERROR ("Segment durations have to be positive: " << segmentSizeFile);
+                  return -1;
+                }
+              videoData.segmentStart.push_back (videoData.segmentStart.back () + durations.at (i));
+            }
+          continue;
+        }
       std::vector<int64_t> line ((std::istream_iterator<int64_t> (buffer)),
                                  std::istream_iterator<int64_t>());
-	  m_videoData.averageBitrate.push_back(line.at(0));
+	  videoData.averageBitrate.push_back(line.at(0));
 	  line.erase(line.begin());
-      m_videoData.segmentSize.push_back (line);
+      if (sizes->GetRepresentations () > 0 && (int64_t) line.size () != sizes->GetSegments ())
+        {
+          NS_LOG_ERROR ("All representation levels need the same number of segments: " << segmentSizeFile);
+          return -1;
+        }
+      sizes->AddRepresentation (line);
+    }
+  videoData.segmentSize = segmentSizeTable (sizes);
+  NS_ASSERT_MSG (!videoData.segmentSize.empty (), "No segment sizes read from file.");
+  if (!videoData.segmentStart.empty ())
+    {
+      if (videoData.segmentStart.size () != videoData.segmentSize.at (0).size () + 1)
+        {
+          NS_LOG_ERROR ("The number of segment durations does not match the number of segments: " << segmentSizeFile);
+          return -1;
+        }
+      // the nominal duration is the mean, for everything that only needs an estimate
+      videoData.segmentDuration = videoData.segmentStart.back () / (videoData.segmentStart.size () - 1);
     }
-  NS_ASSERT_MSG (!m_videoData.segmentSize.empty (), "No segment sizes read from file.");
   return 1;
 }
 
+std::shared_ptr<const videoData>
+TcpStreamClient::LoadVideoData (const std::string &segmentSizeFile, int64_t segmentDuration)
+{
+  // Clients of a population usually stream the same video, share one read-only copy per file and duration.
+  // The cache only holds weak references, so the data is released together with the last client using it.
+  static std::map<std::pair<std::string, int64_t>, std::weak_ptr<const videoData> > cache;
+  std::pair<std::string, int64_t> key (segmentSizeFile, segmentDuration);
+  std::shared_ptr<const videoData> shared = cache[key].lock ();
+  if (shared)
+    {
+      return shared;
+    }
+  std::shared_ptr<videoData> loaded = std::make_shared<videoData> ();
+  loaded->segmentDuration = segmentDuration;
+  if (ReadInBitrateValues (segmentSizeFile, *loaded) == -1)
+    {
+      cache.erase (key);
+      return std::shared_ptr<const videoData> ();
+    }
+  cache[key] = loaded;
+  return loaded;
+}
+
 void TcpStreamClient::SegmentReceivedHandle ()
 {
   NS_LOG_FUNCTION (this);
   
   m_transmissionEndReceivingSegment = Simulator::Now ().GetMicroSeconds (); 
+  m_requestOutstanding = false;
+  m_timeoutEvent.Cancel ();
 
   //Update the current buffer level by calculating elapsed playback time
   if (m_segmentCounter > 0 && playbackStarted == 1 && (!m_bufferUnderrun || (m_bufferUnderrun && m_segmentsInBuffer < 1))) {
@@ -490,18 +871,34 @@ void TcpStreamClient::SegmentReceivedHandle ()
   
   //Add the downloaded segment to the buffer
   if(m_segmentCounter == 0) {
-    m_bufferData.bufferLevelNew.push_back (m_videoData.segmentDuration);
+    m_bufferData.bufferLevelNew.push_back (m_videoData->GetSegmentDuration (m_segmentCounter));
   } else {
-    m_bufferData.bufferLevelNew.push_back (m_bufferData.bufferLevelNew.back () + m_videoData.segmentDuration);
+    m_bufferData.bufferLevelNew.push_back (m_bufferData.bufferLevelNew.back () + m_videoData->GetSegmentDuration (m_segmentCounter));
   }
   m_bufferData.timeNow.push_back (m_transmissionEndReceivingSegment);
   
-  m_throughput.bytesReceived.push_back (m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter));
+  // the bytes of the additional sets received meanwhile shared the link, the algorithms see the combined throughput
+  int64_t segmentBytes = m_videoData->segmentSize.at (m_currentRepIndex).at (m_segmentCounter);
+  int64_t combinedBytes = segmentBytes + m_additionalBytes - m_additionalBytesAtRequest;
+  m_throughput.bytesReceived.push_back (combinedBytes);
   m_throughput.transmissionStart.push_back (m_transmissionStartReceivingSegment);
   m_throughput.transmissionRequested.push_back (m_downloadRequestSent);
   m_throughput.transmissionEnd.push_back (m_transmissionEndReceivingSegment);
 
   m_segmentsInBuffer++;
+
+  m_downloadEndTrace (m_clientId, m_segmentCounter, m_currentRepIndex, segmentBytes, MicroSeconds (m_transmissionEndReceivingSegment - m_downloadRequestSent));
+  if (m_recordHistograms)
+    {
+      m_histograms.downloadTime.Record (m_transmissionEndReceivingSegment - (int64_t) m_downloadRequestSent);
+    }
+  if (m_transmissionEndReceivingSegment > m_transmissionStartReceivingSegment)
+    {
+      double bitrate = combinedBytes * 8 / ((m_transmissionEndReceivingSegment - m_transmissionStartReceivingSegment) / (double)1000000);
+      m_throughputTrace (m_clientId, bitrate);
+      streamServer & server = m_servers.at (m_currentServer);
+      server.throughput = server.throughput < 0 ? bitrate : 0.875 * server.throughput + 0.125 * bitrate;
+    }
   
   LogDownload ();
   LogThroughput (0);
@@ -509,6 +906,7 @@ void TcpStreamClient::SegmentReceivedHandle ()
   LogBuffer ();
   
   m_bytesReceived = 0;
+  m_requestOffset = 0;
   if (m_segmentCounter == m_lastSegmentIndex)
     {
       m_bDelay = 0;
@@ -552,24 +950,41 @@ bool TcpStreamClient::PlaybackHandle ()
       
     }
   }
-  // if we got called and there are no segments left in the buffer, there is a buffer underrun
-  if (m_segmentsInBuffer == 0 && m_currentPlaybackIndex < m_lastSegmentIndex && !m_bufferUnderrun)
+  // if we got called and there are no segments left in the buffer (of any adaptation set), there is a buffer underrun
+  bool setsReady = AdditionalSetsReady (m_currentPlaybackIndex);
+  if (!setsReady)
+    {
+      ScheduleAdditionalSets ();
+    }
+  if ((m_segmentsInBuffer == 0 || !setsReady) && m_currentPlaybackIndex < m_lastSegmentIndex && !m_bufferUnderrun)
     {
       m_bufferUnderrun = true;
-      bufferUnderrunLog << std::setfill (' ') << std::setw (26) << timeNow / (double)1000000 << " ";
-      bufferUnderrunLog.flush ();
+      if (logLevel < 2)
+        {
+          bufferUnderrunLog << std::setfill (' ') << std::setw (26) << timeNow / (double)1000000 << " ";
+          bufferUnderrunLog.flush ();
+        }
+      m_stallStartTrace (m_clientId, m_currentPlaybackIndex);
       stallsTotal++;
       lastStallStartTime = timeNow / (double)1000000;
       LogBuffer ();
       return true;
     }
-  else if ((chunk == 0 && m_segmentsInBuffer > 0) || (chunk > 0 && ((m_bufferUnderrun && m_segmentsInBuffer > chunk-1) || (!m_bufferUnderrun && m_segmentsInBuffer>0))))
+  else if (setsReady && ((chunk == 0 && m_segmentsInBuffer > 0) || (chunk > 0 && ((m_bufferUnderrun && m_segmentsInBuffer > chunk-1) || (!m_bufferUnderrun && m_segmentsInBuffer>0)))))
     {
       if (m_bufferUnderrun)
       {
         m_bufferUnderrun = false;
-        bufferUnderrunLog << std::setfill (' ') << std::setw (13) << timeNow / (double)1000000 << "\n";
-        bufferUnderrunLog.flush ();
+        if (logLevel < 2)
+          {
+            bufferUnderrunLog << std::setfill (' ') << std::setw (13) << timeNow / (double)1000000 << "\n";
+            bufferUnderrunLog.flush ();
+          }
+        m_stallEndTrace (m_clientId, MicroSeconds (timeNow) - Seconds (lastStallStartTime));
+        if (m_recordHistograms)
+          {
+            m_histograms.stallDuration.Record (timeNow - (int64_t) (lastStallStartTime * 1000000));
+          }
         stallsTime += ( (timeNow / (double)1000000) - lastStallStartTime );
       }
       m_playbackData.playbackStart.push_back (timeNow);
@@ -583,6 +998,88 @@ bool TcpStreamClient::PlaybackHandle ()
   return true;
 }
 
+void TcpStreamClient::BeginSession (uint32_t clientId, const std::string &algorithm, uint32_t segmentsBehindLive)
+{
+  NS_LOG_FUNCTION (this << clientId << algorithm << segmentsBehindLive);
+  NS_ASSERT_MSG (!m_running, "BeginSession called while a session is running");
+  ResetSession ();
+  m_clientId = clientId;
+
+  // Align the stream to the live segment grid, the session starts segmentsBehindLive segments behind the newest one
+  int64_t fullSegment = chunk > 0 ? m_segmentDuration * chunk : m_segmentDuration;
+  int64_t liveSegment = Simulator::Now ().GetMicroSeconds () / fullSegment;
+  m_availabilityOffset = MicroSeconds ((liveSegment - (int64_t) segmentsBehindLive) * fullSegment);
+
+  Initialise (algorithm, clientId);
+  StartApplication ();
+}
+
+void TcpStreamClient::EndSession ()
+{
+  NS_LOG_FUNCTION (this);
+  m_requestEvent.Cancel ();
+  m_playbackEvent.Cancel ();
+  m_repairEvent.Cancel ();
+  CancelAvailabilityWait ();
+  StopApplication ();
+  if (state != terminal)
+    {
+      // a departure before the end of the content never reached log_QoE
+      LogHistograms ();
+    }
+  ResetSession ();
+  // after the reset, so that late multicast packets are still dropped until the next BeginSession
+  state = terminal;
+}
+
+void TcpStreamClient::SetSessionEndCallback (Callback<void, Ptr<TcpStreamClient> > callback)
+{
+  m_sessionEndCallback = callback;
+}
+
+const streamHistograms & TcpStreamClient::GetHistograms () const
+{
+  return m_histograms;
+}
+
+void TcpStreamClient::ResetSession ()
+{
+  NS_LOG_FUNCTION (this);
+  delete algo;
+  algo = NULL;
+
+  // swap instead of clear, to give the memory of the histories back
+  throughputData emptyThroughput;
+  std::swap (m_throughput, emptyThroughput);
+  bufferData emptyBuffer;
+  std::swap (m_bufferData, emptyBuffer);
+  playbackData emptyPlayback;
+  std::swap (m_playbackData, emptyPlayback);
+  assistanceData emptyAssistance;
+  std::swap (m_assistanceData, emptyAssistance);
+  m_histograms.Reset ();
+  m_bufferData.bufferLevelNew.push_back (0);
+
+  state = initial;
+  m_currentRepIndex = 0;
+  m_segmentCounter = 0;
+  m_bDelay = 0;
+  m_bytesReceived = 0;
+  m_requestOffset = 0;
+  m_multicastWait = false;
+  m_multicastSegments.clear ();
+  m_additionalSets.clear ();
+  m_additionalBytes = 0;
+  m_additionalBytesAtRequest = 0;
+  m_segmentsInBuffer = 0;
+  m_bufferUnderrun = false;
+  m_currentPlaybackIndex = 0;
+  playbackStarted = 0;
+  stallsTotal = 0;
+  stallsTime = 0.0;
+  lastStallStartTime = 0.0;
+}
+
 void TcpStreamClient::SetRemote (Address ip, uint16_t port)
 {
   NS_LOG_FUNCTION (this << ip << port);
@@ -604,43 +1101,121 @@ void TcpStreamClient::SetRemote (Ipv6Address ip, uint16_t port)
   m_peerPort = port;
 }
 
+void TcpStreamClient::AddServer (Address ip, uint16_t port, double weight)
+{
+  NS_LOG_FUNCTION (this << ip << port << weight);
+  if (!(weight > 0))
+    {
+      NS_FATAL_ERROR ("The weight of a server must be positive, not " << weight << ". Terminating.");
+    }
+  streamServer server;
+  server.address = ip;
+  server.port = port;
+  server.weight = weight;
+  server.connected = false;
+  server.failed = false;
+  server.rtt = -1;
+  server.throughput = -1;
+  m_servers.push_back (server);
+}
+
 void TcpStreamClient::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  CancelAvailabilityWait ();
+  m_timeoutEvent.Cancel ();
+  m_failoverEvent.Cancel ();
+  m_repairEvent.Cancel ();
+  m_servers.clear ();
+  m_availability = 0;
   Application::DoDispose ();
 }
 
 void TcpStreamClient::StartApplication (void)
 {
   NS_LOG_FUNCTION (this);
-  if (m_socket == 0)
+  if (m_running)
     {
-      TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
-      m_socket = Socket::CreateSocket (GetNode (), tid);
-      if (Ipv4Address::IsMatchingType (m_peerAddress) == true)
-        {
-          m_socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom (m_peerAddress), m_peerPort));
-        }
-      else if (Ipv6Address::IsMatchingType (m_peerAddress) == true)
-        {
-          m_socket->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom (m_peerAddress), m_peerPort));
-        }
-      m_socket->SetConnectCallback (
-        MakeCallback (&TcpStreamClient::ConnectionSucceeded, this),
-        MakeCallback (&TcpStreamClient::ConnectionFailed, this));
-      m_socket->SetRecvCallback (MakeCallback (&TcpStreamClient::HandleRead, this));
+      return;
+    }
+  if (m_servers.empty ())
+    {
+      AddServer (m_peerAddress, m_peerPort);
+    }
+  m_running = true;
+  if (m_assistancePort != 0 && m_assistanceSocket == 0)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+      m_assistanceSocket = Socket::CreateSocket (GetNode (), tid);
+      m_assistanceSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), m_assistancePort));
+      m_assistanceSocket->SetRecvCallback (MakeCallback (&TcpStreamClient::HandleAssistance, this));
+    }
+  if (!m_multicastAddress.IsInvalid () && m_multicastSocket == 0)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+      m_multicastSocket = Socket::CreateSocket (GetNode (), tid);
+      m_multicastSocket->Bind ();
+      m_multicastSocket->SetRecvCallback (MakeCallback (&TcpStreamClient::HandleMulticast, this));
+    }
+  m_controllerStarted = false;
+  m_multicastWait = false;
+  m_joinedRep = -1;
+  m_requestOutstanding = false;
+  m_requestPending = false;
+  m_failingOver = false;
+  m_nextServer = m_clientId;
+  // the controller starts once the connection to the server of the first request is established
+  int32_t server = SelectServer ();
+  if (server < 0)
+    {
+      ResumeAfterFailover ();
+      return;
     }
+  m_currentServer = server;
+  m_serverChosen = true;
+  ConnectServer (m_currentServer);
 }
 
 void TcpStreamClient::StopApplication ()
 {
   NS_LOG_FUNCTION (this);
 
-  if (m_socket != 0)
+  m_running = false;
+  m_timeoutEvent.Cancel ();
+  m_failoverEvent.Cancel ();
+  for (uint32_t i = 0; i < m_servers.size (); i++)
     {
-      m_socket->Close ();
-      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
-      m_socket = 0;
+      CloseServer (i);
+    }
+  for (uint32_t i = 0; i < m_additionalSets.size (); i++)
+    {
+      adaptationSet & set = m_additionalSets.at (i);
+      if (set.socket != 0)
+        {
+          set.socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+          set.socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (), MakeNullCallback<void, Ptr<Socket> > ());
+          set.socket->Close ();
+          set.socket = 0;
+        }
+      set.connected = false;
+      set.downloading = false;
+      set.bytesReceived = 0;
+    }
+  if (m_assistanceSocket != 0)
+    {
+      m_assistanceSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_assistanceSocket->Close ();
+      m_assistanceSocket = 0;
+    }
+  m_repairEvent.Cancel ();
+  if (m_multicastSocket != 0)
+    {
+      std::string message = "leave";
+      m_multicastSocket->SendTo (Create<Packet> ((const uint8_t *) message.c_str (), message.size () + 1), 0,
+                                 InetSocketAddress (Ipv4Address::ConvertFrom (m_multicastAddress), m_multicastControlPort));
+      m_multicastSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_multicastSocket->Close ();
+      m_multicastSocket = 0;
     }
   downloadLog.close ();
   playbackLog.close ();
@@ -648,6 +1223,7 @@ void TcpStreamClient::StopApplication ()
   bufferLog.close ();
   throughputLog.close ();
   bufferUnderrunLog.close ();
+  m_abrTrace.Close ();
 }
 
 
@@ -673,23 +1249,652 @@ void TcpStreamClient::ConnectionSucceeded (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
   NS_LOG_LOGIC ("Tcp Stream Client connection succeeded");
-  controllerEvent event = init;
-  Controller (event);
+  int32_t server = FindServer (socket);
+  if (server < 0)
+    {
+      return;
+    }
+  m_servers.at (server).connected = true;
+  if (server == (int32_t) m_currentServer && m_requestPending)
+    {
+      SendToServer ();
+    }
+  else if (!m_controllerStarted && server == (int32_t) m_currentServer)
+    {
+      m_controllerStarted = true;
+      controllerEvent event = init;
+      Controller (event);
+    }
 }
 
 void TcpStreamClient::ConnectionFailed (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
   NS_LOG_LOGIC ("Tcp Stream Client connection failed");
+  int32_t server = FindServer (socket);
+  if (server == (int32_t) m_currentServer && (m_requestOutstanding || m_serverChosen || !m_controllerStarted))
+    {
+      Failover ();
+    }
+  else if (server >= 0)
+    {
+      m_servers.at (server).failed = true;
+      m_servers.at (server).retryAt = Simulator::Now () + m_serverRetry;
+      CloseServer (server);
+    }
+}
+
+void TcpStreamClient::ConnectionClosed (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  int32_t server = FindServer (socket);
+  if (server < 0)
+    {
+      return;
+    }
+  if (server == (int32_t) m_currentServer && m_requestOutstanding)
+    {
+      Failover ();
+      return;
+    }
+  // an idle connection is opened again by the next request to the server
+  CloseServer (server);
+}
+
+int32_t TcpStreamClient::FindServer (Ptr<Socket> socket) const
+{
+  for (uint32_t i = 0; i < m_servers.size (); i++)
+    {
+      if (m_servers.at (i).socket == socket)
+        {
+          return i;
+        }
+    }
+  return -1;
+}
+
+int32_t TcpStreamClient::SelectServer ()
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t n = m_servers.size ();
+  std::vector<uint32_t> available;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      streamServer & server = m_servers.at (i);
+      if (server.failed && server.retryAt <= Simulator::Now ())
+        {
+          server.failed = false;
+        }
+      if (!server.failed)
+        {
+          available.push_back (i);
+        }
+    }
+  if (available.empty ())
+    {
+      return -1;
+    }
+
+  switch (m_serverSelection)
+    {
+    case weightedServers:
+      {
+        double total = 0;
+        for (uint32_t i = 0; i < available.size (); i++)
+          {
+            total += m_servers.at (available.at (i)).weight;
+          }
+        double pick = m_jitter->GetValue (0, total);
+        for (uint32_t i = 0; i < available.size (); i++)
+          {
+            pick -= m_servers.at (available.at (i)).weight;
+            if (pick < 0)
+              {
+                return available.at (i);
+              }
+          }
+        return available.back ();
+      }
+    case lowestRtt:
+    case highestThroughput:
+      {
+        // servers without an estimate are tried first, in turn, so that clients spread their probes
+        int32_t best = -1;
+        for (uint32_t k = 0; k < n; k++)
+          {
+            uint32_t i = (m_nextServer + k) % n;
+            const streamServer & server = m_servers.at (i);
+            if (server.failed)
+              {
+                continue;
+              }
+            double estimate = m_serverSelection == lowestRtt ? server.rtt : server.throughput;
+            if (estimate < 0)
+              {
+                m_nextServer = i + 1;
+                return i;
+              }
+            if (best < 0)
+              {
+                best = i;
+                continue;
+              }
+            const streamServer & current = m_servers.at (best);
+            if (m_serverSelection == lowestRtt ? server.rtt < current.rtt : server.throughput > current.throughput)
+              {
+                best = i;
+              }
+          }
+        return best;
+      }
+    case roundRobinServers:
+    default:
+      for (uint32_t k = 0; k < n; k++)
+        {
+          uint32_t i = (m_nextServer + k) % n;
+          if (!m_servers.at (i).failed)
+            {
+              m_nextServer = i + 1;
+              return i;
+            }
+        }
+    }
+  return -1;
+}
+
+void TcpStreamClient::ConnectServer (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  streamServer & server = m_servers.at (index);
+  if (server.socket != 0)
+    {
+      return;
+    }
+  TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+  server.socket = Socket::CreateSocket (GetNode (), tid);
+  server.connected = false;
+  if (Ipv4Address::IsMatchingType (server.address) == true)
+    {
+      server.socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom (server.address), server.port));
+    }
+  else if (Ipv6Address::IsMatchingType (server.address) == true)
+    {
+      server.socket->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom (server.address), server.port));
+    }
+  server.socket->SetConnectCallback (
+    MakeCallback (&TcpStreamClient::ConnectionSucceeded, this),
+    MakeCallback (&TcpStreamClient::ConnectionFailed, this));
+  server.socket->SetCloseCallbacks (
+    MakeCallback (&TcpStreamClient::ConnectionClosed, this),
+    MakeCallback (&TcpStreamClient::ConnectionClosed, this));
+  server.socket->SetRecvCallback (MakeCallback (&TcpStreamClient::HandleRead, this));
+}
+
+void TcpStreamClient::CloseServer (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  streamServer & server = m_servers.at (index);
+  if (server.socket == 0)
+    {
+      return;
+    }
+  server.socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  server.socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (), MakeNullCallback<void, Ptr<Socket> > ());
+  server.socket->Close ();
+  server.socket = 0;
+  server.connected = false;
+}
+
+void TcpStreamClient::SendToServer ()
+{
+  NS_LOG_FUNCTION (this);
+  streamServer & server = m_servers.at (m_currentServer);
+  m_lastProgress = Simulator::Now ().GetMicroSeconds ();
+  if (!server.connected)
+    {
+      m_requestPending = true;
+      ConnectServer (m_currentServer);
+      return;
+    }
+  m_requestPending = false;
+  m_serverRequestSent = Simulator::Now ().GetMicroSeconds ();
+  server.socket->Send (Create<Packet> (m_data, m_dataSize));
+  if (!m_requestTimeout.IsZero ())
+    {
+      m_timeoutEvent.Cancel ();
+      m_timeoutEvent = Simulator::Schedule (m_requestTimeout, &TcpStreamClient::RequestTimedOut, this);
+    }
+}
+
+void TcpStreamClient::Failover ()
+{
+  NS_LOG_FUNCTION (this << m_currentServer);
+  m_timeoutEvent.Cancel ();
+  streamServer & server = m_servers.at (m_currentServer);
+  server.failed = true;
+  server.retryAt = Simulator::Now () + m_serverRetry;
+  CloseServer (m_currentServer);
+  if (m_multicastWait)
+    {
+      // no request is waiting for the server, the next one (a repair) goes to another
+      ResumeAfterFailover ();
+      return;
+    }
+  if (!m_failingOver && m_requestOutstanding)
+    {
+      m_failingOver = true;
+      m_failedServer = m_currentServer;
+      m_outageStart = m_lastProgress;
+    }
+  // the outstanding request is repeated as a whole
+  m_bytesReceived = m_requestOffset;
+  ResumeAfterFailover ();
+}
+
+void TcpStreamClient::ResumeAfterFailover ()
+{
+  NS_LOG_FUNCTION (this);
+  m_failoverEvent.Cancel ();
+  if (!m_running)
+    {
+      return;
+    }
+  int32_t server = SelectServer ();
+  if (server < 0)
+    {
+      Time retry = m_servers.at (0).retryAt;
+      for (uint32_t i = 1; i < m_servers.size (); i++)
+        {
+          retry = std::min (retry, m_servers.at (i).retryAt);
+        }
+      m_failoverEvent = Simulator::Schedule (retry - Simulator::Now (), &TcpStreamClient::ResumeAfterFailover, this);
+      return;
+    }
+  m_currentServer = server;
+  if (m_requestOutstanding && !m_multicastWait)
+    {
+      SendToServer ();
+    }
+  else
+    {
+      // the controller did not start yet, or starts its next request on this server
+      m_serverChosen = true;
+      ConnectServer (m_currentServer);
+    }
+}
+
+void TcpStreamClient::HandleAssistance (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      // "bitrate validity", in bit/s and microseconds
+      std::string hint (packet->GetSize (), '\0');
+      packet->CopyData ((uint8_t *) &hint[0], packet->GetSize ());
+      std::istringstream ss (hint.c_str ());
+      double bitrate;
+      int64_t validity;
+      if (!(ss >> bitrate >> validity))
+        {
+          continue;
+        }
+      m_assistanceData.hintTime.push_back (Simulator::Now ().GetMicroSeconds ());
+      m_assistanceData.recommendedBitrate.push_back (bitrate);
+      m_assistanceData.validity.push_back (validity);
+      m_assistanceTrace (m_clientId, bitrate);
+    }
+}
+
+void TcpStreamClient::RequestFromGroup ()
+{
+  NS_LOG_FUNCTION (this);
+  // the subscription is repeated with every segment, a lost join only costs repairs until the next one
+  JoinGroup (m_currentRepIndex);
+  int64_t now = Simulator::Now ().GetMicroSeconds ();
+  m_downloadRequestSent = now;
+  m_requestOutstanding = true;
+  m_multicastWait = true;
+  m_requestOffset = 0;
+  m_bytesReceived = 0;
+
+  // segments received ahead that are behind the client now are of no use any more
+  while (!m_multicastSegments.empty () && m_multicastSegments.begin ()->first.first < m_segmentCounter)
+    {
+      m_multicastSegments.erase (m_multicastSegments.begin ());
+    }
+  std::map<std::pair<int64_t, int64_t>, multicastSegment>::iterator ahead = m_multicastSegments.find (std::make_pair (m_segmentCounter, m_currentRepIndex));
+  int64_t segmentBytes = m_videoData->segmentSize.at (m_currentRepIndex).at (m_segmentCounter);
+  if (ahead != m_multicastSegments.end ())
+    {
+      m_bytesReceived = ahead->second.bytes;
+      m_transmissionStartReceivingSegment = ahead->second.firstArrival;
+      if (m_bytesReceived >= segmentBytes)
+        {
+          // received completely before it was asked for: the download spans the transmission of the group
+          m_transmissionStartReceivingSegment = now - (ahead->second.lastArrival - ahead->second.firstArrival);
+        }
+      m_downloadRequestSent = m_transmissionStartReceivingSegment;
+      m_multicastSegments.erase (ahead);
+      m_downloadStartTrace (m_clientId, m_segmentCounter, m_currentRepIndex, segmentBytes);
+    }
+  if (m_bytesReceived >= segmentBytes)
+    {
+      m_multicastWait = false;
+      // completed outside of the controller, which called this
+      m_repairEvent = Simulator::ScheduleNow (&TcpStreamClient::SegmentReceivedHandle, this);
+      return;
+    }
+  m_repairEvent.Cancel ();
+  m_repairEvent = Simulator::Schedule (m_repairTimeout, &TcpStreamClient::Repair, this);
+}
+
+void TcpStreamClient::JoinGroup (int64_t repIndex)
+{
+  NS_LOG_FUNCTION (this << repIndex);
+  std::ostringstream join;
+  join << "join " << repIndex;
+  std::string message = join.str ();
+  m_multicastSocket->SendTo (Create<Packet> ((const uint8_t *) message.c_str (), message.size () + 1), 0,
+                             InetSocketAddress (Ipv4Address::ConvertFrom (m_multicastAddress), m_multicastControlPort));
+  m_joinedRep = repIndex;
+}
+
+void TcpStreamClient::HandleMulticast (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      TcpStreamMulticastHeader header;
+      packet->RemoveHeader (header);
+      int64_t segmentIndex = header.GetSegmentIndex ();
+      int64_t repIndex = header.GetRepIndex ();
+      int64_t now = Simulator::Now ().GetMicroSeconds ();
+      if (state == terminal || segmentIndex < m_segmentCounter)
+        {
+          continue;
+        }
+      bool current = segmentIndex == m_segmentCounter && repIndex == m_currentRepIndex;
+      if (current && m_multicastWait)
+        {
+          if (m_bytesReceived == 0)
+            {
+              m_transmissionStartReceivingSegment = now;
+              m_downloadStartTrace (m_clientId, m_segmentCounter, m_currentRepIndex, header.GetSegmentSize ());
+            }
+          m_bytesReceived += packet->GetSize ();
+          if (m_bytesReceived >= m_videoData->segmentSize.at (m_currentRepIndex).at (m_segmentCounter))
+            {
+              m_multicastWait = false;
+              m_repairEvent.Cancel ();
+              SegmentReceivedHandle ();
+            }
+          else
+            {
+              m_repairEvent.Cancel ();
+              m_repairEvent = Simulator::Schedule (m_repairTimeout, &TcpStreamClient::Repair, this);
+            }
+          continue;
+        }
+      if (current && m_requestOutstanding)
+        {
+          // the missing bytes were requested from the server already
+          continue;
+        }
+      if (m_multicastWait && repIndex == m_currentRepIndex && segmentIndex > m_segmentCounter)
+        {
+          // the group moved on to the next segment, the rest of the current one is not coming any more
+          Repair ();
+        }
+      multicastSegment & ahead = m_multicastSegments[std::make_pair (segmentIndex, repIndex)];
+      if (ahead.bytes == 0)
+        {
+          ahead.firstArrival = now;
+        }
+      ahead.bytes += packet->GetSize ();
+      ahead.lastArrival = now;
+    }
+}
+
+void TcpStreamClient::Repair ()
+{
+  NS_LOG_FUNCTION (this);
+  m_repairEvent.Cancel ();
+  if (!m_multicastWait)
+    {
+      return;
+    }
+  m_multicastWait = false;
+  int64_t missing = m_videoData->segmentSize.at (m_currentRepIndex).at (m_segmentCounter) - m_bytesReceived;
+  m_repairTrace (m_clientId, m_segmentCounter, m_currentRepIndex, missing);
+  m_requestOffset = m_bytesReceived;
+  // only the size: caches relay the request instead of storing the part as the whole segment
+  std::string message = ToString (missing);
+  uint64_t requested = m_downloadRequestSent;
+  Send (message);
+  m_downloadRequestSent = requested;
+}
+
+void TcpStreamClient::ScheduleAdditionalSets ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_running)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < m_additionalSets.size (); i++)
+    {
+      const adaptationSet & set = m_additionalSets.at (i);
+      if (!set.downloading && set.segmentCounter <= m_segmentCounter && set.segmentCounter < m_lastSegmentIndex
+          && getAvailabilityTime (set.segmentCounter) <= Simulator::Now ().GetMicroSeconds ())
+        {
+          RequestAdditionalSegment (i);
+        }
+    }
+}
+
+void TcpStreamClient::RequestAdditionalSegment (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  adaptationSet & set = m_additionalSets.at (index);
+  int64_t videoSegment = std::min (m_segmentCounter, m_lastSegmentIndex - 1);
+  double segmentSeconds = m_videoData->GetSegmentDuration (videoSegment) / (double) 1000000;
+  double budget = 0;
+  if (!m_throughput.transmissionEnd.empty ())
+    {
+      double seconds = (m_throughput.transmissionEnd.back () - m_throughput.transmissionStart.back ()) / (double) 1000000;
+      if (seconds > 0)
+        {
+          budget = m_throughput.bytesReceived.back () * 8 / seconds;
+        }
+      budget -= m_videoData->segmentSize.at (m_currentRepIndex).at (videoSegment) * 8 / segmentSeconds;
+    }
+  set.repIndex = 0;
+  for (uint32_t rep = 1; rep < set.data->segmentSize.size (); rep++)
+    {
+      if (set.data->segmentSize.at (rep).at (set.segmentCounter) * 8 / segmentSeconds <= budget)
+        {
+          set.repIndex = rep;
+        }
+    }
+  set.downloading = true;
+  set.bytesReceived = 0;
+  if (set.socket != 0 && set.server != m_currentServer)
+    {
+      // the video moved to another server (by the server selection or a failover), the set moves along
+      set.socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      set.socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (), MakeNullCallback<void, Ptr<Socket> > ());
+      set.socket->Close ();
+      set.socket = 0;
+      set.connected = false;
+    }
+  if (set.socket == 0)
+    {
+      // the set follows the video to the server chosen for it, so the server weights and the failover apply
+      // to the sets as well; the request is sent once connected
+      set.server = m_currentServer;
+      const streamServer & server = m_servers.at (m_currentServer);
+      TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+      set.socket = Socket::CreateSocket (GetNode (), tid);
+      set.connected = false;
+      if (Ipv4Address::IsMatchingType (server.address) == true)
+        {
+          set.socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom (server.address), server.port));
+        }
+      else if (Ipv6Address::IsMatchingType (server.address) == true)
+        {
+          set.socket->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom (server.address), server.port));
+        }
+      set.socket->SetConnectCallback (
+        MakeCallback (&TcpStreamClient::AdditionalSetConnected, this),
+        MakeCallback (&TcpStreamClient::AdditionalSetClosed, this));
+      set.socket->SetCloseCallbacks (
+        MakeCallback (&TcpStreamClient::AdditionalSetClosed, this),
+        MakeCallback (&TcpStreamClient::AdditionalSetClosed, this));
+      set.socket->SetRecvCallback (MakeCallback (&TcpStreamClient::HandleAdditionalRead, this));
+      return;
+    }
+  if (set.connected)
+    {
+      SendAdditionalRequest (index);
+    }
+}
+
+void TcpStreamClient::SendAdditionalRequest (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  adaptationSet & set = m_additionalSets.at (index);
+  // only the size: the indices would collide with the video's in caches, which relay such requests
+  std::string message = ToString (set.data->segmentSize.at (set.repIndex).at (set.segmentCounter));
+  set.socket->Send (Create<Packet> ((const uint8_t *) message.c_str (), message.size () + 1));
+}
+
+int32_t TcpStreamClient::FindAdditionalSet (Ptr<Socket> socket) const
+{
+  for (uint32_t i = 0; i < m_additionalSets.size (); i++)
+    {
+      if (m_additionalSets.at (i).socket == socket)
+        {
+          return i;
+        }
+    }
+  return -1;
+}
+
+void TcpStreamClient::AdditionalSetConnected (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  int32_t index = FindAdditionalSet (socket);
+  if (index < 0)
+    {
+      return;
+    }
+  m_additionalSets.at (index).connected = true;
+  if (m_additionalSets.at (index).downloading)
+    {
+      SendAdditionalRequest (index);
+    }
+}
+
+void TcpStreamClient::AdditionalSetClosed (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  int32_t index = FindAdditionalSet (socket);
+  if (index < 0)
+    {
+      return;
+    }
+  adaptationSet & set = m_additionalSets.at (index);
+  socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (), MakeNullCallback<void, Ptr<Socket> > ());
+  socket->Close ();
+  set.socket = 0;
+  set.connected = false;
+  // the segment is requested again as a whole, with the next video request or a stall
+  set.downloading = false;
+  set.bytesReceived = 0;
+}
+
+void TcpStreamClient::HandleAdditionalRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  int32_t index = FindAdditionalSet (socket);
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      if (index < 0 || !m_additionalSets.at (index).downloading)
+        {
+          continue;
+        }
+      adaptationSet & set = m_additionalSets.at (index);
+      set.bytesReceived += packet->GetSize ();
+      m_additionalBytes += packet->GetSize ();
+      int64_t segmentBytes = set.data->segmentSize.at (set.repIndex).at (set.segmentCounter);
+      if (set.bytesReceived >= segmentBytes)
+        {
+          m_setDownloadEndTrace (m_clientId, index, set.segmentCounter, set.repIndex, segmentBytes);
+          set.segmentCounter++;
+          set.downloading = false;
+          set.bytesReceived = 0;
+          ResumePlayback ();
+          ScheduleAdditionalSets ();
+        }
+    }
+}
+
+bool TcpStreamClient::AdditionalSetsReady (int64_t segmentIndex) const
+{
+  for (uint32_t i = 0; i < m_additionalSets.size (); i++)
+    {
+      if (m_additionalSets.at (i).segmentCounter <= segmentIndex && segmentIndex < m_lastSegmentIndex)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void TcpStreamClient::ResumePlayback ()
+{
+  NS_LOG_FUNCTION (this);
+  // downloadingPlaying and playing have their playback timer running, which resumes playback itself
+  if ((state != downloading && state != playing) || m_playbackEvent.IsRunning ()
+      || (playbackStarted == 1 && !m_bufferUnderrun) || m_segmentsInBuffer == 0
+      || !AdditionalSetsReady (m_currentPlaybackIndex))
+    {
+      return;
+    }
+  if (PlaybackHandle ())
+    {
+      return;
+    }
+  if (state == downloading)
+    {
+      state = downloadingPlaying;
+    }
+  controllerEvent ev = playbackFinished;
+  m_playbackEvent = Simulator::Schedule (MicroSeconds (m_videoData->GetSegmentDuration (m_currentPlaybackIndex - 1)), &TcpStreamClient::Controller, this, ev);
+}
+
+void TcpStreamClient::RequestTimedOut ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_LOGIC ("Tcp Stream Client request to server " << m_currentServer << " timed out");
+  if (m_requestOutstanding)
+    {
+      Failover ();
+    }
 }
 
 void TcpStreamClient::LogThroughput (uint32_t packetSize)
 {
   NS_LOG_FUNCTION (this);
+  DashProfilerScope profile ("Log", "Throughput");
 
   if(logLevel == 0) {
     throughputLog << Simulator::Now ().GetMicroSeconds ()  / (double) 1000000 << " "
-                  << std::to_string((m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter)*8)/((m_transmissionEndReceivingSegment-m_transmissionStartReceivingSegment)/(double)1000000)) << "\n";
+                  << std::to_string((m_videoData->segmentSize.at (m_currentRepIndex).at (m_segmentCounter)*8)/((m_transmissionEndReceivingSegment-m_transmissionStartReceivingSegment)/(double)1000000)) << "\n";
     throughputLog.flush ();
   }
   
@@ -698,13 +1903,14 @@ void TcpStreamClient::LogThroughput (uint32_t packetSize)
 void TcpStreamClient::LogDownload ()
 {
   NS_LOG_FUNCTION (this);
+  DashProfilerScope profile ("Log", "Download");
 
   if(logLevel == 0) {
     downloadLog <<  m_segmentCounter << " "
                 <<  m_downloadRequestSent / (double)1000000 << " "
                 <<  m_transmissionStartReceivingSegment / (double)1000000 << " "
                 <<  m_transmissionEndReceivingSegment / (double)1000000 << " "
-                <<  m_videoData.segmentSize.at (m_currentRepIndex).at (m_segmentCounter) << " "
+                <<  m_videoData->segmentSize.at (m_currentRepIndex).at (m_segmentCounter) << " "
                 <<  "\n";
     downloadLog.flush ();
   }
@@ -714,7 +1920,9 @@ void TcpStreamClient::LogDownload ()
 void TcpStreamClient::LogBuffer ()
 {
   NS_LOG_FUNCTION (this);
+  DashProfilerScope profile ("Log", "Buffer");
 
+  m_bufferLevelTrace (m_clientId, MicroSeconds (m_bufferData.bufferLevelNew.back ()));
   if(logLevel == 0) {
     bufferLog <<  m_bufferData.timeNow.back() / (double)1000000 << " "
              << m_bufferData.bufferLevelNew.back () / (double)1000000 << "\n";
@@ -726,6 +1934,7 @@ void TcpStreamClient::LogBuffer ()
 void TcpStreamClient::LogAdaptation (algorithmReply answer)
 {
   NS_LOG_FUNCTION (this);
+  DashProfilerScope profile ("Log", "Adaptation");
 
   if(logLevel == 0) {
     adaptationLog << m_segmentCounter << " "
@@ -745,22 +1954,31 @@ void TcpStreamClient::LogAdaptation (algorithmReply answer)
 void TcpStreamClient::LogPlayback ()
 {
   NS_LOG_FUNCTION (this);
+  DashProfilerScope profile ("Log", "Playback");
   double becameAvailable = getAvailabilityTime(m_currentPlaybackIndex);
+  int64_t liveLatency = Simulator::Now ().GetMicroSeconds () - (int64_t) (becameAvailable - m_videoData->GetSegmentDuration (m_currentPlaybackIndex - 1));
+  m_liveLatencyTrace (m_clientId, m_currentPlaybackIndex, MicroSeconds (liveLatency));
+  if (m_recordHistograms)
+    {
+      m_histograms.liveLatency.Record (liveLatency);
+    }
 
-  playbackLog << m_currentPlaybackIndex << " "
-              <<  ((becameAvailable)/ (double)1000000) << " "
-              <<  std::to_string(Simulator::Now ().GetMicroSeconds ()  / (double)1000000) << " "
-              <<  std::to_string((Simulator::Now ().GetMicroSeconds ()-(becameAvailable-m_videoData.segmentDuration))  / (double)1000000) << " "
-              << m_playbackData.playbackIndex.at (m_currentPlaybackIndex) << "\n";
-  playbackLog.flush ();
+  if(logLevel < 2) {
+    playbackLog << m_currentPlaybackIndex << " "
+                <<  ((becameAvailable)/ (double)1000000) << " "
+                <<  std::to_string(Simulator::Now ().GetMicroSeconds ()  / (double)1000000) << " "
+                <<  std::to_string(liveLatency / (double)1000000) << " "
+                << m_playbackData.playbackIndex.at (m_currentPlaybackIndex) << "\n";
+    playbackLog.flush ();
+  }
 }
 
 void TcpStreamClient::InitializeLogFiles (std::string simulationId, std::string clientId, std::string numberOfClients)
 {
   NS_LOG_FUNCTION (this);
-  if(logLevel == 2) {
+  if(logLevel >= 2) {
 
-    //QoE only
+    //QoE only, or no files at all
 
   } else if(logLevel == 1) {
 
@@ -814,15 +2032,19 @@ double TcpStreamClient::getAvailabilityTime(int64_t segmentIndex)
 {
   double availabilityTime;
   if(chunk > 0) {
-    availabilityTime = m_videoData.segmentDuration*(segmentIndex-3);
+    availabilityTime = m_videoData->GetSegmentStart (segmentIndex-3);
   } else {
-    availabilityTime = m_videoData.segmentDuration*segmentIndex;
+    availabilityTime = m_videoData->GetSegmentStart (segmentIndex);
   }
-  return availabilityTime;
+  return availabilityTime + m_availabilityOffset.GetMicroSeconds ();
 }
   
 void TcpStreamClient::log_QoE()
 {
+  DashProfilerScope profile ("Log", "QoE");
+  if(logLevel == 3) {
+    return;
+  }
 
   //log qoe here
   double avgQualityLevel = 0.0;
@@ -834,13 +2056,13 @@ void TcpStreamClient::log_QoE()
   float variance = 0.0;
   for(int i = 0; i < m_lastSegmentIndex; ++i) {
     sum += m_playbackData.playbackIndex.at(i);
-    avgQualityLevel = sum/m_lastSegmentIndex;
   }
+  avgQualityLevel = sum/m_lastSegmentIndex;
   for(int i = 0; i < m_lastSegmentIndex; ++i) {
     variance += pow(m_playbackData.playbackIndex.at(i) - avgQualityLevel, 2);
-    variance=variance/m_lastSegmentIndex;
-    qualitySD = sqrt(variance);
   }
+  variance = variance/m_lastSegmentIndex;
+  qualitySD = sqrt(variance);
 
   // Rebuffer Ratio
   rebufferRatio = stallsTime / (m_lastSegmentIndex * (m_segmentDuration / (double)1000000));
@@ -851,6 +2073,19 @@ void TcpStreamClient::log_QoE()
   logFile << avgQualityLevel << " " << qualitySD << " " << stallsTotal << " " << rebufferRatio;
   logFile.flush ();    
 
+  LogHistograms ();
+}
+
+void TcpStreamClient::LogHistograms ()
+{
+  if (!m_recordHistograms || logLevel == 3)
+    {
+      return;
+    }
+  std::ofstream histogramFile;
+  std::string histogramFileName = dashLogDirectory + "/SimID_" + ToString(m_simulationId) + "/" + "client" + ToString(m_clientId) + "_" + "histograms.txt";
+  histogramFile.open (histogramFileName.c_str ());
+  m_histograms.Write (histogramFile);
 }
 
 } // Namespace ns3
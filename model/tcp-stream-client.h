@@ -24,10 +24,18 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <vector>
 #include "tcp-stream-adaptation-algorithm.h"
 #include "tcp-stream-interface.h"
+#include "tcp-stream-abr-trace.h"
+#include "tcp-stream-histogram.h"
+#include "tcp-stream-availability-notifier.h"
 #include "tobasco2.h"
 #include "festive.h"
 #include "panda.h"
@@ -58,6 +66,115 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+
+  /**
+   * \brief Signature of the BufferLevel trace source.
+   * \param clientId the id of the client
+   * \param level the buffer level after the update
+   */
+  typedef void (* BufferLevelCallback)(uint32_t clientId, Time level);
+  /**
+   * \brief Signature of the Representation trace source.
+   * \param clientId the id of the client
+   * \param segmentIndex the index of the segment (chunk) to be downloaded next
+   * \param repIndex the representation chosen for it
+   */
+  typedef void (* RepresentationCallback)(uint32_t clientId, int64_t segmentIndex, int64_t repIndex);
+  /**
+   * \brief Signature of the DownloadStart trace source.
+   * \param clientId the id of the client
+   * \param segmentIndex the index of the segment (chunk)
+   * \param repIndex the representation of the segment
+   * \param bytes the size of the segment in bytes
+   */
+  typedef void (* DownloadStartCallback)(uint32_t clientId, int64_t segmentIndex, int64_t repIndex, int64_t bytes);
+  /**
+   * \brief Signature of the DownloadEnd trace source.
+   * \param clientId the id of the client
+   * \param segmentIndex the index of the segment (chunk)
+   * \param repIndex the representation of the segment
+   * \param bytes the size of the segment in bytes
+   * \param duration the time from sending the request until the last byte arrived
+   */
+  typedef void (* DownloadEndCallback)(uint32_t clientId, int64_t segmentIndex, int64_t repIndex, int64_t bytes, Time duration);
+  /**
+   * \brief Signature of the StallStart trace source.
+   * \param clientId the id of the client
+   * \param segmentIndex the index of the segment playback is waiting for
+   */
+  typedef void (* StallStartCallback)(uint32_t clientId, int64_t segmentIndex);
+  /**
+   * \brief Signature of the StallEnd trace source.
+   * \param clientId the id of the client
+   * \param duration the duration of the stall
+   */
+  typedef void (* StallEndCallback)(uint32_t clientId, Time duration);
+  /**
+   * \brief Signature of the LiveLatency trace source.
+   * \param clientId the id of the client
+   * \param segmentIndex the index of the segment (chunk) whose playback starts
+   * \param latency the time between the start of the production of the segment and its playback
+   */
+  typedef void (* LiveLatencyCallback)(uint32_t clientId, int64_t segmentIndex, Time latency);
+  /**
+   * \brief Signature of the ThroughputEstimate trace source.
+   * \param clientId the id of the client
+   * \param bitrate the throughput measured for the last segment in bit/s
+   */
+  typedef void (* ThroughputEstimateCallback)(uint32_t clientId, double bitrate);
+  /**
+   * \brief Signature of the Failover trace source.
+   * \param clientId the id of the client
+   * \param fromServer the index of the server that failed
+   * \param toServer the index of the server that answered the repeated request
+   * \param outage the time from the last progress on the failed server until the first byte of the answer
+   */
+  typedef void (* FailoverCallback)(uint32_t clientId, uint32_t fromServer, uint32_t toServer, Time outage);
+  /**
+   * \brief Signature of the AssistanceHint trace source.
+   * \param clientId the id of the client
+   * \param bitrate the recommended bitrate in bit/s
+   */
+  typedef void (* AssistanceHintCallback)(uint32_t clientId, double bitrate);
+  /**
+   * \brief Signature of the MulticastRepair trace source.
+   * \param clientId the id of the client
+   * \param segmentIndex the index of the segment
+   * \param repIndex the representation of the segment
+   * \param bytes the bytes of the segment requested over unicast, because they were not received from the group
+   */
+  typedef void (* MulticastRepairCallback)(uint32_t clientId, int64_t segmentIndex, int64_t repIndex, int64_t bytes);
+  /**
+   * \brief Signature of the AdaptationSetDownloadEnd trace source.
+   * \param clientId the id of the client
+   * \param set the index of the additional adaptation set, in the order of AdditionalSegmentSizeFiles
+   * \param segmentIndex the index of the segment
+   * \param repIndex the representation of the segment
+   * \param bytes the size of the segment in bytes
+   */
+  typedef void (* AdaptationSetDownloadEndCallback)(uint32_t clientId, uint32_t set, int64_t segmentIndex, int64_t repIndex, int64_t bytes);
+
+  /**
+   * \brief How requests waiting for the availability of a segment are spread over the RequestJitter window.
+   */
+  enum requestTiming
+  {
+    randomJitter, //!< uniformly at random
+    clientOffset, //!< by a fixed offset per client id
+    paced //!< the clients waiting for the same segment are released evenly over the window
+  };
+
+  /**
+   * \brief How the server of every request is chosen among the servers of the client.
+   */
+  enum serverSelection
+  {
+    roundRobinServers, //!< the servers in turn, starting at the client id
+    weightedServers, //!< at random, in proportion to the server weights
+    lowestRtt, //!< the server with the lowest smoothed time from request to first byte
+    highestThroughput //!< the server with the highest smoothed segment throughput
+  };
+
   TcpStreamClient ();
   virtual ~TcpStreamClient ();
 
@@ -69,7 +186,44 @@ public:
    *
    * \param algorithm the name of the algorithm to use for instantiating an adaptation algorithm object.
    */
-  void Initialise (std::string algorithm, uint16_t clientId);
+  void Initialise (const std::string &algorithm, uint32_t clientId);
+
+  /**
+   * \brief Create an adaptation algorithm object by its name.
+   *
+   * The algorithm operates on the given structs, which the caller keeps alive and updates.
+   *
+   * \return the new algorithm, or NULL if no algorithm with this name exists.
+   */
+  static AdaptationAlgorithm * CreateAdaptationAlgorithm (std::string algorithm,
+                                                          const videoData & videoData,
+                                                          const playbackData & playbackData,
+                                                          const bufferData & bufferData,
+                                                          const throughputData & throughput,
+                                                          int64_t chunk, int cmaf);
+
+  /**
+   * \brief Read in bitrate values
+   *
+   * The test bitrate values to be read must be provided in bytes in absolute sizes (not per second!)
+   * as a 2x2 matrix, with spaces separating the segment sizes and newlines for every representation level.
+   * The first value of every line is the average bitrate of the representation level.
+   * Binary segment size files (see SegmentSizeMappedFile) are memory-mapped instead of read, and "vbr:"
+   * specifications (see SegmentSizeGenerator) compute the sizes on demand.
+   *
+   * \return -1 if the file could not be opened, its representation levels differ in length or its segment
+   * durations are invalid, 1 otherwise
+   */
+  static int ReadInBitrateValues (std::string segmentSizeFile, videoData & videoData);
+
+  /**
+   * \brief Get the video data of a segment size file, shared by all clients streaming it.
+   *
+   * The file is only read by the first client asking for it with the given segment duration.
+   *
+   * \return the shared video data, or an empty pointer if the file could not be opened
+   */
+  static std::shared_ptr<const videoData> LoadVideoData (const std::string &segmentSizeFile, int64_t segmentDuration);
 
   /**
    * \brief Set the remote address and port
@@ -89,6 +243,46 @@ public:
    * \param port remote port
    */
   void SetRemote (Address ip, uint16_t port);
+  /**
+   * \brief Add a server to the servers the client chooses from, see ServerSelection.
+   *
+   * Once servers are added, RemoteAddress and RemotePort are ignored.
+   *
+   * \param ip server IP address
+   * \param port server port
+   * \param weight share of the requests sent to the server with weighted selection
+   */
+  void AddServer (Address ip, uint16_t port, double weight = 1);
+
+  /**
+   * \brief Start a new streaming session on this (idle) client, for clients joining and leaving a live stream.
+   *
+   * All state of a previous session is dropped, the client is initialised with the given id and algorithm
+   * and connects to the server. The stream is aligned to the live segment grid, so that the session starts
+   * segmentsBehindLive segments behind the newest available segment.
+   */
+  void BeginSession (uint32_t clientId, const std::string &algorithm, uint32_t segmentsBehindLive);
+
+  /**
+   * \brief End the running session: pending events are cancelled, the connection and the log files are closed
+   * and the memory of the session is released. The client can be reused by BeginSession.
+   *
+   * The histograms of a session ended before the end of the content are written here, as the QoE log is not.
+   */
+  void EndSession ();
+
+  /**
+   * \brief Set the callback invoked when a session ends because the end of the content was played.
+   */
+  void SetSessionEndCallback (Callback<void, Ptr<TcpStreamClient> > callback);
+
+  /**
+   * \brief Get the latency and stall histograms of this client, filled if RecordHistograms is set.
+   *
+   * The histograms cover the current or last session, they are written to clientX_histograms.txt when the
+   * session ends and reset for the next one, so merging the files of all sessions counts every value once.
+   */
+  const streamHistograms & GetHistograms () const;
 
 protected:
   virtual void DoDispose (void);
@@ -135,6 +329,24 @@ private:
    * Assuming that a buffer underrun has just been encountered and the client is currently in state downloading, the client is currently busy downloading the next segment. After the segment is fully downloaded, the controller is notified, PlaybackHandle() is called, thus starting the playback of the just downloaded segment and the transition downloading downloadFinished-> downloadingPlaying is performed. If the just downloaded segment (after the buffer underrun) was the streaming session's last segment, downloading downloadFinished-> playing is performed, the last segment is played and playing playbackFinished-> terminal is performed, as explained before.
    */
   void Controller (controllerEvent action);
+
+  /**
+   * \brief Request the current segment, or wait with the other clients of the stream until it becomes available.
+   */
+  void RequestWhenAvailable ();
+  /**
+   * \brief Invoked by the availability notifier when the awaited segment became available.
+   */
+  void AvailabilityReached ();
+  /**
+   * \brief Stop waiting for the availability of a segment, if the client does.
+   */
+  void CancelAvailabilityWait ();
+
+  /**
+   * \brief Drop the adaptation algorithm and all per-session state, releasing the memory of the histories.
+   */
+  void ResetSession ();
   /**
    * Set the data fill of the packet (what is actually sent as data to the server with m_data) to
    * the zero-terminated contents of the T & message string.
@@ -151,6 +363,60 @@ private:
    */
   template <typename T>
   void Send (T & message);
+  /**
+   * \brief Request the current segment in the current representation from the server.
+   *
+   * The request carries the segment size followed by the segment and representation index.
+   */
+  void SendRequest ();
+  /**
+   * \brief Take the current segment from the multicast group of its representation, joining the group first.
+   *
+   * Bytes of the segment that arrived before are used at once. The segment completes from the group, or is
+   * repaired over unicast when the group stops delivering it (see Repair).
+   */
+  void RequestFromGroup ();
+  /**
+   * \brief Subscribe to the group of the representation at the replicator, leaving the previous group.
+   */
+  void JoinGroup (int64_t repIndex);
+  /**
+   * \brief Handle datagrams of the multicast group.
+   */
+  void HandleMulticast (Ptr<Socket> socket);
+  /**
+   * \brief The group delivered no more of the current segment, request its missing bytes from the server.
+   */
+  void Repair ();
+  /**
+   * \brief Request the next segment of every additional adaptation set that is idle, available and not
+   * ahead of the video.
+   */
+  void ScheduleAdditionalSets ();
+  /**
+   * \brief Request the next segment of an additional adaptation set, in the highest representation that
+   * fits into the last combined throughput beside the current video representation.
+   */
+  void RequestAdditionalSegment (uint32_t set);
+  void SendAdditionalRequest (uint32_t set);
+  /**
+   * \return the index of the additional adaptation set the socket belongs to, -1 if none
+   */
+  int32_t FindAdditionalSet (Ptr<Socket> socket) const;
+  void AdditionalSetConnected (Ptr<Socket> socket);
+  /**
+   * \brief The connection of an additional adaptation set failed or closed, its segment is requested again.
+   */
+  void AdditionalSetClosed (Ptr<Socket> socket);
+  void HandleAdditionalRead (Ptr<Socket> socket);
+  /**
+   * \return true if every additional adaptation set has the segment in its buffer
+   */
+  bool AdditionalSetsReady (int64_t segmentIndex) const;
+  /**
+   * \brief Start or resume playback held by an additional adaptation set, once all sets caught up.
+   */
+  void ResumePlayback ();
   /**
    * \brief Handle a packet reception.
    *
@@ -169,18 +435,49 @@ private:
    * \brief triggered by SetConnectCallback if a connection to a host could not be established.
    */
   void ConnectionFailed (Ptr<Socket> socket);
+  /**
+   * \brief triggered by SetCloseCallbacks when a server closed the connection or it broke down.
+   */
+  void ConnectionClosed (Ptr<Socket> socket);
+
+  /**
+   * \return the index of the server to send the next request to, -1 if every server failed recently
+   */
+  int32_t SelectServer ();
+  /**
+   * \return the index of the server the socket is connected to, -1 if it is none of the current connections
+   */
+  int32_t FindServer (Ptr<Socket> socket) const;
+  /**
+   * \brief Open a connection to the server, the request waiting for it is sent when it is established.
+   */
+  void ConnectServer (uint32_t server);
+  void CloseServer (uint32_t server);
+  /**
+   * \brief Send the prepared request to the current server, connecting to it first if needed.
+   */
+  void SendToServer ();
+  /**
+   * \brief Mark the current server as failed and repeat the outstanding request on another one.
+   */
+  void Failover ();
+  /**
+   * \brief Choose a server after a failover, waiting for the first retry if every server failed.
+   */
+  void ResumeAfterFailover ();
+  /**
+   * \brief No data of the outstanding request arrived for RequestTimeout.
+   */
+  void RequestTimedOut ();
+  /**
+   * \brief A bitrate hint arrived on the assistance channel, it is added to m_assistanceData.
+   */
+  void HandleAssistance (Ptr<Socket> socket);
   /**
    * Called after a segment was completely received from the server, meaning that the received number
    * of bytes == the requested number of bytes. Throughput data and buffer data is logged.
    */
   void SegmentReceivedHandle ();
-  /**
-   * \brief Read in bitrate values
-   *
-   * The test bitrate values to be read must be provided in bytes in absolute sizes (not per second!)
-   * as a 2x2 matrix, with spaces separating the segment sizes and newlines for every representation level.
-   */
-  int ReadInBitrateValues (std::string segmentSizeFile);
   /*
    * \brief Controls / simulates playback process
    *
@@ -266,16 +563,98 @@ private:
   */
   void log_QoE();
 
+  /**
+   * \brief Write the histograms of the session to clientX_histograms.txt, if RecordHistograms is set.
+   */
+  void LogHistograms ();
+
   uint32_t m_dataSize; //!< packet payload size
   uint8_t *m_data; //!< packet payload data
 
-  Ptr<Socket> m_socket; //!< Socket
+  /**
+   * \brief A server the client can send its requests to.
+   */
+  struct streamServer
+  {
+    Address address; //!< Address of the server
+    uint16_t port; //!< Port of the server
+    double weight; //!< Share of the requests with weighted selection
+    Ptr<Socket> socket; //!< Connection to the server, null if closed
+    bool connected; //!< The connection is established
+    bool failed; //!< The server failed and is skipped until retryAt
+    Time retryAt; //!< When a failed server is tried again
+    double rtt; //!< Smoothed time from request to first byte in microseconds, negative while unknown
+    double throughput; //!< Smoothed segment throughput in bit/s, negative while unknown
+  };
+
   Address m_peerAddress; //!< Remote peer address
   uint16_t m_peerPort; //!< Remote peer port
+  std::vector<streamServer> m_servers; //!< Servers to choose from, the remote peer if none were added
+  uint32_t m_currentServer; //!< Index of the server of the current request
+  bool m_serverChosen; //!< m_currentServer was chosen for the next request already (at start or by a failover)
+  uint32_t m_nextServer; //!< Next server in turn with round robin selection
+  serverSelection m_serverSelection; //!< How the server of a request is chosen
+  Time m_requestTimeout; //!< A request without progress for this long fails over, 0 to wait for TCP only
+  Time m_serverRetry; //!< How long a failed server is skipped
+  bool m_running; //!< The application (or session) was started and not stopped
+  bool m_controllerStarted; //!< The first connection was established and the controller was started
+  bool m_requestOutstanding; //!< A request was prepared and its segment is not complete yet
+  bool m_requestPending; //!< The outstanding request waits for the connection to its server
+  uint64_t m_serverRequestSent; //!< Point in time in microseconds the request was sent to the current server
+  int64_t m_lastProgress; //!< Point in time in microseconds of the last request or data of the current server
+  bool m_failingOver; //!< A failover is running and the new server did not answer yet
+  uint32_t m_failedServer; //!< The server the running failover started from
+  int64_t m_outageStart; //!< Point in time in microseconds of the last progress before the failover
+  EventId m_timeoutEvent; //!< Pending request timeout
+  EventId m_failoverEvent; //!< Pending retry when every server failed
+  uint16_t m_assistancePort; //!< UDP port bitrate hints are received on, 0 for no assistance channel
+  Ptr<Socket> m_assistanceSocket; //!< Socket receiving the bitrate hints
+
+  /**
+   * \brief Bytes of a segment received from a multicast group before the client asked for it.
+   */
+  struct multicastSegment
+  {
+    int64_t bytes; //!< Bytes received
+    int64_t firstArrival; //!< Point in time in microseconds the first datagram arrived
+    int64_t lastArrival; //!< Point in time in microseconds the last datagram arrived
+  };
 
-  uint16_t m_clientId; //!< The Id of this client, for logging purposes
-  uint16_t m_simulationId; //!< The Id of this simulation, for logging purposes
-  uint16_t m_numberOfClients; //!< The total number of clients for this simulation, for logging purposes
+  Address m_multicastAddress; //!< Address of the multicast replicator, segments are requested over unicast only if unset
+  uint16_t m_multicastControlPort; //!< Port the replicator accepts subscriptions on
+  Time m_repairTimeout; //!< The current segment is repaired if its group delivered nothing for this long
+  Ptr<Socket> m_multicastSocket; //!< Socket subscribing to the groups and receiving their datagrams
+  int64_t m_joinedRep; //!< Representation whose group the client subscribed to, -1 for none
+  bool m_multicastWait; //!< The current segment is expected from the group, no unicast request is outstanding
+  int64_t m_requestOffset; //!< Bytes of the current segment received before the outstanding unicast request
+  EventId m_repairEvent; //!< Pending repair (or completion, if it was received ahead) of the current segment
+  std::map<std::pair<int64_t, int64_t>, multicastSegment> m_multicastSegments; //!< Segments (and representations) received ahead
+
+  /**
+   * \brief An adaptation set besides the video (e.g. audio), downloaded over a connection of its own.
+   *
+   * Its buffer holds the segments before segmentCounter that were not played yet.
+   */
+  struct adaptationSet
+  {
+    std::shared_ptr<const videoData> data; //!< Segment sizes of the set
+    Ptr<Socket> socket; //!< Connection to the server, null if closed
+    uint32_t server; //!< Index of the server the connection goes to
+    bool connected; //!< The connection is established
+    bool downloading; //!< A segment was requested and is not complete yet
+    int64_t segmentCounter; //!< Index of the next segment to download
+    int64_t repIndex; //!< Representation of the segment being downloaded
+    int64_t bytesReceived; //!< Bytes of the segment being downloaded
+  };
+
+  std::string m_additionalSetFiles; //!< Comma separated segment size files of the additional adaptation sets
+  std::vector<adaptationSet> m_additionalSets; //!< Additional adaptation sets of the session
+  int64_t m_additionalBytes; //!< Bytes of the additional sets received in the session
+  int64_t m_additionalBytesAtRequest; //!< m_additionalBytes when the current video segment was requested
+
+  uint32_t m_clientId; //!< The Id of this client, for logging purposes
+  uint32_t m_simulationId; //!< The Id of this simulation, for logging purposes
+  uint32_t m_numberOfClients; //!< The total number of clients for this simulation, for logging purposes
   std::string m_segmentSizeFilePath; //!< The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes
   std::string m_algoName;//!< Name of the apation algorithm's class which this client will use for the simulation
   bool m_bufferUnderrun; //!< True if there is currently a buffer underrun in the simulated playback
@@ -297,20 +676,48 @@ private:
   std::ofstream bufferLog; //!< Output stream for logging buffer course
   std::ofstream throughputLog; //!< Output stream for logging throughput information
   std::ofstream bufferUnderrunLog; //!< Output stream for logging starting and ending of buffer underruns
+  EventId m_requestEvent; //!< Pending segment request delayed by the adaptation algorithm
+  Ptr<TcpStreamAvailabilityNotifier> m_availability; //!< Wakes the clients of the stream waiting for a segment
+  TcpStreamAvailabilityNotifier::waitId m_availabilityWait; //!< Pending wait for the availability of a segment
+  bool m_waitingForAvailability; //!< True while m_availabilityWait is pending
+  Time m_requestJitter; //!< Window after the availability of a segment over which requests are spread
+  requestTiming m_requestTiming; //!< How requests are spread over m_requestJitter
+  Ptr<UniformRandomVariable> m_jitter; //!< Draws the request jitter
+  EventId m_playbackEvent; //!< Pending end of the playback of a segment
+  Time m_availabilityOffset; //!< Point in time at which the first segment became available
+  Callback<void, Ptr<TcpStreamClient> > m_sessionEndCallback; //!< Invoked when the end of the content was played
+  bool m_recordAbrInputs; //!< True if the inputs of every adaptation decision are recorded to m_abrTrace
+  AbrTraceRecorder m_abrTrace; //!< Binary trace of the adaptation algorithm inputs, for offline replay
+  bool m_recordHistograms; //!< True if latencies and stall durations are recorded to m_histograms
+  streamHistograms m_histograms; //!< Histograms of latencies and stall durations
+
+  TracedCallback<uint32_t, Time> m_bufferLevelTrace; //!< Trace of the buffer level
+  TracedCallback<uint32_t, int64_t, int64_t> m_representationTrace; //!< Trace of the chosen representations
+  TracedCallback<uint32_t, int64_t, int64_t, int64_t> m_downloadStartTrace; //!< Trace of the first byte of a segment arriving
+  TracedCallback<uint32_t, int64_t, int64_t, int64_t, Time> m_downloadEndTrace; //!< Trace of completed segment downloads
+  TracedCallback<uint32_t, int64_t> m_stallStartTrace; //!< Trace of buffer underruns starting
+  TracedCallback<uint32_t, Time> m_stallEndTrace; //!< Trace of buffer underruns ending
+  TracedCallback<uint32_t, int64_t, Time> m_liveLatencyTrace; //!< Trace of the live latency at the playback start of every segment
+  TracedCallback<uint32_t, double> m_throughputTrace; //!< Trace of the throughput measured per segment
+  TracedCallback<uint32_t, uint32_t, uint32_t, Time> m_failoverTrace; //!< Trace of failovers to another server
+  TracedCallback<uint32_t, double> m_assistanceTrace; //!< Trace of the received bitrate hints
+  TracedCallback<uint32_t, int64_t, int64_t, int64_t> m_repairTrace; //!< Trace of the unicast repairs of multicast segments
+  TracedCallback<uint32_t, uint32_t, int64_t, int64_t, int64_t> m_setDownloadEndTrace; //!< Trace of completed segments of additional adaptation sets
 
   uint64_t m_downloadRequestSent; //!< Logging the point in time in microseconds when a download request was sent to the server
 
   throughputData m_throughput; //!< Tracking the throughput
   bufferData m_bufferData; //!< Keep track of the buffer level
   playbackData m_playbackData; //!< Tracking the simulated playback of segments
-  videoData m_videoData; //!< Information about segment sizes, average bitrates of representation levels and segment duration in microseconds
+  assistanceData m_assistanceData; //!< Bitrate hints pushed by the network
+  std::shared_ptr<const videoData> m_videoData; //!< Information about segment sizes, average bitrates of representation levels and segment duration in microseconds, shared with other clients
 
   bool playbackStarted;
   int64_t chunk; //Number of chunks in a segment, if 0 segments have no chunks. Chunks can be played as soon as fetched, but the quality can be only changed at segment level
   int playbackStart; //Number of segments/chunks to be fetched before playback begins.
   int cmaf; //0: ABRs are dealing with chunks, 1: ABRs are dealing with segments, 2: ABRs optimized
 
-  int logLevel; //Logging level: 0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency
+  int logLevel; //Logging level: 0: All, 1: Only playback and stalls, 2: Only QoE metrics: Avg Quality Lvl, Quality S.D., Rebuffer Ratio and Rebuffer Frequency, 3: None, trace sources only
 
   int stallsTotal;
   double stallsTime;
@@ -0,0 +1,541 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-edge-server.h"
+#include <algorithm>
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/address-utils.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/socket.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/packet.h"
+#include "ns3/trace-source-accessor.h"
+#include "tcp-stream-profiler.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamEdgeServerApplication");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpStreamEdgeServer);
+
+TcpStreamSegmentCache::TcpStreamSegmentCache ()
+  : m_capacity (0),
+    m_policy (lru),
+    m_size (0),
+    m_clock (0),
+    m_evictions (0)
+{
+}
+
+void
+TcpStreamSegmentCache::SetCapacity (uint64_t bytes)
+{
+  m_capacity = bytes;
+}
+
+void
+TcpStreamSegmentCache::SetPolicy (replacementPolicy policy)
+{
+  m_policy = policy;
+}
+
+TcpStreamSegmentCache::rank
+TcpStreamSegmentCache::Rank (const segmentKey & key, const entry & e) const
+{
+  if (m_policy == lfu)
+    {
+      return rank (std::make_pair (e.frequency, e.lastAccess), key);
+    }
+  return rank (std::make_pair (e.lastAccess, (uint64_t) 0), key);
+}
+
+void
+TcpStreamSegmentCache::Touch (const segmentKey & key, entry & e)
+{
+  m_order.erase (Rank (key, e));
+  e.frequency++;
+  e.lastAccess = ++m_clock;
+  m_order.insert (Rank (key, e));
+}
+
+bool
+TcpStreamSegmentCache::Lookup (const segmentKey & key)
+{
+  std::map<segmentKey, entry>::iterator it = m_entries.find (key);
+  if (it == m_entries.end ())
+    {
+      return false;
+    }
+  Touch (key, it->second);
+  return true;
+}
+
+bool
+TcpStreamSegmentCache::Insert (const segmentKey & key, uint64_t bytes)
+{
+  if (bytes > m_capacity || m_entries.find (key) != m_entries.end ())
+    {
+      return false;
+    }
+  while (m_size + bytes > m_capacity)
+    {
+      const segmentKey victim = m_order.begin ()->second;
+      m_order.erase (m_order.begin ());
+      m_size -= m_entries[victim].bytes;
+      m_entries.erase (victim);
+      m_evictions++;
+    }
+  entry e;
+  e.bytes = bytes;
+  e.frequency = 1;
+  e.lastAccess = ++m_clock;
+  m_entries[key] = e;
+  m_order.insert (Rank (key, e));
+  m_size += bytes;
+  return true;
+}
+
+uint64_t
+TcpStreamSegmentCache::GetSize () const
+{
+  return m_size;
+}
+
+uint64_t
+TcpStreamSegmentCache::GetEvictions () const
+{
+  return m_evictions;
+}
+
+TypeId
+TcpStreamEdgeServer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpStreamEdgeServer")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TcpStreamEdgeServer> ()
+    .AddAttribute ("Port", "Port on which we listen for incoming connections of clients.",
+                   UintegerValue (80),
+                   MakeUintegerAccessor (&TcpStreamEdgeServer::m_port),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("OriginAddress",
+                   "The address of the origin TcpStreamServer",
+                   AddressValue (),
+                   MakeAddressAccessor (&TcpStreamEdgeServer::m_originAddress),
+                   MakeAddressChecker ())
+    .AddAttribute ("OriginPort",
+                   "The port of the origin TcpStreamServer",
+                   UintegerValue (80),
+                   MakeUintegerAccessor (&TcpStreamEdgeServer::m_originPort),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("CacheCapacity",
+                   "Capacity of the segment cache in bytes",
+                   UintegerValue (100000000),
+                   MakeUintegerAccessor (&TcpStreamEdgeServer::m_capacity),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("ReplacementPolicy",
+                   "Which segment is evicted from a full cache: LRU (least recently used) or LFU (least frequently used)",
+                   EnumValue (TcpStreamSegmentCache::lru),
+                   MakeEnumAccessor (&TcpStreamEdgeServer::m_policy),
+                   MakeEnumChecker (TcpStreamSegmentCache::lru, "LRU",
+                                    TcpStreamSegmentCache::lfu, "LFU"))
+    .AddAttribute ("StopWhenIdle",
+                   "Stop the simulation when the last connected client closed its connection",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpStreamEdgeServer::m_stopWhenIdle),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("CacheAccess",
+                     "A client requested a segment, found in the cache or not",
+                     MakeTraceSourceAccessor (&TcpStreamEdgeServer::m_cacheAccessTrace),
+                     "ns3::TcpStreamEdgeServer::CacheAccessCallback")
+  ;
+  return tid;
+}
+
+TcpStreamEdgeServer::TcpStreamEdgeServer ()
+  : m_uncacheable (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_metrics.requests = 0;
+  m_metrics.hits = 0;
+  m_metrics.coalesced = 0;
+  m_metrics.misses = 0;
+  m_metrics.bytesServed = 0;
+  m_metrics.bytesFromCache = 0;
+  m_metrics.originBytes = 0;
+  m_metrics.evictions = 0;
+}
+
+TcpStreamEdgeServer::~TcpStreamEdgeServer ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpStreamEdgeServer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_socket = 0;
+  m_origins.clear ();
+  m_idleOrigins.clear ();
+  m_waiting.clear ();
+  Application::DoDispose ();
+}
+
+edgeCacheMetrics
+TcpStreamEdgeServer::GetCacheMetrics () const
+{
+  edgeCacheMetrics metrics = m_metrics;
+  metrics.evictions = m_cache.GetEvictions ();
+  return metrics;
+}
+
+void
+TcpStreamEdgeServer::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_cache.SetCapacity (m_capacity);
+  m_cache.SetPolicy (m_policy);
+  if (m_socket == 0)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+      m_socket = Socket::CreateSocket (GetNode (), tid);
+      m_socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), m_port));
+      m_socket->Listen ();
+    }
+  m_socket->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                               MakeCallback (&TcpStreamEdgeServer::HandleAccept, this));
+  m_socket->SetCloseCallbacks (MakeCallback (&TcpStreamEdgeServer::HandlePeerClose, this),
+                               MakeCallback (&TcpStreamEdgeServer::HandlePeerError, this));
+}
+
+void
+TcpStreamEdgeServer::StopApplication ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_socket != 0)
+    {
+      m_socket->Close ();
+    }
+  for (std::map<Ptr<Socket>, originFetch>::iterator it = m_origins.begin (); it != m_origins.end (); ++it)
+    {
+      it->first->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      it->first->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (), MakeNullCallback<void, Ptr<Socket> > ());
+      it->first->Close ();
+    }
+}
+
+void
+TcpStreamEdgeServer::HandleAccept (Ptr<Socket> socket, const Address& from)
+{
+  NS_LOG_FUNCTION (this << socket << from);
+  callbackData cbd;
+  cbd.currentTxBytes = 0;
+  cbd.packetSizeToReturn = 0;
+  cbd.send = false;
+  m_callbackData [from] = cbd;
+  m_connectedClients.push_back (from);
+  socket->SetRecvCallback (MakeCallback (&TcpStreamEdgeServer::HandleRead, this));
+  socket->SetSendCallback (MakeCallback (&TcpStreamEdgeServer::HandleSend, this));
+}
+
+void
+TcpStreamEdgeServer::HandleRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  DashProfilerScope profile ("Edge", "HandleRead");
+  Ptr<Packet> packet = socket->Recv ();
+  if (packet == 0 || packet->GetSize () == 0)
+    {
+      return;
+    }
+  // "bytes segmentIndex repIndex", older clients only send the size
+  std::string request (packet->GetSize (), '\0');
+  packet->CopyData ((uint8_t *) &request[0], packet->GetSize ());
+  std::istringstream ss (request.c_str ());
+  int64_t bytes = 0;
+  int64_t segmentIndex = -1;
+  int64_t repIndex = -1;
+  ss >> bytes;
+  if (!(ss >> segmentIndex >> repIndex) || segmentIndex < 0)
+    {
+      segmentIndex = -1 - m_uncacheable++;
+      repIndex = -1;
+    }
+  TcpStreamSegmentCache::segmentKey key (segmentIndex, repIndex);
+
+  m_metrics.requests++;
+  m_metrics.bytesServed += bytes;
+  if (m_cache.Lookup (key))
+    {
+      m_metrics.hits++;
+      m_metrics.bytesFromCache += bytes;
+      m_cacheAccessTrace (segmentIndex, repIndex, true);
+      Serve (socket, bytes);
+      return;
+    }
+  m_cacheAccessTrace (segmentIndex, repIndex, false);
+  std::map<TcpStreamSegmentCache::segmentKey, std::vector<std::pair<Ptr<Socket>, uint32_t> > >::iterator waiting = m_waiting.find (key);
+  if (waiting != m_waiting.end ())
+    {
+      // a fetch of this segment is running already
+      m_metrics.coalesced++;
+      waiting->second.push_back (std::make_pair (socket, (uint32_t) bytes));
+      return;
+    }
+  m_metrics.misses++;
+  m_waiting[key].push_back (std::make_pair (socket, (uint32_t) bytes));
+  Fetch (key, bytes);
+}
+
+void
+TcpStreamEdgeServer::Serve (Ptr<Socket> socket, uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << socket << bytes);
+  Address from;
+  socket->GetPeerName (from);
+  std::map<Address, callbackData>::iterator it = m_callbackData.find (from);
+  if (it == m_callbackData.end ())
+    {
+      return;
+    }
+  it->second.currentTxBytes = 0;
+  it->second.packetSizeToReturn = bytes;
+  it->second.send = true;
+  HandleSend (socket, socket->GetTxAvailable ());
+}
+
+void
+TcpStreamEdgeServer::HandleSend (Ptr<Socket> socket, uint32_t txSpace)
+{
+  DashProfilerScope profile ("Edge", "HandleSend");
+  Address from;
+  socket->GetPeerName (from);
+  std::map<Address, callbackData>::iterator it = m_callbackData.find (from);
+  if (it == m_callbackData.end () || !it->second.send)
+    {
+      return;
+    }
+  callbackData & data = it->second;
+  while (data.currentTxBytes < data.packetSizeToReturn && socket->GetTxAvailable () > 0)
+    {
+      uint32_t toSend = std::min (socket->GetTxAvailable (), data.packetSizeToReturn - data.currentTxBytes);
+      int amountSent = socket->Send (Create<Packet> (toSend), 0);
+      if (amountSent <= 0)
+        {
+          // the send buffer is full, HandleSend is called again when space has freed up
+          return;
+        }
+      data.currentTxBytes += amountSent;
+    }
+  if (data.currentTxBytes == data.packetSizeToReturn)
+    {
+      data.currentTxBytes = 0;
+      data.packetSizeToReturn = 0;
+      data.send = false;
+    }
+}
+
+void
+TcpStreamEdgeServer::Fetch (const TcpStreamSegmentCache::segmentKey & key, uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << key.first << key.second << bytes);
+  Ptr<Socket> origin;
+  if (!m_idleOrigins.empty ())
+    {
+      origin = m_idleOrigins.back ();
+      m_idleOrigins.pop_back ();
+    }
+  else
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::TcpSocketFactory");
+      origin = Socket::CreateSocket (GetNode (), tid);
+      if (Ipv4Address::IsMatchingType (m_originAddress))
+        {
+          origin->Connect (InetSocketAddress (Ipv4Address::ConvertFrom (m_originAddress), m_originPort));
+        }
+      else if (Ipv6Address::IsMatchingType (m_originAddress))
+        {
+          origin->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom (m_originAddress), m_originPort));
+        }
+      origin->SetConnectCallback (MakeCallback (&TcpStreamEdgeServer::OriginConnected, this),
+                                  MakeCallback (&TcpStreamEdgeServer::OriginFailed, this));
+      origin->SetRecvCallback (MakeCallback (&TcpStreamEdgeServer::HandleOriginRead, this));
+      origin->SetCloseCallbacks (MakeCallback (&TcpStreamEdgeServer::OriginFailed, this),
+                                 MakeCallback (&TcpStreamEdgeServer::OriginFailed, this));
+      m_origins[origin].connected = false;
+    }
+  originFetch & fetch = m_origins[origin];
+  fetch.key = key;
+  fetch.bytes = bytes;
+  fetch.received = 0;
+  fetch.active = true;
+  if (fetch.connected)
+    {
+      SendOriginRequest (origin);
+    }
+}
+
+void
+TcpStreamEdgeServer::SendOriginRequest (Ptr<Socket> origin)
+{
+  const originFetch & fetch = m_origins[origin];
+  std::ostringstream request;
+  request << fetch.bytes << " " << fetch.key.first << " " << fetch.key.second;
+  std::string message = request.str ();
+  origin->Send (Create<Packet> ((const uint8_t *) message.c_str (), message.size () + 1));
+}
+
+void
+TcpStreamEdgeServer::OriginConnected (Ptr<Socket> origin)
+{
+  NS_LOG_FUNCTION (this << origin);
+  originFetch & fetch = m_origins[origin];
+  fetch.connected = true;
+  if (fetch.active)
+    {
+      SendOriginRequest (origin);
+    }
+}
+
+void
+TcpStreamEdgeServer::OriginFailed (Ptr<Socket> origin)
+{
+  NS_LOG_FUNCTION (this << origin);
+  std::map<Ptr<Socket>, originFetch>::iterator it = m_origins.find (origin);
+  if (it == m_origins.end ())
+    {
+      return;
+    }
+  NS_LOG_ERROR ("Edge server lost the connection to the origin.");
+  originFetch fetch = it->second;
+  m_origins.erase (it);
+  origin->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  m_idleOrigins.erase (std::remove (m_idleOrigins.begin (), m_idleOrigins.end (), origin), m_idleOrigins.end ());
+  if (!fetch.active)
+    {
+      return;
+    }
+
+  // the segment will not arrive: close the connections of the clients waiting for it, so they repeat their
+  // request (on another server, if they have one) instead of waiting forever, and later requests start a new fetch
+  std::vector<std::pair<Ptr<Socket>, uint32_t> > waiting;
+  std::map<TcpStreamSegmentCache::segmentKey, std::vector<std::pair<Ptr<Socket>, uint32_t> > >::iterator w = m_waiting.find (fetch.key);
+  if (w != m_waiting.end ())
+    {
+      waiting.swap (w->second);
+      m_waiting.erase (w);
+    }
+  for (uint32_t i = 0; i < waiting.size (); i++)
+    {
+      Ptr<Socket> client = waiting[i].first;
+      Address from;
+      client->GetPeerName (from);
+      m_callbackData.erase (from);
+      m_connectedClients.erase (std::remove (m_connectedClients.begin (), m_connectedClients.end (), from), m_connectedClients.end ());
+      client->Close ();
+    }
+}
+
+void
+TcpStreamEdgeServer::HandleOriginRead (Ptr<Socket> origin)
+{
+  NS_LOG_FUNCTION (this << origin);
+  DashProfilerScope profile ("Edge", "HandleOriginRead");
+  originFetch & fetch = m_origins[origin];
+  Ptr<Packet> packet;
+  while ((packet = origin->Recv ()))
+    {
+      fetch.received += packet->GetSize ();
+      m_metrics.originBytes += packet->GetSize ();
+    }
+  if (!fetch.active || fetch.received < fetch.bytes)
+    {
+      return;
+    }
+
+  // the segment is complete: cache it and answer all clients waiting for it
+  fetch.active = false;
+  TcpStreamSegmentCache::segmentKey key = fetch.key;
+  if (key.first >= 0)
+    {
+      m_cache.Insert (key, fetch.bytes);
+    }
+  m_idleOrigins.push_back (origin);
+  std::vector<std::pair<Ptr<Socket>, uint32_t> > waiting;
+  std::map<TcpStreamSegmentCache::segmentKey, std::vector<std::pair<Ptr<Socket>, uint32_t> > >::iterator it = m_waiting.find (key);
+  if (it != m_waiting.end ())
+    {
+      waiting.swap (it->second);
+      m_waiting.erase (it);
+    }
+  for (uint32_t i = 0; i < waiting.size (); i++)
+    {
+      Serve (waiting[i].first, waiting[i].second);
+    }
+}
+
+void
+TcpStreamEdgeServer::HandlePeerClose (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Address from;
+  socket->GetPeerName (from);
+  for (std::vector<Address>::iterator it = m_connectedClients.begin (); it != m_connectedClients.end (); ++it)
+    {
+      if (*it == from)
+        {
+          socket->Close ();
+          m_callbackData.erase (from);
+          m_connectedClients.erase (it);
+          // the client does not wait for running fetches anymore
+          for (std::map<TcpStreamSegmentCache::segmentKey, std::vector<std::pair<Ptr<Socket>, uint32_t> > >::iterator w = m_waiting.begin (); w != m_waiting.end (); ++w)
+            {
+              for (uint32_t i = 0; i < w->second.size (); )
+                {
+                  if (w->second[i].first == socket)
+                    {
+                      w->second.erase (w->second.begin () + i);
+                    }
+                  else
+                    {
+                      i++;
+                    }
+                }
+            }
+          if (m_stopWhenIdle && m_connectedClients.size () == 0)
+            {
+              Simulator::Stop ();
+            }
+          return;
+        }
+    }
+}
+
+void
+TcpStreamEdgeServer::HandlePeerError (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+}
+
+} // namespace ns3
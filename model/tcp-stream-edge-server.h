@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_EDGE_SERVER_H
+#define TCP_STREAM_EDGE_SERVER_H
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+#include "ns3/application.h"
+#include "ns3/address.h"
+#include "ns3/ptr.h"
+#include "ns3/traced-callback.h"
+#include "tcp-stream-server.h"
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup tcpStream
+ * \brief Byte-bounded cache of segments, identified by segment and representation index.
+ *
+ * LRU evicts the segment accessed longest ago, LFU the segment accessed least often since it was cached
+ * (ties broken by age). Both keep their order in a sorted index, so lookups and evictions cost O(log n).
+ */
+class TcpStreamSegmentCache
+{
+public:
+  /**
+   * \brief Replacement policy of the cache.
+   */
+  enum replacementPolicy
+  {
+    lru, lfu
+  };
+
+  typedef std::pair<int64_t, int64_t> segmentKey; //!< segment index and representation index
+
+  TcpStreamSegmentCache ();
+
+  void SetCapacity (uint64_t bytes);
+  void SetPolicy (replacementPolicy policy);
+
+  /**
+   * \return true if the segment is cached, counting it as accessed
+   */
+  bool Lookup (const segmentKey & key);
+
+  /**
+   * \brief Add a segment, evicting others until it fits. Segments larger than the capacity are not cached.
+   * \return true if the segment was cached
+   */
+  bool Insert (const segmentKey & key, uint64_t bytes);
+
+  uint64_t GetSize () const;
+  uint64_t GetEvictions () const;
+
+private:
+  /**
+   * \brief A cached segment.
+   */
+  struct entry
+  {
+    uint64_t bytes; //!< Size of the segment
+    uint64_t frequency; //!< Accesses since it was cached
+    uint64_t lastAccess; //!< Logical time of the last access
+  };
+  typedef std::pair<std::pair<uint64_t, uint64_t>, segmentKey> rank; //!< eviction order, smallest first
+
+  rank Rank (const segmentKey & key, const entry & e) const;
+  void Touch (const segmentKey & key, entry & e);
+
+  uint64_t m_capacity; //!< Capacity in bytes
+  replacementPolicy m_policy; //!< Replacement policy
+  uint64_t m_size; //!< Bytes cached
+  uint64_t m_clock; //!< Logical time, advanced by every access
+  uint64_t m_evictions; //!< Number of evicted segments
+  std::map<segmentKey, entry> m_entries; //!< Cached segments
+  std::set<rank> m_order; //!< Cached segments in eviction order
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Cache statistics of a TcpStreamEdgeServer.
+ */
+struct edgeCacheMetrics
+{
+  uint64_t requests; //!< Requests of clients
+  uint64_t hits; //!< Requests served from the cache
+  uint64_t coalesced; //!< Missed requests joining a fetch of the same segment already running
+  uint64_t misses; //!< Requests that started a fetch from the origin
+  uint64_t bytesServed; //!< Bytes requested by clients
+  uint64_t bytesFromCache; //!< Bytes requested by clients and found in the cache
+  uint64_t originBytes; //!< Bytes fetched from the origin (its egress)
+  uint64_t evictions; //!< Segments evicted from the cache
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Edge cache between TcpStreamClients and an origin TcpStreamServer.
+ *
+ * Clients connect to the edge instead of the origin. A request for a cached segment is answered at once.
+ * On a miss, the edge fetches the segment from the origin over a connection of its own (one connection per
+ * concurrent fetch, kept open for reuse) and answers once the segment is complete; requests for a segment
+ * already being fetched wait for that fetch instead of starting another one. Segments are identified by
+ * the segment and representation index the clients send with their requests, requests without them are
+ * relayed to the origin without caching.
+ */
+class TcpStreamEdgeServer : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Signature of the CacheAccess trace source.
+   * \param segmentIndex the index of the requested segment
+   * \param repIndex the representation of the requested segment
+   * \param hit true if the segment was cached
+   */
+  typedef void (* CacheAccessCallback)(int64_t segmentIndex, int64_t repIndex, bool hit);
+
+  TcpStreamEdgeServer ();
+  virtual ~TcpStreamEdgeServer ();
+
+  /**
+   * \return the cache statistics since the edge started
+   */
+  edgeCacheMetrics GetCacheMetrics () const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  void HandleAccept (Ptr<Socket> socket, const Address& from);
+  void HandleRead (Ptr<Socket> socket);
+  void HandleSend (Ptr<Socket> socket, uint32_t txSpace);
+  void HandlePeerClose (Ptr<Socket> socket);
+  void HandlePeerError (Ptr<Socket> socket);
+
+  /**
+   * \brief Start answering a request of the given size on the client socket.
+   */
+  void Serve (Ptr<Socket> socket, uint32_t bytes);
+
+  /**
+   * \brief Fetch a segment from the origin, on an idle origin connection or a new one.
+   */
+  void Fetch (const TcpStreamSegmentCache::segmentKey & key, uint32_t bytes);
+  void SendOriginRequest (Ptr<Socket> origin);
+  void OriginConnected (Ptr<Socket> origin);
+  /**
+   * \brief The origin connection failed or closed, drop it and close the clients waiting for its fetch.
+   */
+  void OriginFailed (Ptr<Socket> origin);
+  void HandleOriginRead (Ptr<Socket> origin);
+
+  /**
+   * \brief State of a connection to the origin.
+   */
+  struct originFetch
+  {
+    TcpStreamSegmentCache::segmentKey key; //!< Segment being fetched
+    uint32_t bytes; //!< Size of the segment
+    uint32_t received; //!< Bytes of the segment received
+    bool connected; //!< The connection is established
+    bool active; //!< A fetch is running on the connection
+  };
+
+  uint16_t m_port; //!< Port clients connect to
+  Address m_originAddress; //!< Address of the origin server
+  uint16_t m_originPort; //!< Port of the origin server
+  uint64_t m_capacity; //!< Cache capacity in bytes
+  TcpStreamSegmentCache::replacementPolicy m_policy; //!< Cache replacement policy
+  bool m_stopWhenIdle; //!< Stop the simulation when the last client disconnected
+
+  Ptr<Socket> m_socket; //!< Listening socket
+  std::map<Address, callbackData> m_callbackData; //!< Answer in progress of every connected client
+  std::vector<Address> m_connectedClients; //!< Connected clients
+  TcpStreamSegmentCache m_cache; //!< The cached segments
+  std::map<Ptr<Socket>, originFetch> m_origins; //!< Connections to the origin
+  std::vector<Ptr<Socket> > m_idleOrigins; //!< Connections to the origin without a running fetch
+  std::map<TcpStreamSegmentCache::segmentKey, std::vector<std::pair<Ptr<Socket>, uint32_t> > > m_waiting; //!< Clients (and request sizes) waiting for a running fetch
+  int64_t m_uncacheable; //!< Counter giving every request without segment and representation index its own key
+  edgeCacheMetrics m_metrics; //!< Cache statistics
+  TracedCallback<int64_t, int64_t, bool> m_cacheAccessTrace; //!< Trace of cache hits and misses
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_EDGE_SERVER_H */
@@ -0,0 +1,296 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-egress-scheduler.h"
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/socket.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamEgressScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpStreamEgressScheduler);
+
+TypeId
+TcpStreamEgressScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpStreamEgressScheduler")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TcpStreamEgressScheduler> ()
+    .AddAttribute ("Rate",
+                   "Aggregate egress rate of the server, 0 for no cap",
+                   DataRateValue (DataRate (0)),
+                   MakeDataRateAccessor (&TcpStreamEgressScheduler::m_rate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("FlowRate",
+                   "Rate every connection is paced to, 0 for no pacing",
+                   DataRateValue (DataRate (0)),
+                   MakeDataRateAccessor (&TcpStreamEgressScheduler::m_flowRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Quantum",
+                   "Bytes a connection of weight 1 may write per deficit round robin visit",
+                   UintegerValue (14460),
+                   MakeUintegerAccessor (&TcpStreamEgressScheduler::m_quantum),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+TcpStreamEgressScheduler::TcpStreamEgressScheduler ()
+  : m_serving (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpStreamEgressScheduler::~TcpStreamEgressScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpStreamEgressScheduler::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_serviceEvent.Cancel ();
+  m_flows.clear ();
+  m_round.clear ();
+  m_paced.clear ();
+  m_transmit = MakeNullCallback<uint32_t, Ptr<Socket>, uint32_t> ();
+  Object::DoDispose ();
+}
+
+void
+TcpStreamEgressScheduler::SetTransmitCallback (Callback<uint32_t, Ptr<Socket>, uint32_t> transmit)
+{
+  m_transmit = transmit;
+}
+
+void
+TcpStreamEgressScheduler::SetWeight (Ipv4Address client, double weight)
+{
+  NS_LOG_FUNCTION (this << client << weight);
+  m_weights[client] = weight;
+}
+
+double
+TcpStreamEgressScheduler::GetWeight (Ptr<Socket> socket) const
+{
+  Address peer;
+  socket->GetPeerName (peer);
+  if (InetSocketAddress::IsMatchingType (peer))
+    {
+      std::map<Ipv4Address, double>::const_iterator it = m_weights.find (InetSocketAddress::ConvertFrom (peer).GetIpv4 ());
+      if (it != m_weights.end ())
+        {
+          return it->second;
+        }
+    }
+  return 1;
+}
+
+void
+TcpStreamEgressScheduler::Enqueue (Ptr<Socket> socket, uint64_t bytes)
+{
+  NS_LOG_FUNCTION (this << socket << bytes);
+  if (bytes == 0)
+    {
+      Remove (socket);
+      return;
+    }
+  std::map<Ptr<Socket>, flow>::iterator it = m_flows.find (socket);
+  if (it == m_flows.end ())
+    {
+      flow f;
+      f.weight = GetWeight (socket);
+      f.deficit = 0;
+      f.nextSend = Simulator::Now ();
+      f.inTurn = false;
+      f.blocked = false;
+      f.paced = false;
+      it = m_flows.insert (std::make_pair (socket, f)).first;
+      m_round.push_back (socket);
+    }
+  it->second.backlog = bytes;
+  if (it->second.blocked)
+    {
+      Unblock (socket, it->second);
+    }
+  if (!m_serving)
+    {
+      Service ();
+    }
+}
+
+void
+TcpStreamEgressScheduler::Wake (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  std::map<Ptr<Socket>, flow>::iterator it = m_flows.find (socket);
+  // flows in the round or paced are served anyway, only a blocked flow needs the service
+  if (it == m_flows.end () || !it->second.blocked)
+    {
+      return;
+    }
+  Unblock (socket, it->second);
+  if (!m_serving)
+    {
+      Service ();
+    }
+}
+
+void
+TcpStreamEgressScheduler::Unblock (Ptr<Socket> socket, flow & f)
+{
+  f.blocked = false;
+  m_round.push_back (socket);
+}
+
+void
+TcpStreamEgressScheduler::Remove (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  std::map<Ptr<Socket>, flow>::iterator it = m_flows.find (socket);
+  if (it == m_flows.end ())
+    {
+      return;
+    }
+  if (it->second.paced)
+    {
+      std::pair<std::multimap<Time, Ptr<Socket> >::iterator, std::multimap<Time, Ptr<Socket> >::iterator> range =
+        m_paced.equal_range (it->second.nextSend);
+      for (std::multimap<Time, Ptr<Socket> >::iterator p = range.first; p != range.second; ++p)
+        {
+          if (p->second == socket)
+            {
+              m_paced.erase (p);
+              break;
+            }
+        }
+    }
+  else if (!it->second.blocked)
+    {
+      m_round.remove (socket);
+    }
+  m_flows.erase (it);
+}
+
+void
+TcpStreamEgressScheduler::ScheduleService (Time at)
+{
+  if (m_serviceEvent.IsRunning () && m_serviceTime <= at)
+    {
+      return;
+    }
+  m_serviceEvent.Cancel ();
+  m_serviceTime = at;
+  m_serviceEvent = Simulator::Schedule (at - Simulator::Now (), &TcpStreamEgressScheduler::Service, this);
+}
+
+void
+TcpStreamEgressScheduler::Service ()
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  while (!m_paced.empty () && m_paced.begin ()->first <= now)
+    {
+      Ptr<Socket> socket = m_paced.begin ()->second;
+      m_paced.erase (m_paced.begin ());
+      m_flows[socket].paced = false;
+      m_round.push_back (socket);
+    }
+  if (now < m_nextSend)
+    {
+      ScheduleService (m_nextSend);
+      return;
+    }
+
+  m_serving = true;
+  // every iteration either writes or takes a flow out of the round, blocked flows are not visited again
+  while (!m_round.empty ())
+    {
+      Ptr<Socket> socket = m_round.front ();
+      flow & f = m_flows[socket];
+      if (!f.inTurn)
+        {
+          f.deficit += std::max (m_quantum * f.weight, 1.0);
+          f.inTurn = true;
+        }
+      uint32_t space = socket->GetTxAvailable ();
+      uint32_t allowed = (uint32_t) std::min ((double) std::min (f.backlog, (uint64_t) space), f.deficit);
+      uint32_t sent = allowed > 0 ? m_transmit (socket, allowed) : 0;
+      m_round.pop_front ();
+      if (sent == 0)
+        {
+          // served again when Wake reports free buffer space, without the deficit it could not use
+          f.blocked = true;
+          f.inTurn = false;
+          f.deficit = 0;
+          continue;
+        }
+      f.backlog -= std::min ((uint64_t) sent, f.backlog);
+      f.deficit -= sent;
+      if (f.backlog == 0)
+        {
+          m_flows.erase (socket);
+        }
+      else
+        {
+          if (f.deficit < 1)
+            {
+              // turn is over
+              f.inTurn = false;
+            }
+          if (m_flowRate.GetBitRate () > 0)
+            {
+              // a paced flow continues its turn when it rejoins the round
+              f.nextSend = now + m_flowRate.CalculateBytesTxTime (sent);
+              f.paced = true;
+              m_paced.insert (std::make_pair (f.nextSend, socket));
+            }
+          else if (f.inTurn)
+            {
+              m_round.push_front (socket);
+            }
+          else
+            {
+              m_round.push_back (socket);
+            }
+        }
+      if (m_rate.GetBitRate () > 0)
+        {
+          // the aggregate cap allows the next write only after this one left at the capped rate
+          m_nextSend = now + m_rate.CalculateBytesTxTime (sent);
+          m_serving = false;
+          if (!m_round.empty () || !m_paced.empty ())
+            {
+              ScheduleService (m_nextSend);
+            }
+          return;
+        }
+    }
+  m_serving = false;
+  if (!m_paced.empty ())
+    {
+      ScheduleService (m_paced.begin ()->first);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_EGRESS_SCHEDULER_H
+#define TCP_STREAM_EGRESS_SCHEDULER_H
+
+#include <stdint.h>
+#include <list>
+#include <map>
+#include "ns3/object.h"
+#include "ns3/callback.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+class Socket;
+
+/**
+ * \ingroup tcpStream
+ * \brief Server-side egress scheduler deciding which client connection may write how much into its socket.
+ *
+ * Without a scheduler, TcpStreamServer fills the send buffer of whichever socket has room and leaves the
+ * sharing of the bandwidth to TCP. With a scheduler, the server only announces its backlog per connection
+ * (Enqueue) and free send buffer space (Wake); the scheduler serves the backlogged connections with
+ * deficit round robin, where every visit adds Quantum times the weight of the client to its deficit. This
+ * approximates weighted fair queuing of the data written into the sockets.
+ *
+ * Rate caps the aggregate egress of the server (e.g. the egress limit of a CDN edge): after writing n
+ * bytes, the next write waits n * 8 / Rate seconds. FlowRate paces every connection on its own in the
+ * same way. With both at 0, the scheduler only orders the writes and the send buffers limit the sharing.
+ * Weights are assigned per client IPv4 address, clients without weight have weight 1.
+ *
+ * Connections with a full send buffer leave the round until their Wake, paced connections until their pacing
+ * allows the next write, so every Wake costs the same however many connections are backlogged. As an idle
+ * queue in deficit round robin, a connection leaving the round for lack of buffer space loses its deficit.
+ */
+class TcpStreamEgressScheduler : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpStreamEgressScheduler ();
+  virtual ~TcpStreamEgressScheduler ();
+
+  /**
+   * \brief Set the function writing data into a socket.
+   *
+   * The function is given the socket and the maximum number of bytes to write, and returns the number
+   * of bytes it wrote.
+   */
+  void SetTransmitCallback (Callback<uint32_t, Ptr<Socket>, uint32_t> transmit);
+
+  /**
+   * \brief Set the weight of the client with the given address.
+   */
+  void SetWeight (Ipv4Address client, double weight);
+
+  /**
+   * \brief A request of the given size arrived on the socket, it replaces the backlog of the socket.
+   */
+  void Enqueue (Ptr<Socket> socket, uint64_t bytes);
+
+  /**
+   * \brief Send buffer space became available on the socket, it rejoins the round if it was blocked.
+   */
+  void Wake (Ptr<Socket> socket);
+
+  /**
+   * \brief Forget the socket, e.g. because the connection was closed.
+   */
+  void Remove (Ptr<Socket> socket);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief State of a backlogged connection.
+   */
+  struct flow
+  {
+    uint64_t backlog; //!< Bytes left to write
+    double weight; //!< Share of the client
+    double deficit; //!< Bytes the flow may still write in the current round
+    Time nextSend; //!< Earliest time the flow may write again, with pacing
+    bool inTurn; //!< The flow got its quantum for the current visit
+    bool blocked; //!< Out of the round until Wake or Enqueue, its last write found no buffer space
+    bool paced; //!< Out of the round until nextSend, in m_paced
+  };
+
+  /**
+   * \brief Write data of the backlogged flows until they are blocked, the rate cap or pacing requires waiting.
+   */
+  void Service ();
+  /**
+   * \brief Put a blocked flow back at the end of the round.
+   */
+  void Unblock (Ptr<Socket> socket, flow & f);
+  void ScheduleService (Time at);
+  double GetWeight (Ptr<Socket> socket) const;
+
+  DataRate m_rate; //!< Aggregate egress rate, 0 for no cap
+  DataRate m_flowRate; //!< Rate every flow is paced to, 0 for no pacing
+  uint32_t m_quantum; //!< Bytes added to the deficit of a flow of weight 1 per round
+
+  Callback<uint32_t, Ptr<Socket>, uint32_t> m_transmit; //!< Writes data into a socket
+  std::map<Ipv4Address, double> m_weights; //!< Weights of the clients by address
+  std::map<Ptr<Socket>, flow> m_flows; //!< Backlogged flows
+  std::list<Ptr<Socket> > m_round; //!< Round robin order of the flows that may write, the head is served next
+  std::multimap<Time, Ptr<Socket> > m_paced; //!< Paced flows by the time they rejoin the round
+  Time m_nextSend; //!< Earliest time of the next write, with a rate cap
+  EventId m_serviceEvent; //!< Pending service
+  Time m_serviceTime; //!< Time of m_serviceEvent
+  bool m_serving; //!< Set during Service, to not reenter it from Wake or Enqueue
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_EGRESS_SCHEDULER_H */
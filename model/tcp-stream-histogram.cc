@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+LogLinearHistogram::LogLinearHistogram (uint32_t subBucketBits)
+  : m_subBucketBits (subBucketBits),
+    m_count (0),
+    m_sum (0),
+    m_min (0),
+    m_max (0)
+{
+  NS_ASSERT_MSG (subBucketBits >= 1 && subBucketBits < 32, "Invalid number of sub-bucket bits");
+}
+
+uint32_t
+LogLinearHistogram::GetIndex (int64_t value) const
+{
+  uint64_t v = value;
+  uint64_t subBuckets = (uint64_t) 1 << m_subBucketBits;
+  if (v < subBuckets)
+    {
+      return (uint32_t) v;
+    }
+  uint32_t msb = 63;
+  while (!(v >> msb))
+    {
+      msb--;
+    }
+  // keep the subBucketBits highest bits of the value: [half, subBuckets) shifted left by shift
+  uint32_t shift = msb - (m_subBucketBits - 1);
+  uint64_t half = subBuckets >> 1;
+  return (uint32_t) (subBuckets + (shift - 1) * half + ((v >> shift) - half));
+}
+
+int64_t
+LogLinearHistogram::GetLowerBound (uint32_t index) const
+{
+  uint64_t subBuckets = (uint64_t) 1 << m_subBucketBits;
+  if (index < subBuckets)
+    {
+      return index;
+    }
+  uint64_t half = subBuckets >> 1;
+  uint64_t shift = (index - subBuckets) / half + 1;
+  uint64_t top = (index - subBuckets) % half + half;
+  return (int64_t) (top << shift);
+}
+
+int64_t
+LogLinearHistogram::GetWidth (uint32_t index) const
+{
+  uint64_t subBuckets = (uint64_t) 1 << m_subBucketBits;
+  if (index < subBuckets)
+    {
+      return 1;
+    }
+  uint64_t half = subBuckets >> 1;
+  return (int64_t) 1 << ((index - subBuckets) / half + 1);
+}
+
+void
+LogLinearHistogram::Record (int64_t value)
+{
+  value = std::max (value, (int64_t) 0);
+  uint32_t index = GetIndex (value);
+  if (index >= m_counts.size ())
+    {
+      m_counts.resize (index + 1, 0);
+    }
+  m_counts[index]++;
+  m_min = m_count == 0 ? value : std::min (m_min, value);
+  m_max = m_count == 0 ? value : std::max (m_max, value);
+  m_count++;
+  m_sum += value;
+}
+
+void
+LogLinearHistogram::Merge (const LogLinearHistogram & other)
+{
+  NS_ASSERT_MSG (other.m_subBucketBits == m_subBucketBits, "Merging histograms of different precision");
+  if (other.m_count == 0)
+    {
+      return;
+    }
+  if (other.m_counts.size () > m_counts.size ())
+    {
+      m_counts.resize (other.m_counts.size (), 0);
+    }
+  for (uint32_t i = 0; i < other.m_counts.size (); i++)
+    {
+      m_counts[i] += other.m_counts[i];
+    }
+  m_min = m_count == 0 ? other.m_min : std::min (m_min, other.m_min);
+  m_max = m_count == 0 ? other.m_max : std::max (m_max, other.m_max);
+  m_count += other.m_count;
+  m_sum += other.m_sum;
+}
+
+void
+LogLinearHistogram::Reset ()
+{
+  std::vector<uint64_t> empty;
+  m_counts.swap (empty);
+  m_count = 0;
+  m_sum = 0;
+  m_min = 0;
+  m_max = 0;
+}
+
+uint64_t
+LogLinearHistogram::GetCount () const
+{
+  return m_count;
+}
+
+int64_t
+LogLinearHistogram::GetMin () const
+{
+  return m_min;
+}
+
+int64_t
+LogLinearHistogram::GetMax () const
+{
+  return m_max;
+}
+
+double
+LogLinearHistogram::GetMean () const
+{
+  return m_count > 0 ? m_sum / m_count : 0;
+}
+
+int64_t
+LogLinearHistogram::GetPercentile (double percentile) const
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  uint64_t rank = (uint64_t) std::ceil (percentile / 100 * m_count);
+  rank = std::max (rank, (uint64_t) 1);
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < m_counts.size (); i++)
+    {
+      seen += m_counts[i];
+      if (seen >= rank)
+        {
+          int64_t value = GetLowerBound (i) + GetWidth (i) / 2;
+          return std::min (std::max (value, m_min), m_max);
+        }
+    }
+  return m_max;
+}
+
+void
+LogLinearHistogram::Write (std::ostream & os, const std::string & name) const
+{
+  os << name << " " << m_subBucketBits << " " << m_count << " " << std::fixed << m_sum << " " << m_min << " " << m_max;
+  os.unsetf (std::ios_base::floatfield);
+  for (uint32_t i = 0; i < m_counts.size (); i++)
+    {
+      if (m_counts[i] > 0)
+        {
+          os << " " << i << ":" << m_counts[i];
+        }
+    }
+  os << "\n";
+}
+
+bool
+LogLinearHistogram::Read (std::istream & is, std::string & name)
+{
+  std::string line;
+  while (std::getline (is, line))
+    {
+      if (!line.empty ())
+        {
+          break;
+        }
+    }
+  if (line.empty ())
+    {
+      return false;
+    }
+  std::istringstream fields (line);
+  uint32_t subBucketBits;
+  if (!(fields >> name >> subBucketBits >> m_count >> m_sum >> m_min >> m_max) || subBucketBits < 1 || subBucketBits >= 32)
+    {
+      return false;
+    }
+  m_subBucketBits = subBucketBits;
+  m_counts.clear ();
+  std::string bucket;
+  while (fields >> bucket)
+    {
+      std::string::size_type colon = bucket.find (':');
+      if (colon == std::string::npos)
+        {
+          return false;
+        }
+      uint32_t index = std::strtoul (bucket.substr (0, colon).c_str (), NULL, 10);
+      uint64_t count = std::strtoull (bucket.substr (colon + 1).c_str (), NULL, 10);
+      if (index >= m_counts.size ())
+        {
+          m_counts.resize (index + 1, 0);
+        }
+      m_counts[index] += count;
+    }
+  return true;
+}
+
+void
+streamHistograms::Merge (const streamHistograms & other)
+{
+  liveLatency.Merge (other.liveLatency);
+  stallDuration.Merge (other.stallDuration);
+  downloadTime.Merge (other.downloadTime);
+  firstByteTime.Merge (other.firstByteTime);
+}
+
+void
+streamHistograms::Reset ()
+{
+  liveLatency.Reset ();
+  stallDuration.Reset ();
+  downloadTime.Reset ();
+  firstByteTime.Reset ();
+}
+
+void
+streamHistograms::Write (std::ostream & os) const
+{
+  liveLatency.Write (os, "Live_Latency");
+  stallDuration.Write (os, "Stall_Duration");
+  downloadTime.Write (os, "Download_Time");
+  firstByteTime.Write (os, "First_Byte_Time");
+}
+
+bool
+streamHistograms::MergeFrom (std::istream & is)
+{
+  LogLinearHistogram histogram;
+  std::string name;
+  while (histogram.Read (is, name))
+    {
+      if (name == "Live_Latency")
+        {
+          liveLatency.Merge (histogram);
+        }
+      else if (name == "Stall_Duration")
+        {
+          stallDuration.Merge (histogram);
+        }
+      else if (name == "Download_Time")
+        {
+          downloadTime.Merge (histogram);
+        }
+      else if (name == "First_Byte_Time")
+        {
+          firstByteTime.Merge (histogram);
+        }
+      else
+        {
+          return false;
+        }
+    }
+  // Read stops at the end of the stream or at a malformed line
+  return is.eof ();
+}
+
+} // namespace ns3
@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_HISTOGRAM_H
+#define TCP_STREAM_HISTOGRAM_H
+
+#include <stdint.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Histogram of non-negative integer values with log-linear buckets, in the style of HdrHistogram.
+ *
+ * Values below 2^subBucketBits get a bucket each. Above, every power of two range is split into
+ * 2^(subBucketBits-1) buckets of equal width, so the relative error of any reported value is below
+ * 2^-(subBucketBits-1), over the whole int64_t range. The bucket array only grows up to the largest value
+ * recorded: with the default of 6 bits, values up to 100 s in microseconds need about 750 buckets.
+ *
+ * Histograms with the same number of sub-bucket bits are merged by adding their bucket counts, the result
+ * is identical to a histogram that recorded all values.
+ */
+class LogLinearHistogram
+{
+public:
+  LogLinearHistogram (uint32_t subBucketBits = 6);
+
+  void Record (int64_t value);
+
+  /**
+   * \brief Add all values of another histogram with the same number of sub-bucket bits.
+   */
+  void Merge (const LogLinearHistogram & other);
+
+  void Reset ();
+
+  uint64_t GetCount () const;
+  int64_t GetMin () const; //!< smallest value recorded, 0 if empty
+  int64_t GetMax () const; //!< largest value recorded, 0 if empty
+  double GetMean () const;
+
+  /**
+   * \param percentile between 0 and 100
+   * \return the middle of the bucket holding the value at the given percentile, 0 if empty
+   */
+  int64_t GetPercentile (double percentile) const;
+
+  /**
+   * \brief Write the histogram as one line: name, sub-bucket bits, count, sum, min, max and the non-empty
+   * buckets as index:count pairs.
+   */
+  void Write (std::ostream & os, const std::string & name) const;
+
+  /**
+   * \brief Read a histogram written by Write.
+   * \return false at the end of the stream or if the line is malformed
+   */
+  bool Read (std::istream & is, std::string & name);
+
+private:
+  uint32_t GetIndex (int64_t value) const;
+  int64_t GetLowerBound (uint32_t index) const;
+  int64_t GetWidth (uint32_t index) const;
+
+  uint32_t m_subBucketBits; //!< Bits of precision of every power of two range
+  std::vector<uint64_t> m_counts; //!< Count of every bucket, up to the highest bucket used
+  uint64_t m_count; //!< Number of values
+  double m_sum; //!< Sum of the values, for the mean
+  int64_t m_min; //!< Smallest value
+  int64_t m_max; //!< Largest value
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief The histograms a TcpStreamClient keeps, all values in microseconds.
+ */
+struct streamHistograms
+{
+  LogLinearHistogram liveLatency; //!< live latency at the playback start of every segment
+  LogLinearHistogram stallDuration; //!< duration of every stall
+  LogLinearHistogram downloadTime; //!< time from sending a request until the last byte of the segment arrived
+  LogLinearHistogram firstByteTime; //!< time from sending a request until the first byte of the segment arrived
+
+  void Merge (const streamHistograms & other);
+
+  /**
+   * \brief Empty all histograms.
+   */
+  void Reset ();
+
+  /**
+   * \brief Write all histograms, one line each.
+   */
+  void Write (std::ostream & os) const;
+
+  /**
+   * \brief Read histograms written by Write and merge them into these.
+   * \return false if the stream contained a malformed or unknown histogram
+   */
+  bool MergeFrom (std::istream & is);
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_HISTOGRAM_H */
@@ -18,6 +18,13 @@
 #ifndef TCP_STREAM_INTERFACE_H
 #define TCP_STREAM_INTERFACE_H
 
+#include <stdint.h>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 namespace ns3 {
 
 std::string const dashLogDirectory = "dash-log-files/";
@@ -73,6 +80,137 @@ struct bufferData
   std::vector<int64_t> bufferLevelNew;       //!< buffer level in microseconds after adding segment duration (in microseconds) of just downloaded segment
 };
 
+/*! \class SegmentSizeSource tcp-stream-interface.h "model/tcp-stream-interface.h"
+ *  \ingroup tcpStream
+ *  \brief Storage of the segment sizes of a video.
+ *
+ * The segment sizes are read through segmentSizeTable, which leaves the storage to the source: a matrix
+ * in memory read from a text file, or a memory-mapped binary file (see tcp-stream-segment-sizes.h).
+ */
+class SegmentSizeSource
+{
+public:
+  virtual ~SegmentSizeSource () {}
+  /**
+   * \return the number of representation levels
+   */
+  virtual uint32_t GetRepresentations () const = 0;
+  /**
+   * \return the number of segments of every representation level
+   */
+  virtual int64_t GetSegments () const = 0;
+  /**
+   * \brief Size of a segment in bytes, the indices are within range.
+   */
+  virtual int64_t GetSize (uint32_t repIndex, int64_t segmentIndex) const = 0;
+  /**
+   * \brief Sizes of count consecutive segments from first on, the indices are within range.
+   *
+   * Sources storing the segments of a representation contiguously copy them in one go.
+   */
+  virtual void GetSizes (uint32_t repIndex, int64_t first, int64_t count, int64_t *sizes) const
+  {
+    for (int64_t i = 0; i < count; i++)
+      {
+        sizes[i] = GetSize (repIndex, first + i);
+      }
+  }
+};
+
+/*! \class segmentSizeColumn tcp-stream-interface.h "model/tcp-stream-interface.h"
+ *  \ingroup tcpStream
+ *  \brief The segment sizes of one representation level, a view into a SegmentSizeSource.
+ */
+class segmentSizeColumn
+{
+public:
+  segmentSizeColumn (const SegmentSizeSource *source, uint32_t repIndex)
+    : m_source (source),
+      m_repIndex (repIndex)
+  {
+  }
+  /**
+   * \brief Size of segment index in bytes, throws std::out_of_range like std::vector::at.
+   */
+  int64_t at (int64_t index) const
+  {
+    if (index < 0 || index >= m_source->GetSegments ())
+      {
+        throw std::out_of_range ("segment index out of range");
+      }
+    return m_source->GetSize (m_repIndex, index);
+  }
+  std::size_t size () const
+  {
+    return m_source->GetSegments ();
+  }
+  /**
+   * \brief Sizes of up to count segments from first on into sizes, fewer at the end of the stream.
+   * \return the number of sizes copied
+   */
+  int64_t GetRange (int64_t first, int64_t count, int64_t *sizes) const
+  {
+    if (first < 0)
+      {
+        throw std::out_of_range ("segment index out of range");
+      }
+    count = std::max ((int64_t) 0, std::min (count, m_source->GetSegments () - first));
+    if (count > 0)
+      {
+        m_source->GetSizes (m_repIndex, first, count, sizes);
+      }
+    return count;
+  }
+
+private:
+  const SegmentSizeSource *m_source; //!< Storage of the sizes
+  uint32_t m_repIndex; //!< Representation level of the view
+};
+
+/*! \class segmentSizeTable tcp-stream-interface.h "model/tcp-stream-interface.h"
+ *  \ingroup tcpStream
+ *  \brief The segment sizes of all representation levels, indexed [i][j] like a matrix.
+ *
+ * Copies share the source, so copying a videoData does not copy the sizes.
+ */
+class segmentSizeTable
+{
+public:
+  segmentSizeTable ()
+  {
+  }
+  explicit segmentSizeTable (std::shared_ptr<const SegmentSizeSource> source)
+    : m_source (source)
+  {
+  }
+  /**
+   * \brief Segment sizes of representation level repIndex, throws std::out_of_range like std::vector::at.
+   */
+  segmentSizeColumn at (int64_t repIndex) const
+  {
+    if (repIndex < 0 || repIndex >= (int64_t) size ())
+      {
+        throw std::out_of_range ("representation index out of range");
+      }
+    return segmentSizeColumn (m_source.get (), (uint32_t) repIndex);
+  }
+  std::size_t size () const
+  {
+    return m_source ? m_source->GetRepresentations () : 0;
+  }
+  bool empty () const
+  {
+    return size () == 0;
+  }
+  std::shared_ptr<const SegmentSizeSource> GetSource () const
+  {
+    return m_source;
+  }
+
+private:
+  std::shared_ptr<const SegmentSizeSource> m_source; //!< Storage of the sizes, shared by all copies
+};
+
 /*! \class videoData tcp-stream-interface.h "model/tcp-stream-interface.h"
  *  \ingroup tcpStream
  *  \brief This is a struct containing video data.
@@ -83,9 +221,57 @@ struct bufferData
  */
 struct videoData
 {
-  std::vector < std::vector<int64_t > > segmentSize;       //!< vector holding representation levels in the first dimension and their particular segment sizes in bytes in the second dimension
+  segmentSizeTable segmentSize;       //!< table holding representation levels in the first dimension and their particular segment sizes in bytes in the second dimension
   std::vector < double > averageBitrate;       //!< holding the average bitrate of a segment in representation i in bits
-  int64_t segmentDuration;       //!< duration of a segment in microseconds
+  int64_t segmentDuration;       //!< duration of a segment in microseconds, the mean duration if the segments have their own
+  std::vector<int64_t> segmentStart;       //!< start of segment i within the stream in microseconds, one entry more than segments, empty if all segments last segmentDuration
+
+  /**
+   * \brief Start of a segment within the stream, i.e. the sum of the durations of the segments before it.
+   *
+   * Constant time lookup in the timeline. Past the end of the timeline the segments are assumed to last
+   * segmentDuration.
+   */
+  int64_t GetSegmentStart (int64_t index) const
+  {
+    if (segmentStart.empty () || index < 0)
+      {
+        return index * segmentDuration;
+      }
+    int64_t last = (int64_t) segmentStart.size () - 1;
+    if (index > last)
+      {
+        return segmentStart.back () + (index - last) * segmentDuration;
+      }
+    return segmentStart[index];
+  }
+
+  /**
+   * \brief Duration of a segment in microseconds, segmentDuration if the segment is not in the timeline.
+   */
+  int64_t GetSegmentDuration (int64_t index) const
+  {
+    if (index < 0 || index + 1 >= (int64_t) segmentStart.size ())
+      {
+        return segmentDuration;
+      }
+    return segmentStart[index + 1] - segmentStart[index];
+  }
+};
+
+/*! \class assistanceData tcp-stream-interface.h "model/tcp-stream-interface.h"
+ *  \ingroup tcpStream
+ *  \brief This is a struct containing the bitrate hints pushed to the client by the network.
+ *
+ * Every hint is a bitrate recommended by the server (or a network element), e.g. the fair share of the
+ * client on the server's egress, and is valid for a limited time after its arrival. Empty if the client
+ * has no assistance channel.
+ */
+struct assistanceData
+{
+  std::vector<int64_t> hintTime;       //!< Simulation time in microseconds when a hint arrived
+  std::vector<double> recommendedBitrate;       //!< Recommended bitrate in bit/s
+  std::vector<int64_t> validity;       //!< Time in microseconds after its arrival the hint may be used
 };
 
 /*! \class playbackData tcp-stream-interface.h "model/tcp-stream-interface.h"
@@ -0,0 +1,499 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-multicast.h"
+#include <algorithm>
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/socket.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/packet.h"
+#include "ns3/trace-source-accessor.h"
+#include "tcp-stream-client.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamMulticast");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpStreamMulticastHeader);
+NS_OBJECT_ENSURE_REGISTERED (TcpStreamMulticastSource);
+NS_OBJECT_ENSURE_REGISTERED (TcpStreamMulticastReplicator);
+
+TypeId
+TcpStreamMulticastHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpStreamMulticastHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TcpStreamMulticastHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+TcpStreamMulticastHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+TcpStreamMulticastHeader::TcpStreamMulticastHeader ()
+  : m_segmentIndex (0),
+    m_repIndex (0),
+    m_segmentSize (0),
+    m_offset (0)
+{
+}
+
+void
+TcpStreamMulticastHeader::SetSegment (uint32_t segmentIndex, uint16_t repIndex, uint32_t segmentSize)
+{
+  m_segmentIndex = segmentIndex;
+  m_repIndex = repIndex;
+  m_segmentSize = segmentSize;
+}
+
+void
+TcpStreamMulticastHeader::SetOffset (uint32_t offset)
+{
+  m_offset = offset;
+}
+
+uint32_t
+TcpStreamMulticastHeader::GetSegmentIndex () const
+{
+  return m_segmentIndex;
+}
+
+uint16_t
+TcpStreamMulticastHeader::GetRepIndex () const
+{
+  return m_repIndex;
+}
+
+uint32_t
+TcpStreamMulticastHeader::GetSegmentSize () const
+{
+  return m_segmentSize;
+}
+
+uint32_t
+TcpStreamMulticastHeader::GetOffset () const
+{
+  return m_offset;
+}
+
+uint32_t
+TcpStreamMulticastHeader::GetSerializedSize (void) const
+{
+  return 14;
+}
+
+void
+TcpStreamMulticastHeader::Serialize (Buffer::Iterator start) const
+{
+  start.WriteHtonU32 (m_segmentIndex);
+  start.WriteHtonU16 (m_repIndex);
+  start.WriteHtonU32 (m_segmentSize);
+  start.WriteHtonU32 (m_offset);
+}
+
+uint32_t
+TcpStreamMulticastHeader::Deserialize (Buffer::Iterator start)
+{
+  m_segmentIndex = start.ReadNtohU32 ();
+  m_repIndex = start.ReadNtohU16 ();
+  m_segmentSize = start.ReadNtohU32 ();
+  m_offset = start.ReadNtohU32 ();
+  return GetSerializedSize ();
+}
+
+void
+TcpStreamMulticastHeader::Print (std::ostream &os) const
+{
+  os << "segment=" << m_segmentIndex << " rep=" << m_repIndex << " size=" << m_segmentSize << " offset=" << m_offset;
+}
+
+TypeId
+TcpStreamMulticastSource::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpStreamMulticastSource")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TcpStreamMulticastSource> ()
+    .AddAttribute ("SegmentSizeFilePath",
+                   "The relative path (from ns-3.x directory) to the file containing the segment sizes in bytes",
+                   StringValue ("bitrates.txt"),
+                   MakeStringAccessor (&TcpStreamMulticastSource::m_segmentSizeFilePath),
+                   MakeStringChecker ())
+    .AddAttribute ("SegmentDuration",
+                   "The duration of a segment in microseconds",
+                   UintegerValue (2000000),
+                   MakeUintegerAccessor (&TcpStreamMulticastSource::m_segmentDuration),
+                   MakeUintegerChecker<uint64_t> (1))
+    .AddAttribute ("RemoteAddress",
+                   "The address of the replicator",
+                   AddressValue (),
+                   MakeAddressAccessor (&TcpStreamMulticastSource::m_replicatorAddress),
+                   MakeAddressChecker ())
+    .AddAttribute ("RemotePort",
+                   "The data port of the replicator",
+                   UintegerValue (5001),
+                   MakeUintegerAccessor (&TcpStreamMulticastSource::m_replicatorPort),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("PacketSize",
+                   "Segment bytes carried by one datagram",
+                   UintegerValue (1400),
+                   MakeUintegerAccessor (&TcpStreamMulticastSource::m_packetSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Speedup",
+                   "A segment is sent within its duration divided by this, i.e. at this multiple of its bitrate",
+                   DoubleValue (1.25),
+                   MakeDoubleAccessor (&TcpStreamMulticastSource::m_speedup),
+                   MakeDoubleChecker<double> (1))
+  ;
+  return tid;
+}
+
+TcpStreamMulticastSource::TcpStreamMulticastSource ()
+  : m_segmentDuration (2000000),
+    m_replicatorPort (5001),
+    m_packetSize (1400),
+    m_speedup (1.25),
+    m_bytesSent (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpStreamMulticastSource::~TcpStreamMulticastSource ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+TcpStreamMulticastSource::GetBytesSent () const
+{
+  return m_bytesSent;
+}
+
+void
+TcpStreamMulticastSource::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_segmentEvent.Cancel ();
+  for (uint32_t i = 0; i < m_groups.size (); i++)
+    {
+      m_groups.at (i).event.Cancel ();
+    }
+  m_groups.clear ();
+  m_socket = 0;
+  m_videoData.reset ();
+  Application::DoDispose ();
+}
+
+void
+TcpStreamMulticastSource::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_videoData = TcpStreamClient::LoadVideoData (m_segmentSizeFilePath, m_segmentDuration);
+  if (!m_videoData)
+    {
+      NS_FATAL_ERROR ("Opening test bitrate file failed. Terminating.");
+    }
+  if (m_socket == 0)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+      m_socket = Socket::CreateSocket (GetNode (), tid);
+      if (Ipv4Address::IsMatchingType (m_replicatorAddress))
+        {
+          m_socket->Bind ();
+          m_socket->Connect (InetSocketAddress (Ipv4Address::ConvertFrom (m_replicatorAddress), m_replicatorPort));
+        }
+      else if (Ipv6Address::IsMatchingType (m_replicatorAddress))
+        {
+          m_socket->Bind6 ();
+          m_socket->Connect (Inet6SocketAddress (Ipv6Address::ConvertFrom (m_replicatorAddress), m_replicatorPort));
+        }
+    }
+  groupTransmission idle;
+  idle.segmentIndex = -1;
+  idle.offset = 0;
+  m_groups.assign (m_videoData->segmentSize.size (), idle);
+
+  // a live source: segments that became available before the start are not sent any more
+  int64_t now = Simulator::Now ().GetMicroSeconds ();
+  int64_t next = now / m_videoData->segmentDuration;
+  while (next > 0 && m_videoData->GetSegmentStart (next - 1) >= now)
+    {
+      next--;
+    }
+  while (m_videoData->GetSegmentStart (next) < now)
+    {
+      next++;
+    }
+  if (next < (int64_t) m_videoData->segmentSize.at (0).size ())
+    {
+      m_segmentEvent = Simulator::Schedule (MicroSeconds (m_videoData->GetSegmentStart (next) - now),
+                                            &TcpStreamMulticastSource::SendSegment, this, next);
+    }
+}
+
+void
+TcpStreamMulticastSource::StopApplication ()
+{
+  NS_LOG_FUNCTION (this);
+  m_segmentEvent.Cancel ();
+  for (uint32_t i = 0; i < m_groups.size (); i++)
+    {
+      m_groups.at (i).event.Cancel ();
+    }
+  if (m_socket != 0)
+    {
+      m_socket->Close ();
+      m_socket = 0;
+    }
+}
+
+void
+TcpStreamMulticastSource::SendSegment (int64_t segmentIndex)
+{
+  NS_LOG_FUNCTION (this << segmentIndex);
+  if (segmentIndex + 1 < (int64_t) m_videoData->segmentSize.at (0).size ())
+    {
+      m_segmentEvent = Simulator::Schedule (MicroSeconds (m_videoData->GetSegmentDuration (segmentIndex)), &TcpStreamMulticastSource::SendSegment, this, segmentIndex + 1);
+    }
+  for (uint16_t rep = 0; rep < m_groups.size (); rep++)
+    {
+      groupTransmission & group = m_groups.at (rep);
+      int64_t size = m_videoData->segmentSize.at (rep).at (segmentIndex);
+      // a previous segment still running is cut off, its receivers repair the rest
+      group.event.Cancel ();
+      group.segmentIndex = segmentIndex;
+      group.offset = 0;
+      if (size <= 0)
+        {
+          continue;
+        }
+      int64_t packets = (size + m_packetSize - 1) / m_packetSize;
+      group.interval = NanoSeconds ((int64_t) (m_videoData->GetSegmentDuration (segmentIndex) * 1000.0 / m_speedup / packets));
+      SendPacket (rep);
+    }
+}
+
+void
+TcpStreamMulticastSource::SendPacket (uint16_t repIndex)
+{
+  groupTransmission & group = m_groups.at (repIndex);
+  uint32_t size = m_videoData->segmentSize.at (repIndex).at (group.segmentIndex);
+  uint32_t bytes = std::min (m_packetSize, size - group.offset);
+  TcpStreamMulticastHeader header;
+  header.SetSegment (group.segmentIndex, repIndex, size);
+  header.SetOffset (group.offset);
+  Ptr<Packet> packet = Create<Packet> (bytes);
+  packet->AddHeader (header);
+  m_bytesSent += packet->GetSize ();
+  m_socket->Send (packet);
+  group.offset += bytes;
+  if (group.offset < size)
+    {
+      group.event = Simulator::Schedule (group.interval, &TcpStreamMulticastSource::SendPacket, this, repIndex);
+    }
+}
+
+TypeId
+TcpStreamMulticastReplicator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpStreamMulticastReplicator")
+    .SetParent<Application> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<TcpStreamMulticastReplicator> ()
+    .AddAttribute ("Port",
+                   "Port on which the datagrams of the source are received",
+                   UintegerValue (5001),
+                   MakeUintegerAccessor (&TcpStreamMulticastReplicator::m_port),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("ControlPort",
+                   "Port on which clients join and leave groups",
+                   UintegerValue (5000),
+                   MakeUintegerAccessor (&TcpStreamMulticastReplicator::m_controlPort),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddTraceSource ("GroupSize",
+                     "A client joined or left the group of a representation",
+                     MakeTraceSourceAccessor (&TcpStreamMulticastReplicator::m_groupSizeTrace),
+                     "ns3::TcpStreamMulticastReplicator::GroupSizeCallback")
+  ;
+  return tid;
+}
+
+TcpStreamMulticastReplicator::TcpStreamMulticastReplicator ()
+  : m_port (5001),
+    m_controlPort (5000),
+    m_bytesReceived (0),
+    m_bytesForwarded (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpStreamMulticastReplicator::~TcpStreamMulticastReplicator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+TcpStreamMulticastReplicator::GetBytesReceived () const
+{
+  return m_bytesReceived;
+}
+
+uint64_t
+TcpStreamMulticastReplicator::GetBytesForwarded () const
+{
+  return m_bytesForwarded;
+}
+
+void
+TcpStreamMulticastReplicator::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_socket = 0;
+  m_controlSocket = 0;
+  m_groups.clear ();
+  m_subscriptions.clear ();
+  Application::DoDispose ();
+}
+
+void
+TcpStreamMulticastReplicator::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  if (m_socket == 0)
+    {
+      m_socket = Socket::CreateSocket (GetNode (), tid);
+      m_socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), m_port));
+    }
+  if (m_controlSocket == 0)
+    {
+      m_controlSocket = Socket::CreateSocket (GetNode (), tid);
+      m_controlSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), m_controlPort));
+    }
+  m_socket->SetRecvCallback (MakeCallback (&TcpStreamMulticastReplicator::HandleData, this));
+  m_controlSocket->SetRecvCallback (MakeCallback (&TcpStreamMulticastReplicator::HandleControl, this));
+}
+
+void
+TcpStreamMulticastReplicator::StopApplication ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_socket != 0)
+    {
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_socket->Close ();
+      m_socket = 0;
+    }
+  if (m_controlSocket != 0)
+    {
+      m_controlSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_controlSocket->Close ();
+      m_controlSocket = 0;
+    }
+}
+
+void
+TcpStreamMulticastReplicator::HandleData (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_bytesReceived += packet->GetSize ();
+      TcpStreamMulticastHeader header;
+      packet->PeekHeader (header);
+      std::map<int64_t, std::set<Address> >::const_iterator group = m_groups.find (header.GetRepIndex ());
+      if (group == m_groups.end ())
+        {
+          continue;
+        }
+      for (std::set<Address>::const_iterator it = group->second.begin (); it != group->second.end (); ++it)
+        {
+          m_bytesForwarded += packet->GetSize ();
+          socket->SendTo (packet->Copy (), 0, *it);
+        }
+    }
+}
+
+void
+TcpStreamMulticastReplicator::HandleControl (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+    {
+      // "join <repIndex>" or "leave"
+      std::string message (packet->GetSize (), '\0');
+      packet->CopyData ((uint8_t *) &message[0], packet->GetSize ());
+      std::istringstream ss (message.c_str ());
+      std::string command;
+      int64_t repIndex;
+      ss >> command;
+      if (command == "join" && ss >> repIndex)
+        {
+          std::map<Address, int64_t>::const_iterator current = m_subscriptions.find (from);
+          if (current != m_subscriptions.end () && current->second == repIndex)
+            {
+              // clients repeat their subscription with every segment, in case it was lost
+              continue;
+            }
+          Leave (from);
+          std::set<Address> & group = m_groups[repIndex];
+          group.insert (from);
+          m_subscriptions[from] = repIndex;
+          m_groupSizeTrace (repIndex, group.size ());
+        }
+      else if (command == "leave")
+        {
+          Leave (from);
+        }
+    }
+}
+
+void
+TcpStreamMulticastReplicator::Leave (const Address & subscriber)
+{
+  std::map<Address, int64_t>::iterator it = m_subscriptions.find (subscriber);
+  if (it == m_subscriptions.end ())
+    {
+      return;
+    }
+  int64_t repIndex = it->second;
+  m_subscriptions.erase (it);
+  std::set<Address> & group = m_groups[repIndex];
+  group.erase (subscriber);
+  m_groupSizeTrace (repIndex, group.size ());
+  if (group.empty ())
+    {
+      m_groups.erase (repIndex);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_MULTICAST_H
+#define TCP_STREAM_MULTICAST_H
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+#include "ns3/application.h"
+#include "ns3/address.h"
+#include "ns3/event-id.h"
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/traced-callback.h"
+#include "tcp-stream-interface.h"
+
+namespace ns3 {
+
+class Socket;
+class Packet;
+
+/**
+ * \ingroup tcpStream
+ * \brief Header of a multicast datagram, locating its payload within a segment.
+ */
+class TcpStreamMulticastHeader : public Header
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  TcpStreamMulticastHeader ();
+
+  void SetSegment (uint32_t segmentIndex, uint16_t repIndex, uint32_t segmentSize);
+  void SetOffset (uint32_t offset);
+  uint32_t GetSegmentIndex () const;
+  uint16_t GetRepIndex () const;
+  uint32_t GetSegmentSize () const;
+  uint32_t GetOffset () const;
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint32_t m_segmentIndex; //!< Index of the segment
+  uint16_t m_repIndex; //!< Representation of the segment, i.e. the group
+  uint32_t m_segmentSize; //!< Size of the segment in bytes
+  uint32_t m_offset; //!< Position of the payload within the segment
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Live source multicasting every representation of a stream.
+ *
+ * As soon as a segment becomes available (segment i at its start in the timeline of the segment size file), the source sends it
+ * in every representation as datagrams of PacketSize bytes to a TcpStreamMulticastReplicator, one group
+ * per representation. The datagrams of a segment are paced evenly over the duration of the segment divided by
+ * Speedup, so a representation occupies Speedup times its bitrate on the way to the replicator, however
+ * many clients watch it. Segments without chunks only.
+ */
+class TcpStreamMulticastSource : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpStreamMulticastSource ();
+  virtual ~TcpStreamMulticastSource ();
+
+  /**
+   * \return the bytes sent (payload and header) since the source started
+   */
+  uint64_t GetBytesSent () const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \brief Segment segmentIndex became available, start sending it in every representation.
+   */
+  void SendSegment (int64_t segmentIndex);
+  /**
+   * \brief Send the next datagram of the segment running in the representation.
+   */
+  void SendPacket (uint16_t repIndex);
+
+  /**
+   * \brief Segment being sent in a representation.
+   */
+  struct groupTransmission
+  {
+    int64_t segmentIndex; //!< Segment being sent
+    uint32_t offset; //!< Bytes of the segment sent
+    Time interval; //!< Time between two datagrams
+    EventId event; //!< Pending next datagram
+  };
+
+  std::string m_segmentSizeFilePath; //!< The file containing the segment sizes in bytes
+  uint64_t m_segmentDuration; //!< The duration of a segment in microseconds
+  Address m_replicatorAddress; //!< Address of the replicator
+  uint16_t m_replicatorPort; //!< Data port of the replicator
+  uint32_t m_packetSize; //!< Payload of a datagram in bytes
+  double m_speedup; //!< Segments are sent within their duration divided by this
+
+  Ptr<Socket> m_socket; //!< Socket the datagrams are sent from
+  std::shared_ptr<const videoData> m_videoData; //!< The segment sizes
+  std::vector<groupTransmission> m_groups; //!< Running transmission of every representation
+  EventId m_segmentEvent; //!< Pending availability of the next segment
+  uint64_t m_bytesSent; //!< Bytes sent since the start
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Replication point of the multicast groups, standing in for a multicast router.
+ *
+ * Clients subscribe to the group of a representation by sending "join <repIndex>" to the control port
+ * and unsubscribe with "leave"; a join moves the client out of any other group. Every datagram the source
+ * sends to the data port is forwarded once to every subscriber of its group, to the address the
+ * subscription came from, so the link from the source carries every group once and every access link only
+ * the group of its client.
+ */
+class TcpStreamMulticastReplicator : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Signature of the GroupSize trace source.
+   * \param repIndex the representation whose group changed
+   * \param members the number of subscribers after the change
+   */
+  typedef void (* GroupSizeCallback)(int64_t repIndex, uint32_t members);
+
+  TcpStreamMulticastReplicator ();
+  virtual ~TcpStreamMulticastReplicator ();
+
+  /**
+   * \return the bytes received from the source since the replicator started
+   */
+  uint64_t GetBytesReceived () const;
+  /**
+   * \return the bytes forwarded to subscribers since the replicator started
+   */
+  uint64_t GetBytesForwarded () const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  void HandleData (Ptr<Socket> socket);
+  void HandleControl (Ptr<Socket> socket);
+  /**
+   * \brief Remove the subscriber from its group, if it is in one.
+   */
+  void Leave (const Address & subscriber);
+
+  uint16_t m_port; //!< Port the source sends to
+  uint16_t m_controlPort; //!< Port the clients subscribe on
+
+  Ptr<Socket> m_socket; //!< Socket receiving the datagrams of the source and forwarding them
+  Ptr<Socket> m_controlSocket; //!< Socket receiving the subscriptions
+  std::map<int64_t, std::set<Address> > m_groups; //!< Subscribers of every representation
+  std::map<Address, int64_t> m_subscriptions; //!< Group of every subscriber
+  uint64_t m_bytesReceived; //!< Bytes received from the source
+  uint64_t m_bytesForwarded; //!< Bytes forwarded to subscribers
+  TracedCallback<int64_t, uint32_t> m_groupSizeTrace; //!< Trace of the group sizes
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_MULTICAST_H */
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-profiler.h"
+#include <iomanip>
+#include <iostream>
+#include "ns3/boolean.h"
+#include "ns3/global-value.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+static GlobalValue g_dashProfiling = GlobalValue ("DashProfiling",
+                                                  "Measure the wall-clock time spent in the DASH module and print it at Simulator::Destroy",
+                                                  BooleanValue (false),
+                                                  MakeBooleanChecker ());
+
+bool
+DashProfiler::ReadEnabled ()
+{
+  BooleanValue enabled;
+  g_dashProfiling.GetValue (enabled);
+  return enabled.Get ();
+}
+
+std::map<std::string, DashProfiler::entry> &
+DashProfiler::GetEntries ()
+{
+  static std::map<std::string, entry> entries;
+  return entries;
+}
+
+void
+DashProfiler::Record (const std::string & category, int64_t nanoseconds)
+{
+  std::map<std::string, entry> & entries = GetEntries ();
+  if (entries.empty ())
+    {
+      // first sample of this simulation, report when it is destroyed
+      Simulator::ScheduleDestroy (&DashProfiler::Report);
+    }
+  entry & e = entries[category];
+  e.count++;
+  e.nanoseconds += nanoseconds;
+}
+
+void
+DashProfiler::Report ()
+{
+  std::map<std::string, entry> & entries = GetEntries ();
+  // the report runs inside the program's own output, leave its formatting as it was
+  std::ios_base::fmtflags flags = std::cout.flags ();
+  std::streamsize precision = std::cout.precision ();
+  std::cout << "DASH profile (wall-clock, inclusive)\n"
+            << std::left << std::setw (40) << "Category" << std::right
+            << std::setw (14) << "Count" << std::setw (14) << "Total_s" << std::setw (14) << "Mean_us" << "\n";
+  for (std::map<std::string, entry>::const_iterator it = entries.begin (); it != entries.end (); ++it)
+    {
+      std::cout << std::left << std::setw (40) << it->first << std::right
+                << std::setw (14) << it->second.count
+                << std::setw (14) << std::fixed << std::setprecision (3) << it->second.nanoseconds / 1e9
+                << std::setw (14) << std::setprecision (3) << it->second.nanoseconds / 1e3 / it->second.count << "\n";
+    }
+  std::cout.flags (flags);
+  std::cout.precision (precision);
+  entries.clear ();
+}
+
+} // namespace ns3
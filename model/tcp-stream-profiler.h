@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_PROFILER_H
+#define TCP_STREAM_PROFILER_H
+
+#include <stdint.h>
+#include <chrono>
+#include <map>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Wall-clock self-profiling of the DASH module.
+ *
+ * Enabled by the global value DashProfiling (e.g. --DashProfiling=1 on the command line of any example).
+ * Every instrumented section (client controller events, GetNextRep per algorithm, log writes, server
+ * callbacks) adds its count and wall-clock time to a category, a table of all categories is printed at
+ * Simulator::Destroy. Times are inclusive: a controller event contains the GetNextRep call and the log
+ * writes it triggered. When profiling is disabled, an instrumented section costs one branch.
+ */
+class DashProfiler
+{
+public:
+  /**
+   * \return true if the global value DashProfiling is set, read once on the first call
+   */
+  static bool IsEnabled ()
+  {
+    static bool enabled = ReadEnabled ();
+    return enabled;
+  }
+
+  /**
+   * \brief Add one call of the given duration to a category.
+   */
+  static void Record (const std::string & category, int64_t nanoseconds);
+
+  /**
+   * \brief Print the table of all categories and forget them.
+   */
+  static void Report ();
+
+private:
+  static bool ReadEnabled ();
+
+  /**
+   * \brief Count and accumulated time of a category.
+   */
+  struct entry
+  {
+    uint64_t count; //!< number of calls
+    int64_t nanoseconds; //!< accumulated wall-clock time
+  };
+  static std::map<std::string, entry> & GetEntries ();
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Measures the wall-clock time of its scope for the DashProfiler.
+ *
+ * The category is the concatenation of the two names, which is only built when profiling is enabled.
+ * Both names must stay valid until the scope is left.
+ */
+class DashProfilerScope
+{
+public:
+  DashProfilerScope (const char * category, const char * name = 0)
+    : m_enabled (DashProfiler::IsEnabled ()),
+      m_category (category),
+      m_name (name)
+  {
+    if (m_enabled)
+      {
+        m_start = std::chrono::steady_clock::now ();
+      }
+  }
+
+  ~DashProfilerScope ()
+  {
+    if (m_enabled)
+      {
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds> (std::chrono::steady_clock::now () - m_start).count ();
+        DashProfiler::Record (m_name == 0 ? std::string (m_category) : std::string (m_category) + "/" + m_name, elapsed);
+      }
+  }
+
+private:
+  bool m_enabled; //!< profiling was enabled when the scope was entered
+  const char * m_category; //!< category of the scope
+  const char * m_name; //!< refinement of the category, e.g. the algorithm name, or 0
+  std::chrono::steady_clock::time_point m_start; //!< wall-clock time the scope was entered
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_PROFILER_H */
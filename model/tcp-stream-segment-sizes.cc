@@ -0,0 +1,423 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-stream-segment-sizes.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpStreamSegmentSizes");
+
+static const char segmentSizeMagic[8] = { 'D', 'A', 'S', 'H', 'S', 'E', 'G', 'S' };
+static const uint32_t segmentSizeVersion = 1;
+
+/**
+ * \brief Header of a binary segment size file, 32 bytes so the int64 arrays after it stay aligned.
+ */
+struct segmentSizeFileHeader
+{
+  char magic[8]; //!< segmentSizeMagic
+  uint32_t version; //!< segmentSizeVersion
+  uint32_t representations; //!< Number of representation levels
+  int64_t segments; //!< Number of segments per representation level
+  uint32_t hasDurations; //!< 1 if the durations of the segments follow the average bitrates
+  uint32_t reserved; //!< Zero
+};
+
+SegmentSizeMemory::SegmentSizeMemory ()
+{
+}
+
+void
+SegmentSizeMemory::AddRepresentation (const std::vector<int64_t> & sizes)
+{
+  NS_ASSERT_MSG (m_sizes.empty () || m_sizes.front ().size () == sizes.size (),
+                 "All representation levels need the same number of segments.");
+  m_sizes.push_back (sizes);
+}
+
+uint32_t
+SegmentSizeMemory::GetRepresentations () const
+{
+  return m_sizes.size ();
+}
+
+int64_t
+SegmentSizeMemory::GetSegments () const
+{
+  return m_sizes.empty () ? 0 : m_sizes.front ().size ();
+}
+
+int64_t
+SegmentSizeMemory::GetSize (uint32_t repIndex, int64_t segmentIndex) const
+{
+  return m_sizes[repIndex][segmentIndex];
+}
+
+void
+SegmentSizeMemory::GetSizes (uint32_t repIndex, int64_t first, int64_t count, int64_t *sizes) const
+{
+  std::copy (m_sizes[repIndex].begin () + first, m_sizes[repIndex].begin () + first + count, sizes);
+}
+
+SegmentSizeMappedFile::SegmentSizeMappedFile ()
+  : m_mapping (0),
+    m_length (0),
+    m_representations (0),
+    m_segments (0),
+    m_sizes (0)
+{
+}
+
+SegmentSizeMappedFile::~SegmentSizeMappedFile ()
+{
+  if (m_mapping != 0)
+    {
+      munmap (m_mapping, m_length);
+    }
+}
+
+bool
+SegmentSizeMappedFile::IsBinary (const std::string & file)
+{
+  std::ifstream stream (file.c_str (), std::ios::in | std::ios::binary);
+  char magic[sizeof (segmentSizeMagic)];
+  stream.read (magic, sizeof (magic));
+  return stream.gcount () == sizeof (magic) && std::memcmp (magic, segmentSizeMagic, sizeof (magic)) == 0;
+}
+
+int
+SegmentSizeMappedFile::Load (const std::string & file, videoData & data)
+{
+  NS_LOG_FUNCTION (file);
+  int fd = open (file.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      return -1;
+    }
+  struct stat status;
+  if (fstat (fd, &status) != 0 || (uint64_t) status.st_size < sizeof (segmentSizeFileHeader))
+    {
+      close (fd);
+      return -1;
+    }
+  void *mapping = mmap (0, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  // the mapping keeps the file open
+  close (fd);
+  if (mapping == MAP_FAILED)
+    {
+      return -1;
+    }
+  std::shared_ptr<SegmentSizeMappedFile> mapped (new SegmentSizeMappedFile ());
+  mapped->m_mapping = mapping;
+  mapped->m_length = status.st_size;
+
+  const segmentSizeFileHeader *header = static_cast<const segmentSizeFileHeader *> (mapping);
+  if (std::memcmp (header->magic, segmentSizeMagic, sizeof (segmentSizeMagic)) != 0
+      || header->version != segmentSizeVersion || header->representations == 0 || header->segments <= 0)
+    {
+      NS_LOG_ERROR ("Not a binary segment size file: " << file);
+      return -1;
+    }
+  uint64_t durations = header->hasDurations ? header->segments : 0;
+  uint64_t expected = sizeof (segmentSizeFileHeader) + (header->representations + durations) * sizeof (int64_t)
+    + (uint64_t) header->representations * header->segments * sizeof (uint32_t);
+  if (expected != mapped->m_length)
+    {
+      NS_LOG_ERROR ("Truncated binary segment size file: " << file);
+      return -1;
+    }
+  mapped->m_representations = header->representations;
+  mapped->m_segments = header->segments;
+
+  const int64_t *averageBitrate = reinterpret_cast<const int64_t *> (header + 1);
+  data.averageBitrate.assign (averageBitrate, averageBitrate + header->representations);
+  const int64_t *duration = averageBitrate + header->representations;
+  data.segmentStart.clear ();
+  if (header->hasDurations)
+    {
+      data.segmentStart.reserve (header->segments + 1);
+      data.segmentStart.push_back (0);
+      for (int64_t i = 0; i < header->segments; i++)
+        {
+          if (duration[i] <= 0)
+            {
+              NS_LOG_ERROR ("Segment durations have to be positive: " << file);
+              data.segmentStart.clear ();
+              return -1;
+            }
+          data.segmentStart.push_back (data.segmentStart.back () + duration[i]);
+        }
+      data.segmentDuration = data.segmentStart.back () / header->segments;
+    }
+  mapped->m_sizes = reinterpret_cast<const uint32_t *> (duration + durations);
+  data.segmentSize = segmentSizeTable (mapped);
+  return 1;
+}
+
+bool
+SegmentSizeMappedFile::Write (const std::string & file, const videoData & data)
+{
+  NS_LOG_FUNCTION (file);
+  segmentSizeFileHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, segmentSizeMagic, sizeof (segmentSizeMagic));
+  header.version = segmentSizeVersion;
+  header.representations = data.segmentSize.size ();
+  header.segments = data.segmentSize.empty () ? 0 : data.segmentSize.at (0).size ();
+  header.hasDurations = data.segmentStart.empty () ? 0 : 1;
+  if (header.representations == 0 || header.segments == 0 || data.averageBitrate.size () != header.representations)
+    {
+      return false;
+    }
+
+  std::ofstream stream (file.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!stream)
+    {
+      return false;
+    }
+  stream.write (reinterpret_cast<const char *> (&header), sizeof (header));
+  for (uint32_t r = 0; r < header.representations; r++)
+    {
+      int64_t bitrate = data.averageBitrate.at (r);
+      stream.write (reinterpret_cast<const char *> (&bitrate), sizeof (bitrate));
+    }
+  for (int64_t i = 0; header.hasDurations && i < header.segments; i++)
+    {
+      int64_t duration = data.GetSegmentDuration (i);
+      stream.write (reinterpret_cast<const char *> (&duration), sizeof (duration));
+    }
+  for (uint32_t r = 0; r < header.representations; r++)
+    {
+      segmentSizeColumn column = data.segmentSize.at (r);
+      for (int64_t i = 0; i < header.segments; i++)
+        {
+          int64_t size = column.at (i);
+          if (size < 0 || size > (int64_t) UINT32_MAX)
+            {
+              NS_LOG_ERROR ("Segment " << i << " of representation " << r << " does not fit 32 bits: " << size);
+              return false;
+            }
+          uint32_t stored = size;
+          stream.write (reinterpret_cast<const char *> (&stored), sizeof (stored));
+        }
+    }
+  return (bool) stream;
+}
+
+uint32_t
+SegmentSizeMappedFile::GetRepresentations () const
+{
+  return m_representations;
+}
+
+int64_t
+SegmentSizeMappedFile::GetSegments () const
+{
+  return m_segments;
+}
+
+int64_t
+SegmentSizeMappedFile::GetSize (uint32_t repIndex, int64_t segmentIndex) const
+{
+  return m_sizes[repIndex * m_segments + segmentIndex];
+}
+
+void
+SegmentSizeMappedFile::GetSizes (uint32_t repIndex, int64_t first, int64_t count, int64_t *sizes) const
+{
+  const uint32_t *column = m_sizes + repIndex * m_segments + first;
+  std::copy (column, column + count, sizes);
+}
+
+/**
+ * \brief splitmix64 finaliser, spreads every input bit over the output.
+ */
+static uint64_t
+MixBits (uint64_t value)
+{
+  value += 0x9e3779b97f4a7c15ULL;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+SegmentSizeGenerator::SegmentSizeGenerator (const std::vector<double> & bitrates, int64_t segments, int64_t segmentDuration,
+                                            double sigma, double sceneLength, double sceneShare, double correlation, uint64_t seed)
+  : m_segments (segments),
+    m_sigma (sigma),
+    m_sceneLength (sceneLength),
+    m_sceneShare (sceneShare),
+    m_correlation (correlation),
+    m_seed (seed)
+{
+  for (uint32_t r = 0; r < bitrates.size (); r++)
+    {
+      m_meanSize.push_back (bitrates.at (r) / 8 * (segmentDuration / 1e6));
+    }
+}
+
+bool
+SegmentSizeGenerator::IsSpecification (const std::string & file)
+{
+  return file.compare (0, 4, "vbr:") == 0;
+}
+
+int
+SegmentSizeGenerator::Load (const std::string & specification, videoData & data)
+{
+  NS_LOG_FUNCTION (specification);
+  std::vector<double> bitrates;
+  int64_t segments = 1800;
+  int64_t duration = data.segmentDuration;
+  double sigma = 0.35;
+  double sceneLength = 8;
+  double sceneShare = 0.8;
+  double correlation = 0.9;
+  uint64_t seed = 1;
+
+  std::stringstream stream (specification.substr (4));
+  std::string parameter;
+  while (std::getline (stream, parameter, ':'))
+    {
+      std::string::size_type equals = parameter.find ('=');
+      if (equals == std::string::npos)
+        {
+          NS_LOG_ERROR ("Malformed parameter of the VBR generator: " << parameter);
+          return -1;
+        }
+      std::string key = parameter.substr (0, equals);
+      std::string value = parameter.substr (equals + 1);
+      if (key == "ladder")
+        {
+          std::stringstream rungs (value);
+          std::string rung;
+          while (std::getline (rungs, rung, '/'))
+            {
+              bitrates.push_back (std::atof (rung.c_str ()) * 1000);
+            }
+        }
+      else if (key == "segments")
+        {
+          segments = std::atoll (value.c_str ());
+        }
+      else if (key == "duration")
+        {
+          duration = std::atoll (value.c_str ());
+        }
+      else if (key == "sigma")
+        {
+          sigma = std::atof (value.c_str ());
+        }
+      else if (key == "scene")
+        {
+          sceneLength = std::atof (value.c_str ());
+        }
+      else if (key == "sceneShare")
+        {
+          sceneShare = std::atof (value.c_str ());
+        }
+      else if (key == "correlation")
+        {
+          correlation = std::atof (value.c_str ());
+        }
+      else if (key == "seed")
+        {
+          seed = std::strtoull (value.c_str (), 0, 10);
+        }
+      else
+        {
+          NS_LOG_ERROR ("Unknown parameter of the VBR generator: " << key);
+          return -1;
+        }
+    }
+  // an empty or non-numeric rung, e.g. in "400//3000", parses as 0
+  bool invalidRung = false;
+  for (uint32_t r = 0; r < bitrates.size (); r++)
+    {
+      invalidRung = invalidRung || !(bitrates.at (r) > 0);
+    }
+  if (bitrates.empty () || invalidRung || segments <= 0 || duration <= 0 || sigma < 0 || sceneLength < 1
+      || sceneShare < 0 || sceneShare > 1 || correlation < 0 || correlation > 1)
+    {
+      NS_LOG_ERROR ("Invalid VBR generator: " << specification);
+      return -1;
+    }
+
+  data.segmentDuration = duration;
+  data.segmentStart.clear ();
+  data.averageBitrate = bitrates;
+  data.segmentSize = segmentSizeTable (std::make_shared<SegmentSizeGenerator> (bitrates, segments, duration, sigma,
+                                                                              sceneLength, sceneShare, correlation, seed));
+  return 1;
+}
+
+uint32_t
+SegmentSizeGenerator::GetRepresentations () const
+{
+  return m_meanSize.size ();
+}
+
+int64_t
+SegmentSizeGenerator::GetSegments () const
+{
+  return m_segments;
+}
+
+int64_t
+SegmentSizeGenerator::GetSize (uint32_t repIndex, int64_t segmentIndex) const
+{
+  // streams 0 and 1 + repIndex are the common process and the one of the representation
+  double z = std::sqrt (m_correlation) * Complexity (0, segmentIndex)
+    + std::sqrt (1 - m_correlation) * Complexity (1 + repIndex, segmentIndex);
+  double size = m_meanSize.at (repIndex) * std::exp (m_sigma * z - m_sigma * m_sigma / 2);
+  return std::max ((int64_t) 1, (int64_t) (size + 0.5));
+}
+
+double
+SegmentSizeGenerator::Gaussian (uint64_t stream, int64_t index) const
+{
+  uint64_t key = MixBits (MixBits (m_seed ^ MixBits (stream)) ^ (uint64_t) index);
+  // Box-Muller, both uniforms in (0, 1] from the 53 high bits of two hashes
+  double u1 = ((key >> 11) + 1) * (1.0 / 9007199254740992.0);
+  double u2 = ((MixBits (key) >> 11) + 1) * (1.0 / 9007199254740992.0);
+  return std::sqrt (-2 * std::log (u1)) * std::cos (2 * M_PI * u2);
+}
+
+double
+SegmentSizeGenerator::Complexity (uint64_t stream, int64_t index) const
+{
+  // scene values at the knots, linearly interpolated and rescaled to unit variance
+  double position = index / m_sceneLength;
+  int64_t knot = (int64_t) std::floor (position);
+  double t = position - knot;
+  double scene = ((1 - t) * Gaussian (2 * stream, knot) + t * Gaussian (2 * stream, knot + 1))
+    / std::sqrt ((1 - t) * (1 - t) + t * t);
+  return std::sqrt (m_sceneShare) * scene + std::sqrt (1 - m_sceneShare) * Gaussian (2 * stream + 1, index);
+}
+
+} // namespace ns3
@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_STREAM_SEGMENT_SIZES_H
+#define TCP_STREAM_SEGMENT_SIZES_H
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "tcp-stream-interface.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcpStream
+ * \brief Segment sizes held in memory, one vector per representation level, as read from a text file.
+ */
+class SegmentSizeMemory : public SegmentSizeSource
+{
+public:
+  SegmentSizeMemory ();
+
+  /**
+   * \brief Append a representation level, all levels have the same number of segments.
+   */
+  void AddRepresentation (const std::vector<int64_t> & sizes);
+
+  virtual uint32_t GetRepresentations () const;
+  virtual int64_t GetSegments () const;
+  virtual int64_t GetSize (uint32_t repIndex, int64_t segmentIndex) const;
+  virtual void GetSizes (uint32_t repIndex, int64_t first, int64_t count, int64_t *sizes) const;
+
+private:
+  std::vector<std::vector<int64_t> > m_sizes; //!< Sizes in bytes, representation level first
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Segment sizes of a binary segment size file, memory-mapped and paged in on first access.
+ *
+ * The file holds a 32 byte header (magic "DASHSEGS", version, representations, segments, whether
+ * durations follow), the average bitrate of every representation as int64, the durations of the segments
+ * in microseconds as int64 if given, and the sizes as uint32, the segments of one representation contiguous.
+ * All values are in host byte order. Opening the file maps it read-only without reading the sizes, so it
+ * takes the same time for any length, and processes mapping the same file share it through the page cache.
+ */
+class SegmentSizeMappedFile : public SegmentSizeSource
+{
+public:
+  virtual ~SegmentSizeMappedFile ();
+
+  /**
+   * \return whether the file starts with the magic of a binary segment size file
+   */
+  static bool IsBinary (const std::string & file);
+  /**
+   * \brief Map a binary segment size file and fill data with it.
+   *
+   * The sizes stay in the mapping, the average bitrates and the timeline of the durations are copied.
+   * \return 1 on success, -1 if the file cannot be mapped or is malformed
+   */
+  static int Load (const std::string & file, videoData & data);
+  /**
+   * \brief Write data as binary segment size file.
+   * \return false if the file cannot be written or a size does not fit 32 bits
+   */
+  static bool Write (const std::string & file, const videoData & data);
+
+  virtual uint32_t GetRepresentations () const;
+  virtual int64_t GetSegments () const;
+  virtual int64_t GetSize (uint32_t repIndex, int64_t segmentIndex) const;
+  virtual void GetSizes (uint32_t repIndex, int64_t first, int64_t count, int64_t *sizes) const;
+
+private:
+  SegmentSizeMappedFile ();
+
+  void *m_mapping; //!< Start of the mapping
+  uint64_t m_length; //!< Length of the mapping in bytes
+  uint32_t m_representations; //!< Number of representation levels
+  int64_t m_segments; //!< Number of segments per representation level
+  const uint32_t *m_sizes; //!< Sizes within the mapping
+};
+
+/**
+ * \ingroup tcpStream
+ * \brief Segment sizes of a synthetic VBR encode, computed on demand from a bitrate ladder.
+ *
+ * Given as segment size file "vbr:key=value:key=value...", with the keys
+ * - ladder: mean bitrates of the representations in kbit/s, separated by '/', e.g. 400/1200/3000 (required)
+ * - segments: number of segments (default 1800)
+ * - duration: segment duration in microseconds (default the SegmentDuration of the client)
+ * - sigma: standard deviation of the logarithm of the sizes (default 0.35)
+ * - scene: length of a scene in segments, the complexity moves smoothly from one scene value to the next (default 8)
+ * - sceneShare: share of the variance that follows the scenes, the rest varies per segment (default 0.8)
+ * - correlation: correlation of the complexity across representations (default 0.9)
+ * - seed: seed of the complexity process (default 1)
+ *
+ * The complexity of segment i in representation r is a unit variance Gaussian process, a mix of a process
+ * common to all representations and one of the representation. Each is the sum of scene values interpolated
+ * between knots every scene segments and an independent value per segment. All values are hashed from the
+ * seed and their position, so every size is computed in constant time without any stored matrix. The size
+ * is lognormal around the mean of the representation: mean * exp (sigma * z - sigma^2 / 2).
+ */
+class SegmentSizeGenerator : public SegmentSizeSource
+{
+public:
+  SegmentSizeGenerator (const std::vector<double> & bitrates, int64_t segments, int64_t segmentDuration,
+                        double sigma, double sceneLength, double sceneShare, double correlation, uint64_t seed);
+
+  /**
+   * \return whether file is a generator specification, i.e. starts with "vbr:"
+   */
+  static bool IsSpecification (const std::string & file);
+  /**
+   * \brief Parse a generator specification and fill data with the generator.
+   *
+   * Without a duration in the specification, the segmentDuration of data is used.
+   * \return 1 on success, -1 if the specification is malformed
+   */
+  static int Load (const std::string & specification, videoData & data);
+
+  virtual uint32_t GetRepresentations () const;
+  virtual int64_t GetSegments () const;
+  virtual int64_t GetSize (uint32_t repIndex, int64_t segmentIndex) const;
+
+private:
+  /**
+   * \brief Standard normal value hashed from the seed, the stream and the index.
+   */
+  double Gaussian (uint64_t stream, int64_t index) const;
+  /**
+   * \brief Unit variance complexity process of a stream, scene values plus values per segment.
+   */
+  double Complexity (uint64_t stream, int64_t index) const;
+
+  std::vector<double> m_meanSize; //!< Mean segment size of every representation in bytes
+  int64_t m_segments; //!< Number of segments
+  double m_sigma; //!< Standard deviation of the logarithm of the sizes
+  double m_sceneLength; //!< Distance of the scene knots in segments
+  double m_sceneShare; //!< Share of the variance following the scenes
+  double m_correlation; //!< Correlation across representations
+  uint64_t m_seed; //!< Seed of the process
+};
+
+} // namespace ns3
+
+#endif /* TCP_STREAM_SEGMENT_SIZES_H */
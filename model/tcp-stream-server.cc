@@ -16,6 +16,8 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <sstream>
 #include "ns3/log.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
@@ -26,6 +28,8 @@
 #include "ns3/socket.h"
 #include "ns3/tcp-socket.h"
 #include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
@@ -34,6 +38,7 @@
 #include "ns3/global-value.h"
 #include <ns3/core-module.h>
 #include "tcp-stream-client.h"
+#include "tcp-stream-profiler.h"
 #include "ns3/trace-source-accessor.h"
 
 namespace ns3 {
@@ -53,11 +58,53 @@ TcpStreamServer::GetTypeId (void)
                    UintegerValue (9),
                    MakeUintegerAccessor (&TcpStreamServer::m_port),
                    MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("StopWhenIdle",
+                   "Stop the simulation when the last connected client closed its connection",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpStreamServer::m_stopWhenIdle),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EgressScheduler",
+                   "Scheduler of the data written into the client connections (rate cap, weights, pacing), none if null",
+                   PointerValue (),
+                   MakePointerAccessor (&TcpStreamServer::m_scheduler),
+                   MakePointerChecker<TcpStreamEgressScheduler> ())
+    .AddAttribute ("BurstWindow",
+                   "Window in which the peak number of arriving requests is counted",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&TcpStreamServer::m_burstWindow),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("AssistanceInterval",
+                   "Interval at which the fair share is pushed to the clients as bitrate hint, 0 for no hints",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TcpStreamServer::m_assistanceInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("AssistancePort",
+                   "UDP port of the clients the bitrate hints are sent to",
+                   UintegerValue (9001),
+                   MakeUintegerAccessor (&TcpStreamServer::m_assistancePort),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("AssistanceCapacity",
+                   "Egress capacity of the server, divided among the connected clients for the bitrate hints",
+                   DataRateValue (DataRate ("100Mbps")),
+                   MakeDataRateAccessor (&TcpStreamServer::m_assistanceCapacity),
+                   MakeDataRateChecker ())
+    .AddTraceSource ("Load",
+                     "The number of active requests or the outstanding bytes changed",
+                     MakeTraceSourceAccessor (&TcpStreamServer::m_loadTrace),
+                     "ns3::TcpStreamServer::LoadCallback")
   ;
   return tid;
 }
 
 TcpStreamServer::TcpStreamServer ()
+  : m_activeRequests (0),
+    m_outstandingBytes (0),
+    m_requests (0),
+    m_peakRequestsInWindow (0),
+    m_peakActiveRequests (0),
+    m_peakOutstandingBytes (0),
+    m_activeRequestsArea (0),
+    m_outstandingBytesArea (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -73,6 +120,11 @@ void
 TcpStreamServer::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_scheduler != 0)
+    {
+      m_scheduler->Dispose ();
+      m_scheduler = 0;
+    }
   Application::DoDispose ();
 }
 
@@ -80,6 +132,8 @@ void
 TcpStreamServer::StartApplication (void)
 {
   NS_LOG_FUNCTION (this);
+  m_loadSince = Simulator::Now ();
+  m_lastLoadChange = Simulator::Now ();
 
   if (m_socket == 0)
     {
@@ -99,6 +153,19 @@ TcpStreamServer::StartApplication (void)
       m_socket->Listen ();
     }
 
+  if (m_scheduler != 0)
+    {
+      m_scheduler->SetTransmitCallback (MakeCallback (&TcpStreamServer::Transmit, this));
+    }
+
+  if (!m_assistanceInterval.IsZero () && m_assistanceSocket == 0)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+      m_assistanceSocket = Socket::CreateSocket (GetNode (), tid);
+      m_assistanceSocket->Bind ();
+      m_assistanceEvent = Simulator::Schedule (m_assistanceInterval, &TcpStreamServer::SendAssistance, this);
+    }
+
   // Accept connection requests from remote hosts.
   m_socket->SetAcceptCallback (MakeNullCallback<bool, Ptr< Socket >, const Address &> (),
                                MakeCallback (&TcpStreamServer::HandleAccept,this));
@@ -122,21 +189,76 @@ TcpStreamServer::StopApplication ()
       m_socket6->Close ();
       m_socket6->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
     }
+  m_assistanceEvent.Cancel ();
+  if (m_assistanceSocket != 0)
+    {
+      m_assistanceSocket->Close ();
+      m_assistanceSocket = 0;
+    }
+  // a stopped server drops its clients, so that they notice and can fail over to another server
+  for (uint32_t i = 0; i < m_clientSockets.size (); i++)
+    {
+      Ptr<Socket> socket = m_clientSockets.at (i);
+      socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+      socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (), MakeNullCallback<void, Ptr<Socket> > ());
+      if (m_scheduler != 0)
+        {
+          m_scheduler->Remove (socket);
+        }
+      socket->Close ();
+    }
+  for (std::map<Address, callbackData>::iterator it = m_callbackData.begin (); it != m_callbackData.end (); ++it)
+    {
+      if (it->second.send && it->second.currentTxBytes < it->second.packetSizeToReturn)
+        {
+          UpdateLoad (-1, - (int64_t) (it->second.packetSizeToReturn - it->second.currentTxBytes));
+        }
+    }
+  m_clientSockets.clear ();
+  m_callbackData.clear ();
+  m_connectedClients.clear ();
 }
 
 void
 TcpStreamServer::HandleRead (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
+  DashProfilerScope profile ("Server", "HandleRead");
   Ptr<Packet> packet;
   Address from;
   packet = socket->RecvFrom (from);
   int64_t packetSizeToReturn = GetCommand (packet);
+
+  // count the requests arriving within the burst window
+  m_requests++;
+  m_recentRequests.push_back (Simulator::Now ());
+  while (!m_recentRequests.empty () && m_recentRequests.front () + m_burstWindow <= Simulator::Now ())
+    {
+      m_recentRequests.pop_front ();
+    }
+  m_peakRequestsInWindow = std::max (m_peakRequestsInWindow, (uint32_t) m_recentRequests.size ());
+  // a new request replaces an unfinished one of the same client
+  std::map<Address, callbackData>::iterator old = m_callbackData.find (from);
+  if (old != m_callbackData.end () && old->second.send && old->second.currentTxBytes < old->second.packetSizeToReturn)
+    {
+      UpdateLoad (-1, - (int64_t) (old->second.packetSizeToReturn - old->second.currentTxBytes));
+    }
+  if (packetSizeToReturn > 0)
+    {
+      UpdateLoad (1, packetSizeToReturn);
+    }
+
   // these values will be accessible by the clients Address from.
   m_callbackData [from].currentTxBytes = 0;
   m_callbackData [from].packetSizeToReturn = packetSizeToReturn;
   m_callbackData [from].send = true;
 
+  if (m_scheduler != 0)
+    {
+      m_scheduler->Enqueue (socket, packetSizeToReturn > 0 ? packetSizeToReturn : 0);
+      return;
+    }
   HandleSend (socket, socket->GetTxAvailable ());
 
 }
@@ -144,8 +266,19 @@ TcpStreamServer::HandleRead (Ptr<Socket> socket)
 void
 TcpStreamServer::HandleSend (Ptr<Socket> socket, uint32_t txSpace)
 {
+  DashProfilerScope profile ("Server", "HandleSend");
+  if (m_scheduler != 0)
+    {
+      m_scheduler->Wake (socket);
+      return;
+    }
   Address from;
   socket->GetPeerName (from);
+  // the client may already have left, do not recreate its entry
+  if (m_callbackData.find (from) == m_callbackData.end ())
+    {
+      return;
+    }
   // look up values for the connected client and whose values are stored in from
   if (m_callbackData [from].currentTxBytes == m_callbackData [from].packetSizeToReturn)
     {
@@ -163,6 +296,8 @@ TcpStreamServer::HandleSend (Ptr<Socket> socket, uint32_t txSpace)
       if (amountSent > 0)
         {
           m_callbackData [from].currentTxBytes += amountSent;
+          bool finished = m_callbackData [from].currentTxBytes == m_callbackData [from].packetSizeToReturn;
+          UpdateLoad (finished ? -1 : 0, -amountSent);
         }
       // We exit this part, when no bytes have been sent, as the send side buffer is full.
       // The "HandleSend" callback will fire when some buffer space has freed up.
@@ -173,6 +308,40 @@ TcpStreamServer::HandleSend (Ptr<Socket> socket, uint32_t txSpace)
     }
 }
 
+uint32_t
+TcpStreamServer::Transmit (Ptr<Socket> socket, uint32_t maxBytes)
+{
+  DashProfilerScope profile ("Server", "Transmit");
+  Address from;
+  socket->GetPeerName (from);
+  std::map<Address, callbackData>::iterator it = m_callbackData.find (from);
+  if (it == m_callbackData.end () || !it->second.send)
+    {
+      return 0;
+    }
+  callbackData & data = it->second;
+  uint32_t toSend = std::min (std::min (socket->GetTxAvailable (), maxBytes), data.packetSizeToReturn - data.currentTxBytes);
+  if (toSend == 0)
+    {
+      return 0;
+    }
+  int amountSent = socket->Send (Create<Packet> (toSend), 0);
+  if (amountSent <= 0)
+    {
+      return 0;
+    }
+  data.currentTxBytes += amountSent;
+  bool finished = data.currentTxBytes == data.packetSizeToReturn;
+  UpdateLoad (finished ? -1 : 0, -amountSent);
+  if (finished)
+    {
+      data.currentTxBytes = 0;
+      data.packetSizeToReturn = 0;
+      data.send = false;
+    }
+  return amountSent;
+}
+
 void
 TcpStreamServer::HandleAccept (Ptr<Socket> s, const Address& from)
 {
@@ -183,6 +352,7 @@ TcpStreamServer::HandleAccept (Ptr<Socket> s, const Address& from)
   cbd.send = false;
   m_callbackData [from] = cbd;
   m_connectedClients.push_back (from);
+  m_clientSockets.push_back (s);
   s->SetRecvCallback (MakeCallback (&TcpStreamServer::HandleRead, this));
   s->SetSendCallback ( MakeCallback (&TcpStreamServer::HandleSend, this));
 }
@@ -197,9 +367,22 @@ TcpStreamServer::HandlePeerClose (Ptr<Socket> socket)
     {
       if (*it == from)
         {
+          // Close our side too and forget the client, so that churning clients do not pile up half-closed sockets
+          socket->Close ();
+          if (m_scheduler != 0)
+            {
+              m_scheduler->Remove (socket);
+            }
+          std::map<Address, callbackData>::iterator data = m_callbackData.find (from);
+          if (data != m_callbackData.end () && data->second.send && data->second.currentTxBytes < data->second.packetSizeToReturn)
+            {
+              UpdateLoad (-1, - (int64_t) (data->second.packetSizeToReturn - data->second.currentTxBytes));
+            }
+          m_callbackData.erase (from);
           m_connectedClients.erase (it);
+          m_clientSockets.erase (std::remove (m_clientSockets.begin (), m_clientSockets.end (), socket), m_clientSockets.end ());
           // No more clients left in m_connectedClients, simulation is done.
-          if (m_connectedClients.size () == 0)
+          if (m_stopWhenIdle && m_connectedClients.size () == 0)
             {
               Simulator::Stop ();
             }
@@ -208,12 +391,66 @@ TcpStreamServer::HandlePeerClose (Ptr<Socket> socket)
     }
 }
 
+void
+TcpStreamServer::SendAssistance ()
+{
+  NS_LOG_FUNCTION (this);
+  m_assistanceEvent = Simulator::Schedule (m_assistanceInterval, &TcpStreamServer::SendAssistance, this);
+  if (m_connectedClients.empty ())
+    {
+      return;
+    }
+  std::ostringstream hint;
+  hint << m_assistanceCapacity.GetBitRate () / (double) m_connectedClients.size () << " " << 2 * m_assistanceInterval.GetMicroSeconds ();
+  std::string message = hint.str ();
+  for (uint32_t i = 0; i < m_connectedClients.size (); i++)
+    {
+      // the hint goes to the client's node, the address of the stream connection tells which
+      if (InetSocketAddress::IsMatchingType (m_connectedClients.at (i)))
+        {
+          Ipv4Address client = InetSocketAddress::ConvertFrom (m_connectedClients.at (i)).GetIpv4 ();
+          m_assistanceSocket->SendTo (Create<Packet> ((const uint8_t *) message.c_str (), message.size () + 1), 0, InetSocketAddress (client, m_assistancePort));
+        }
+    }
+}
+
 void
 TcpStreamServer::HandlePeerError (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
 }
 
+void
+TcpStreamServer::UpdateLoad (int32_t activeRequests, int64_t outstandingBytes)
+{
+  double elapsed = (Simulator::Now () - m_lastLoadChange).GetSeconds ();
+  m_activeRequestsArea += m_activeRequests * elapsed;
+  m_outstandingBytesArea += m_outstandingBytes * elapsed;
+  m_lastLoadChange = Simulator::Now ();
+
+  m_activeRequests += activeRequests;
+  m_outstandingBytes += outstandingBytes;
+  m_peakActiveRequests = std::max (m_peakActiveRequests, m_activeRequests);
+  m_peakOutstandingBytes = std::max (m_peakOutstandingBytes, m_outstandingBytes);
+  m_loadTrace (m_activeRequests, m_outstandingBytes);
+}
+
+serverLoadMetrics
+TcpStreamServer::GetLoadMetrics () const
+{
+  serverLoadMetrics metrics;
+  metrics.requests = m_requests;
+  metrics.peakRequestsInWindow = m_peakRequestsInWindow;
+  metrics.peakActiveRequests = m_peakActiveRequests;
+  metrics.peakOutstandingBytes = m_peakOutstandingBytes;
+  // close the integrals at the current time
+  double elapsed = (Simulator::Now () - m_lastLoadChange).GetSeconds ();
+  double duration = (Simulator::Now () - m_loadSince).GetSeconds ();
+  metrics.meanActiveRequests = duration > 0 ? (m_activeRequestsArea + m_activeRequests * elapsed) / duration : 0;
+  metrics.meanOutstandingBytes = duration > 0 ? (m_outstandingBytesArea + m_outstandingBytes * elapsed) / duration : 0;
+  return metrics;
+}
+
 int64_t
 TcpStreamServer::GetCommand (Ptr<Packet> packet)
 {
@@ -222,6 +459,7 @@ TcpStreamServer::GetCommand (Ptr<Packet> packet)
   packet->CopyData (buffer, packet->GetSize ());
   std::stringstream ss;
   ss << buffer;
+  delete [] buffer;
   std::string str;
   ss >> str;
   std::stringstream convert (str);
@@ -24,8 +24,12 @@
 #include "ns3/ptr.h"
 #include "ns3/address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include <deque>
 #include <map>
 #include "ns3/random-variable-stream.h"
+#include "tcp-stream-egress-scheduler.h"
 
 namespace ns3 {
 
@@ -51,11 +55,32 @@ struct callbackData
   bool send;//!< true as long as there are still bytes left to be sent for the current segment
 };
 
+/**
+ * \ingroup tcpStream
+ * \brief Load of a TcpStreamServer, to compare how synchronised the requests of its clients arrive.
+ *
+ * Active requests are requests with bytes left to send, outstanding bytes are the bytes of all active
+ * requests not yet handed to the sockets. Means are weighted by time since the server started.
+ */
+struct serverLoadMetrics
+{
+  uint64_t requests; //!< Number of requests received
+  uint32_t peakRequestsInWindow; //!< Largest number of requests received within one BurstWindow
+  uint32_t peakActiveRequests; //!< Largest number of requests served at the same time
+  double meanActiveRequests; //!< Time-weighted mean number of requests served at the same time
+  uint64_t peakOutstandingBytes; //!< Largest backlog of bytes requested but not yet sent
+  double meanOutstandingBytes; //!< Time-weighted mean backlog of bytes requested but not yet sent
+};
+
 /**
  * \ingroup tcpStream
  * \brief A Tcp Stream server
  *
  * Clients sent messages with the amount of bytes they want the server to return to them.
+ *
+ * With an AssistanceInterval, the server periodically pushes a bitrate hint to every connected client over
+ * UDP: its AssistanceCapacity divided by the number of connected clients, valid for two intervals. The hint
+ * is the null-terminated string "bitrate validity", in bit/s and microseconds.
  */
 class TcpStreamServer : public Application
 {
@@ -65,9 +90,21 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+  /**
+   * \brief Signature of the Load trace source.
+   * \param activeRequests the number of requests with bytes left to send
+   * \param outstandingBytes the bytes of these requests not yet handed to the sockets
+   */
+  typedef void (* LoadCallback)(uint32_t activeRequests, uint64_t outstandingBytes);
+
   TcpStreamServer ();
   virtual ~TcpStreamServer ();
 
+  /**
+   * \return the load of the server since it started
+   */
+  serverLoadMetrics GetLoadMetrics () const;
+
 protected:
   virtual void DoDispose (void);
 
@@ -108,6 +145,15 @@ private:
    */
   void HandleSend (Ptr<Socket> socket, uint32_t packetSizeToReturn);
 
+  /**
+   * \brief Write at most maxBytes of the pending segment of the client connected to socket into the socket.
+   *
+   * Used by the egress scheduler, which decides when and how much every client may write.
+   *
+   * \return the number of bytes written
+   */
+  uint32_t Transmit (Ptr<Socket> socket, uint32_t maxBytes);
+
   /**
    * \brief Set callback functions for receive and send.
    * Add the newly connected client to m_connectedClients and allocate callbackData structure for this client.
@@ -124,11 +170,44 @@ private:
    */
   int64_t GetCommand (Ptr<Packet> packet);
 
+  /**
+   * \brief Account a change of the active requests and the outstanding bytes in the load metrics.
+   */
+  void UpdateLoad (int32_t activeRequests, int64_t outstandingBytes);
+
+  /**
+   * \brief Push the fair share to every connected client and schedule the next hints.
+   */
+  void SendAssistance ();
+
   uint16_t m_port; //!< Port on which we listen for incoming packets.
+  bool m_stopWhenIdle; //!< Stop the simulation when the last client disconnected
+  Ptr<TcpStreamEgressScheduler> m_scheduler; //!< Optional egress scheduler, TCP alone shares the bandwidth if null
   Ptr<Socket> m_socket; //!< IPv4 Socket
   Ptr<Socket> m_socket6; //!< IPv6 Socket
   std::map <Address, callbackData> m_callbackData; //!< With this it is possible to access the currentTxBytes, the packetSizeToReturn and the send boolean through the from value of the client.
   std::vector<Address> m_connectedClients; //!< Vector which holds the list of currently connected clients.
+  std::vector<Ptr<Socket> > m_clientSockets; //!< Connections of the connected clients, closed when the server stops
+
+  Time m_burstWindow; //!< Window the peak number of arriving requests is counted in
+  uint32_t m_activeRequests; //!< Requests with bytes left to send
+  uint64_t m_outstandingBytes; //!< Bytes of the active requests not yet handed to the sockets
+  uint64_t m_requests; //!< Number of requests received
+  uint32_t m_peakRequestsInWindow; //!< Largest number of requests within m_burstWindow
+  uint32_t m_peakActiveRequests; //!< Largest value of m_activeRequests
+  uint64_t m_peakOutstandingBytes; //!< Largest value of m_outstandingBytes
+  double m_activeRequestsArea; //!< Integral of m_activeRequests over time in seconds
+  double m_outstandingBytesArea; //!< Integral of m_outstandingBytes over time in seconds
+  Time m_loadSince; //!< Start of the load metrics
+  Time m_lastLoadChange; //!< Time the integrals were last updated
+  std::deque<Time> m_recentRequests; //!< Arrival times of the requests within m_burstWindow
+  TracedCallback<uint32_t, uint64_t> m_loadTrace; //!< Trace of the active requests and outstanding bytes
+
+  Time m_assistanceInterval; //!< Interval of the bitrate hints, 0 for none
+  uint16_t m_assistancePort; //!< UDP port of the clients the hints are sent to
+  DataRate m_assistanceCapacity; //!< Egress capacity shared among the clients
+  Ptr<Socket> m_assistanceSocket; //!< Socket sending the hints
+  EventId m_assistanceEvent; //!< Next round of hints
 
 
 };
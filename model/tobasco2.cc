@@ -107,7 +107,7 @@ TobascoAlgorithm::GetNextRep ( const int64_t segmentCounter, int64_t clientId)
               if (bufferNow > m_bHigh)
                 {
                   delayDecision = 1;
-                  bDelay = m_bHigh - m_videoData.segmentDuration;
+                  bDelay = m_bHigh - m_videoData.GetSegmentDuration (segmentCounter);
                 }
             }
         }
@@ -122,16 +122,18 @@ TobascoAlgorithm::GetNextRep ( const int64_t segmentCounter, int64_t clientId)
             }
           else if (bufferNow < m_bLow)
             {
+              // the bitrate of the last segment over its own duration
+              double lastSegmentSeconds = m_videoData.GetSegmentDuration (segmentCounter - 1) / 1000000.0;
               double lastSegmentThroughput = (8.0 * m_videoData.segmentSize.at (m_lastRepIndex).at (segmentCounter - 1))
                 / ((double)(m_throughput.transmissionEnd.at (segmentCounter - 1) - m_throughput.transmissionStart.at (segmentCounter - 1)) / 1000000.0);
 
               if ((m_lastRepIndex != 0)
-                  && ((8.0 * m_videoData.segmentSize.at (m_lastRepIndex).at (segmentCounter - 1)) / timeFactor >= lastSegmentThroughput))
+                  && ((8.0 * m_videoData.segmentSize.at (m_lastRepIndex).at (segmentCounter - 1)) / lastSegmentSeconds >= lastSegmentThroughput))
                 {
                   decisionCase = 5;
                   for (int i = m_highestRepIndex; i >= 0; i--)
                     {
-                      if ((8.0 * m_videoData.segmentSize.at (i).at (segmentCounter - 1)) / timeFactor >= lastSegmentThroughput)
+                      if ((8.0 * m_videoData.segmentSize.at (i).at (segmentCounter - 1)) / lastSegmentSeconds >= lastSegmentThroughput)
                         {
                           continue;
                         }
@@ -153,7 +155,7 @@ TobascoAlgorithm::GetNextRep ( const int64_t segmentCounter, int64_t clientId)
                   || (nextHighestRepBitrate >= m_a5 * averageSegmentThroughput))
                 {
                   delayDecision = 2;
-                  bDelay = (int64_t)(std::max (bufferNow - m_videoData.segmentDuration, m_bOpt));
+                  bDelay = (int64_t)(std::max (bufferNow - m_videoData.GetSegmentDuration (segmentCounter), m_bOpt));
                 }
             }
           else
@@ -162,7 +164,7 @@ TobascoAlgorithm::GetNextRep ( const int64_t segmentCounter, int64_t clientId)
                   || (nextHighestRepBitrate >= m_a5 * averageSegmentThroughput))
                 {
                   delayDecision = 3;
-                  bDelay = (int64_t)(std::max (bufferNow - m_videoData.segmentDuration, m_bOpt));
+                  bDelay = (int64_t)(std::max (bufferNow - m_videoData.GetSegmentDuration (segmentCounter), m_bOpt));
                 }
               else
                 {
@@ -203,8 +205,9 @@ TobascoAlgorithm::MinimumBufferLevelObserved ()
     }
   int64_t lastPackage = m_throughput.transmissionEnd.end ()[-1];
   int64_t secondToLastPackage = m_throughput.transmissionEnd.end ()[-2];
+  int64_t lastSegmentDuration = m_videoData.GetSegmentDuration (m_throughput.transmissionEnd.size () - 1);
 
-  if (m_deltaBeta < m_videoData.segmentDuration)
+  if (m_deltaBeta < lastSegmentDuration)
     {
       if (lastPackage - secondToLastPackage < m_deltaBeta)
         {
@@ -217,7 +220,7 @@ TobascoAlgorithm::MinimumBufferLevelObserved ()
     }
   else
     {
-      if (lastPackage - secondToLastPackage < m_videoData.segmentDuration)
+      if (lastPackage - secondToLastPackage < lastSegmentDuration)
         {
           return true;
         }
@@ -276,7 +279,7 @@ TobascoAlgorithm::AverageSegmentThroughput (int64_t t_1, int64_t t_2)
   while (m_throughput.transmissionEnd.at (index) <= t_2)
     {
       lengthOfInterval = m_throughput.transmissionEnd.at (index) - m_throughput.transmissionRequested.at (index);
-      sumThroughput += ((m_videoData.averageBitrate.at (m_playbackData.playbackIndex.at (index)) * m_videoData.segmentDuration)
+      sumThroughput += ((m_videoData.averageBitrate.at (m_playbackData.playbackIndex.at (index)) * m_videoData.GetSegmentDuration (index))
                         / lengthOfInterval)  * lengthOfInterval;
       transmissionTime += lengthOfInterval;
       index++;